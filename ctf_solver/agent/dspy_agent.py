@@ -1,7 +1,8 @@
 import dspy
+import json
 import logging
 from typing import Dict, Any, List
-from ctf_solver.config import configure_dspy, EXEGOL_TOOLS
+from ctf_solver.config import configure_dspy, BATCH_MAX_ACTIONS, EXEGOL_TOOLS
 
 logger = logging.getLogger(__name__)
 
@@ -21,18 +22,27 @@ class CTFAgent(dspy.Module):
         
         # Simple CoT-only predictor with structured inputs (idiomatic DSPy)
         cot_signature = dspy.Signature(
-            "history_text, info, last_output -> analysis, approach, tool_name, command, filename, content, max_bytes, timeout_seconds",
+            "history_text, info, last_output -> analysis, approach, tool_name, command, filename, content, max_bytes, offset, encoding, timeout_seconds",
             (
                 "Task: Solve a CTF challenge step-by-step using available tools.\n"
                 "Inputs: history_text (recent actions + outputs), info (discovered facts), last_output (latest stdout/stderr).\n"
-                "Outputs: analysis and approach, plus exactly ONE action via fields: tool_name in {bash, read_file, write_file},\n"
-                "command (bash only), filename (read/write), content (write), max_bytes (read optional), timeout_seconds (bash optional, default 60sec).\n\n"
+                "Outputs: analysis and approach, plus ONE action (or one batch) via fields: tool_name in {bash, batch, read_file, write_file, gdb, python, sidechannel, pwntriage, start_job, job_status, job_output, kill_job},\n"
+                "command (bash, or newline-separated gdb commands for gdb), filename (read/write; for gdb optionally the binary), content (write, or the code for python), max_bytes (read optional; gdb memory dump length), offset (read optional, start byte; gdb address to dump),\n"
+                "encoding (read: auto|text|hex|base64, auto shows binary as a hex dump; write: text|hex|base64 for raw bytes such as payloads with NUL bytes),\n"
+                "timeout_seconds (bash/gdb/python optional, default 60sec).\n\n"
                 "Operating principles: gather context about the challenge first (identify and read artifacts, skim headers/exports/imports etc), determine hypothesis and test them.\n"
                 "Tool usage guidelines:\n"
                 "- When using read_file, prefer full reads unless size is huge; otherwise limit and iterate.\n"
                 "- If a previous read was truncated, re-read without max_bytes.\n"
                 "- For bash actions, choose commands that quickly validate hypotheses (e.g., 'file', 'strings -n 6 | head', header dumps, small hexdumps, basic run).\n"
+                f"- batch runs up to {BATCH_MAX_ACTIONS} INDEPENDENT actions at once and returns every result in order: command holds one bash command per line, or content a JSON list of actions such as [{{\"tool\": \"bash\", \"cmd\": \"checksec --file=vuln\"}}, {{\"tool\": \"read_file\", \"filename\": \"main.c\"}}]. Use it for triage (file, checksec, strings | grep, readelf -s) instead of one step per command; never batch actions that depend on each other's output, and a cd inside a batch does not persist.\n"
                 "- You are executing in a exegol container - a pentesting ditribution, and have access to common pentesting and reverse engineering tools, use them fully.\n"
+                "- gdb keeps one debugger session across steps (breakpoints and the running program persist); results end with a [gdb] JSON line with stop reason, breakpoints and registers. To dump memory at the stop, set offset to an address expression ($rsp, &buf, 0x404040) and max_bytes to the length (default 64).\n"
+                "- sidechannel brute-forces a password check one character at a time by counting executed instructions (perf counters, else valgrind, else ptrace): filename is the binary, command optional engine flags (--prefix KNOWN, --length N, --charset CHARS, --mode argv, --exhaustive); use it when a check compares input byte by byte and exits early.\n"
+                "- pwntriage finds pwn primitives in one call: filename is the binary, command optional flags (--only overflow|format|targets, --prefix 'MENU\\n' bytes before each payload, --format-budget N); returns the return-address/canary offset, the format-string argument offset with classified leaks, writable symbols/GOT slots and printed addresses.\n"
+                "- For anything slower than a minute (hashcat/john, angr exploration, brute-force loops) use start_job with the bash command (timeout_seconds is its wall limit, default 1h); it returns a job id at once. Keep working and check it with job_status / job_output (filename = job id; job_output continues where the last read stopped, offset re-reads from a byte) and stop it with kill_job.\n"
+                "- python runs in one interpreter per attempt: variables, imports (e.g. pwntools) and live process()/remote() handles persist between steps; a trailing expression is printed.\n"
+                "- For many runs of a local binary (offset search, brute force) use the fork server in python: from flaggy_forkserver import ForkServer; fs = ForkServer(['./vuln']); fs.run(payload) returns stdout, exit_code, signal, crash_pc, crash_stack_word (thousands of runs/sec).\n"
                 "- Output only what is necessary for the next decision."
             )
         )
@@ -61,12 +71,18 @@ class CTFAgent(dspy.Module):
         content = getattr(pred, 'content', '') or ''
         raw_max_bytes = getattr(pred, 'max_bytes', '') or ''
         raw_timeout_seconds = getattr(pred, 'timeout_seconds', '') or ''
+        raw_offset = getattr(pred, 'offset', '') or ''
+        encoding = (getattr(pred, 'encoding', '') or '').strip().lower()
         
         # Parse max_bytes defensively
         try:
             max_bytes = int(raw_max_bytes) if str(raw_max_bytes).strip() else None
         except Exception:
             max_bytes = None
+        try:
+            offset = int(str(raw_offset).strip(), 0) if str(raw_offset).strip() else 0
+        except Exception:
+            offset = 0
         # Parse timeout_seconds defensively
         try:
             timeout_seconds = int(raw_timeout_seconds) if str(raw_timeout_seconds).strip() else None
@@ -83,12 +99,50 @@ class CTFAgent(dspy.Module):
             action = {'tool': 'bash', 'cmd': command}
             if isinstance(timeout_seconds, int) and timeout_seconds > 0:
                 action['timeout_seconds'] = timeout_seconds
+        elif tool_name == 'gdb' and command.strip():
+            action = {'tool': 'gdb', 'cmd': command}
+            if filename.strip():
+                action['binary'] = filename.strip()
+            if str(raw_offset).strip():
+                # Address expression to dump once the program is stopped (e.g. $rsp, &buf, 0x404040)
+                action['memory'] = {'address': str(raw_offset).strip()}
+                if isinstance(max_bytes, int) and max_bytes > 0:
+                    action['memory']['length'] = max_bytes
+            if isinstance(timeout_seconds, int) and timeout_seconds > 0:
+                action['timeout_seconds'] = timeout_seconds
+        elif tool_name == 'python' and (content or command).strip():
+            action = {'tool': 'python', 'code': content or command}
+            if isinstance(timeout_seconds, int) and timeout_seconds > 0:
+                action['timeout_seconds'] = timeout_seconds
+        elif tool_name in ('sidechannel', 'side_channel', 'pwntriage', 'pwn_triage') and filename.strip():
+            action = {'tool': tool_name.replace('_', ''), 'binary': filename.strip(), 'options': command.strip()}
+            if isinstance(timeout_seconds, int) and timeout_seconds > 0:
+                action['timeout_seconds'] = timeout_seconds
+        elif tool_name == 'start_job' and command.strip():
+            action = {'tool': 'start_job', 'cmd': command}
+            if isinstance(timeout_seconds, int) and timeout_seconds > 0:
+                action['timeout_seconds'] = timeout_seconds
+        elif tool_name in ('job_status', 'job_output', 'kill_job'):
+            action = {'tool': tool_name, 'job_id': (filename or command).strip()}
+            if tool_name == 'job_output':
+                if str(raw_offset).strip():
+                    action['offset'] = offset
+                if isinstance(max_bytes, int) and max_bytes > 0:
+                    action['max_bytes'] = max_bytes
+        elif tool_name in ('batch', 'parallel', 'multi') and (content or command).strip():
+            action = {'tool': 'batch', 'actions': self._parse_batch(content, command, timeout_seconds)}
         elif 'read' in tool_name and filename.strip():
             action = {'tool': 'read_file', 'filename': filename}
             if isinstance(max_bytes, int) and max_bytes > 0:
                 action['max_bytes'] = max_bytes
+            if offset > 0:
+                action['offset'] = offset
+            if encoding in ('text', 'hex', 'base64'):
+                action['encoding'] = encoding
         elif 'write' in tool_name and filename.strip():
             action = {'tool': 'write_file', 'filename': filename, 'content': content}
+            if encoding in ('hex', 'base64'):
+                action['encoding'] = encoding
         elif tool_name in ('get_tools', 'get_tools_info', 'tools'):
             category = (filename or command or '').strip()
             try:
@@ -107,6 +161,31 @@ class CTFAgent(dspy.Module):
             'action': action,
         }
 
+    @staticmethod
+    def _parse_batch(content: str, command: str, timeout_seconds) -> List[Dict[str, Any]]:
+        """Batch actions from a JSON list in content, else one bash command per line of command"""
+        actions: List[Dict[str, Any]] = []
+        try:
+            items = json.loads(content) if content.strip().startswith('[') else None
+        except ValueError:
+            items = None
+        if isinstance(items, list):
+            for item in items:
+                if isinstance(item, str) and item.strip():
+                    actions.append({'tool': 'bash', 'cmd': item})
+                elif isinstance(item, dict) and (item.get('cmd') or item.get('command') or item.get('filename')):
+                    sub = dict(item)
+                    sub['tool'] = str(sub.get('tool') or 'bash').strip().lower()
+                    if 'command' in sub and 'cmd' not in sub:
+                        sub['cmd'] = sub.pop('command')
+                    actions.append(sub)
+        else:
+            actions = [{'tool': 'bash', 'cmd': line} for line in (command or content).splitlines() if line.strip()]
+        if isinstance(timeout_seconds, int) and timeout_seconds > 0:
+            for sub in actions:
+                sub.setdefault('timeout_seconds', timeout_seconds)
+        return actions[:BATCH_MAX_ACTIONS]
+
     # ===== Container tool helpers =====
     
     def execute_command(self, command: str) -> str:
@@ -202,6 +281,16 @@ class CTFAgent(dspy.Module):
             try:
                 action, result = item
                 cmd = action.get('cmd') or action.get('args', {}).get('cmd') or ''
+                if action.get('tool') == 'gdb':
+                    cmd = f"gdb> {cmd}"
+                elif not cmd and action.get('tool') == 'python':
+                    cmd = f"python>>> {action.get('code', '')}"
+                elif action.get('tool') in ('sidechannel', 'pwntriage'):
+                    cmd = f"{action['tool']} {action.get('binary', '')} {action.get('options', '')}".rstrip()
+                elif action.get('tool') == 'start_job':
+                    cmd = f"start_job> {cmd}"
+                elif action.get('tool') in ('job_status', 'job_output', 'kill_job'):
+                    cmd = f"{action['tool']} {action.get('job_id', '')}".rstrip()
                 # Include read_file calls as pseudo-commands for better context
                 if not cmd and action.get('tool') == 'read_file':
                     fname = action.get('filename', '')
@@ -210,6 +299,10 @@ class CTFAgent(dspy.Module):
                         cmd = f"read_file {fname} {mbytes}"
                     else:
                         cmd = f"read_file {fname}"
+                    if action.get('offset'):
+                        cmd += f" @{action['offset']}"
+                    if action.get('encoding'):
+                        cmd += f" ({action['encoding']})"
                 # Carry forward reasoning plan when available
                 analysis = action.get('analysis') if isinstance(action, dict) else ''
                 approach = action.get('approach') if isinstance(action, dict) else ''
@@ -245,8 +338,13 @@ class CTFAgent(dspy.Module):
         if not discovered_info:
             return "No analysis completed yet"
             
+        def compact(value) -> str:
+            if isinstance(value, dict):
+                return "{" + ", ".join(f"{k}={compact(v)}" for k, v in value.items()) + "}"
+            return str(value)
+        
         info_lines = []
         for key, value in discovered_info.items():
-            info_lines.append(f"{key.replace('_', ' ').title()}: {value}")
+            info_lines.append(f"{key.replace('_', ' ').title()}: {compact(value)}")
             
         return ", ".join(info_lines) if info_lines else "No information discovered"
\ No newline at end of file
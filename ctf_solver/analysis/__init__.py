@@ -0,0 +1 @@
+"""Static analysis of challenge files, precomputed at sync/import time"""
@@ -0,0 +1,514 @@
+"""
+Minimal ELF, PE and ar parsers
+
+Just enough structure for triage: headers, segments/sections, protections,
+symbol/import tables and PLT/GOT slots. Pure Python (struct) so it runs on the
+host without any of the container tooling. Parsers work on any buffer, including
+a read-only mmap (see mapped()): only the structures that are asked for are
+touched, so header-level questions cost microseconds even for large files.
+"""
+import mmap
+import os
+import re
+import struct
+from contextlib import contextmanager
+from typing import Any, Dict, Iterator, List, Optional, Tuple
+
+
+class FormatError(ValueError):
+    """The file is truncated or not the format it claims to be"""
+
+
+ELF_MACHINES = {
+    3: 'i386', 8: 'mips', 20: 'powerpc', 21: 'powerpc64', 40: 'arm', 62: 'x86_64',
+    183: 'aarch64', 243: 'riscv',
+}
+ELF_TYPES = {1: 'relocatable', 2: 'executable', 3: 'shared', 4: 'core'}
+
+PT_LOAD, PT_DYNAMIC, PT_INTERP = 1, 2, 3
+PT_GNU_STACK, PT_GNU_RELRO = 0x6474e551, 0x6474e552
+PF_X = 1
+SHT_SYMTAB, SHT_RELA, SHT_REL, SHT_DYNSYM = 2, 4, 9, 11
+SHF_EXECINSTR = 4
+DT_NEEDED, DT_FLAGS, DT_BIND_NOW, DT_FLAGS_1 = 1, 30, 24, 0x6ffffffb
+DF_BIND_NOW, DF_1_NOW, DF_1_PIE = 0x8, 0x1, 0x08000000
+STT_OBJECT, STT_FUNC = 1, 2
+STB_GLOBAL, STB_WEAK = 1, 2
+
+_CANARY_SYMBOLS = (b'__stack_chk_fail', b'__stack_chk_guard', b'__intel_security_cookie')
+_FORTIFY_SYMBOL = re.compile(rb'\0__[a-z0-9_]+_chk\0')
+
+PE_MACHINES = {0x14c: 'i386', 0x8664: 'x86_64', 0x1c0: 'arm', 0xaa64: 'aarch64'}
+IMAGE_DLLCHARACTERISTICS = {
+    0x20: 'high_entropy_va', 0x40: 'dynamic_base', 0x100: 'nx_compat',
+    0x400: 'no_seh', 0x4000: 'guard_cf',
+}
+IMAGE_SCN_MEM_EXECUTE = 0x20000000
+
+
+def detect_format(data: bytes) -> Optional[str]:
+    if data[:4] == b'\x7fELF':
+        return 'elf'
+    if data[:2] == b'MZ':
+        return 'pe'
+    if data[:8] == b'!<arch>\n':
+        return 'ar'
+    return None
+
+
+@contextmanager
+def mapped(path: str) -> Iterator[bytes]:
+    """Read-only mmap of path (empty files yield b'')"""
+    with open(path, 'rb') as f:
+        if os.fstat(f.fileno()).st_size == 0:
+            yield b''
+            return
+        m = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        try:
+            yield m
+        finally:
+            m.close()
+
+
+def _cstr(data: bytes, offset: int, limit: int = 4096) -> str:
+    end = data.find(b'\0', offset, offset + limit)
+    if end < 0:
+        end = min(len(data), offset + limit)
+    return bytes(data[offset:end]).decode('utf-8', errors='replace')
+
+
+def _unpack(fmt: str, data: bytes, offset: int) -> Tuple:
+    try:
+        return struct.unpack_from(fmt, data, offset)
+    except struct.error as e:
+        raise FormatError(f"truncated structure at {offset:#x}: {e}")
+
+
+class ELFFile:
+    def __init__(self, data: bytes):
+        if data[:4] != b'\x7fELF':
+            raise FormatError("not an ELF file")
+        self.data = data
+        self.bits = 64 if data[4] == 2 else 32
+        self.endian = '<' if data[5] == 1 else '>'
+        e = self.endian
+        if self.bits == 64:
+            (self.e_type, self.e_machine, _, self.entry, self.phoff, self.shoff, _, _,
+             self.phentsize, self.phnum, self.shentsize, self.shnum, self.shstrndx) = _unpack(e + 'HHIQQQIHHHHHH', data, 16)
+        else:
+            (self.e_type, self.e_machine, _, self.entry, self.phoff, self.shoff, _, _,
+             self.phentsize, self.phnum, self.shentsize, self.shnum, self.shstrndx) = _unpack(e + 'HHIIIIIHHHHHH', data, 16)
+        self.segments = self._parse_segments()
+        self.sections = self._parse_sections()
+        self.dynamic = self._parse_dynamic()
+
+    @property
+    def arch(self) -> str:
+        return ELF_MACHINES.get(self.e_machine, f'machine_{self.e_machine}')
+
+    def _parse_segments(self) -> List[Dict[str, int]]:
+        segments = []
+        fmt = self.endian + ('IIQQQQQQ' if self.bits == 64 else 'IIIIIIII')
+        for i in range(self.phnum):
+            fields = _unpack(fmt, self.data, self.phoff + i * self.phentsize)
+            if self.bits == 64:
+                p_type, p_flags, p_offset, p_vaddr, _, p_filesz, p_memsz, _ = fields
+            else:
+                p_type, p_offset, p_vaddr, _, p_filesz, p_memsz, p_flags, _ = fields
+            segments.append({'type': p_type, 'flags': p_flags, 'offset': p_offset,
+                             'vaddr': p_vaddr, 'filesz': p_filesz, 'memsz': p_memsz})
+        return segments
+
+    def _parse_sections(self) -> List[Dict[str, Any]]:
+        if not self.shoff or not self.shnum:
+            return []
+        fmt = self.endian + ('IIQQQQIIQQ' if self.bits == 64 else 'IIIIIIIIII')
+        raw = []
+        for i in range(self.shnum):
+            sh_name, sh_type, sh_flags, sh_addr, sh_offset, sh_size, sh_link, sh_info, _, sh_entsize = \
+                _unpack(fmt, self.data, self.shoff + i * self.shentsize)
+            raw.append({'name_off': sh_name, 'type': sh_type, 'flags': sh_flags, 'addr': sh_addr,
+                        'offset': sh_offset, 'size': sh_size, 'link': sh_link, 'info': sh_info,
+                        'entsize': sh_entsize})
+        strtab = raw[self.shstrndx]['offset'] if self.shstrndx < len(raw) else None
+        for section in raw:
+            section['name'] = _cstr(self.data, strtab + section.pop('name_off')) if strtab else ''
+        return raw
+
+    def section(self, name: str) -> Optional[Dict[str, Any]]:
+        for section in self.sections:
+            if section['name'] == name:
+                return section
+        return None
+
+    def _parse_dynamic(self) -> List[Tuple[int, int]]:
+        for segment in self.segments:
+            if segment['type'] != PT_DYNAMIC:
+                continue
+            fmt = self.endian + ('qQ' if self.bits == 64 else 'iI')
+            size = struct.calcsize(fmt)
+            entries = []
+            for offset in range(segment['offset'], segment['offset'] + segment['filesz'], size):
+                tag, value = _unpack(fmt, self.data, offset)
+                if tag == 0:
+                    break
+                entries.append((tag, value))
+            return entries
+        return []
+
+    def _dyn(self, tag: int) -> List[int]:
+        return [value for t, value in self.dynamic if t == tag]
+
+    @property
+    def interpreter(self) -> Optional[str]:
+        for segment in self.segments:
+            if segment['type'] == PT_INTERP:
+                return _cstr(self.data, segment['offset'])
+        return None
+
+    @property
+    def needed(self) -> List[str]:
+        dynstr = self.section('.dynstr')
+        if not dynstr:
+            return []
+        return [_cstr(self.data, dynstr['offset'] + off) for off in self._dyn(DT_NEEDED)]
+
+    def symbols(self, table: str = '.dynsym') -> List[Dict[str, Any]]:
+        section = self.section(table)
+        if not section or section['type'] not in (SHT_SYMTAB, SHT_DYNSYM) or not section['size']:
+            return []
+        strtab = self.sections[section['link']]['offset'] if section['link'] < len(self.sections) else 0
+        fmt = self.endian + ('IBBHQQ' if self.bits == 64 else 'IIIBBH')
+        entsize = section['entsize'] or struct.calcsize(fmt)
+        symbols = []
+        for offset in range(section['offset'], section['offset'] + section['size'], entsize):
+            if self.bits == 64:
+                st_name, st_info, _, st_shndx, st_value, st_size = _unpack(fmt, self.data, offset)
+            else:
+                st_name, st_value, st_size, st_info, _, st_shndx = _unpack(fmt, self.data, offset)
+            if not st_name:
+                continue
+            symbols.append({
+                'name': _cstr(self.data, strtab + st_name), 'value': st_value, 'size': st_size,
+                'type': st_info & 0xf, 'bind': st_info >> 4, 'defined': st_shndx != 0,
+                'shndx': st_shndx,
+            })
+        return symbols
+
+    def relocations(self, target: int) -> Iterator[Tuple[int, int, int]]:
+        """(offset, type, symbol index) of the REL/RELA entries applying to section index target"""
+        if self.bits == 64:
+            shift, mask = 32, 0xffffffff
+        else:
+            shift, mask = 8, 0xff
+        for section in self.sections:
+            if section['type'] not in (SHT_RELA, SHT_REL) or section['info'] != target:
+                continue
+            rela = section['type'] == SHT_RELA
+            fmt = self.endian + ('QQ' if self.bits == 64 else 'II')
+            entsize = section['entsize'] or struct.calcsize(fmt) * (3 if rela else 2) // 2
+            for offset in range(section['offset'], section['offset'] + section['size'], entsize):
+                r_offset, r_info = _unpack(fmt, self.data, offset)
+                yield r_offset, r_info & mask, r_info >> shift
+
+    def _string_tables(self) -> List[Tuple[int, int]]:
+        """(start, end) of the symbol string tables"""
+        tables = []
+        for name in ('.dynstr', '.strtab'):
+            section = self.section(name)
+            if section and section['size']:
+                tables.append((section['offset'], section['offset'] + section['size']))
+        return tables
+
+    def has_symbol_name(self, name: bytes) -> bool:
+        """Whether name appears in a symbol string table (no symbol table parsing needed)"""
+        # String tables begin with a NUL, so every entry is NUL-delimited on both sides
+        needle = b'\0' + name + b'\0'
+        return any(self.data.find(needle, start, end) >= 0 for start, end in self._string_tables())
+
+    def protections(self) -> Dict[str, Any]:
+        """checksec-equivalent view: NX, PIE, RELRO, canary, FORTIFY"""
+        types = {segment['type']: segment for segment in self.segments}
+        stack = types.get(PT_GNU_STACK)
+        flags = sum(self._dyn(DT_FLAGS))
+        flags_1 = sum(self._dyn(DT_FLAGS_1))
+        bind_now = bool(self._dyn(DT_BIND_NOW)) or bool(flags & DF_BIND_NOW) or bool(flags_1 & DF_1_NOW)
+        if PT_GNU_RELRO not in types:
+            relro = 'none'
+        else:
+            relro = 'full' if bind_now else 'partial'
+        pie = self.e_type == 3 and (PT_INTERP in types or bool(flags_1 & DF_1_PIE))
+        return {
+            'nx': stack is not None and not stack['flags'] & PF_X,
+            'pie': pie,
+            'relro': relro,
+            'canary': any(self.has_symbol_name(name) for name in _CANARY_SYMBOLS),
+            'fortify': any(m.group(0) != b'\0__stack_chk_fail\0'
+                           for start, end in self._string_tables()
+                           for m in _FORTIFY_SYMBOL.finditer(self.data, start, end)),
+        }
+
+    def _symbol_name(self, table: Dict[str, Any], index: int) -> str:
+        entsize = table['entsize'] or (24 if self.bits == 64 else 16)
+        # st_name is the first field in both the 32- and 64-bit layouts
+        (st_name,) = _unpack(self.endian + 'I', self.data, table['offset'] + index * entsize)
+        strtab = self.sections[table['link']]['offset']
+        return _cstr(self.data, strtab + st_name)
+
+    def plt_got(self) -> Dict[str, Dict[str, int]]:
+        """Imported function -> GOT slot address and (x86) PLT stub address, from the PLT relocations"""
+        relocs = self.section('.rela.plt') or self.section('.rel.plt')
+        if not relocs or relocs['type'] not in (SHT_RELA, SHT_REL) or relocs['link'] >= len(self.sections):
+            return {}
+        dynsym = self.sections[relocs['link']]
+        rela = relocs['type'] == SHT_RELA
+        if self.bits == 64:
+            fmt, shift = self.endian + ('QQq' if rela else 'QQ'), 32
+        else:
+            fmt, shift = self.endian + ('IIi' if rela else 'II'), 8
+        entsize = relocs['entsize'] or struct.calcsize(fmt)
+        # x86 lazy-binding stubs: .plt.sec (IBT) has one 16-byte stub per slot, .plt has a header stub first
+        plt_sec = self.section('.plt.sec')
+        plt = self.section('.plt')
+        if plt_sec:
+            plt_base = plt_sec['addr']
+        elif plt and self.arch in ('x86_64', 'i386'):
+            plt_base = plt['addr'] + 16
+        else:
+            plt_base = None
+        entries = {}
+        for i, offset in enumerate(range(relocs['offset'], relocs['offset'] + relocs['size'], entsize)):
+            r_offset, r_info = _unpack(fmt, self.data, offset)[:2]
+            sym_index = r_info >> shift
+            if not sym_index:
+                continue  # IRELATIVE (ifunc) slots in static binaries have no symbol
+            name = self._symbol_name(dynsym, sym_index)
+            entry = {'got': r_offset}
+            if plt_base is not None:
+                entry['plt'] = plt_base + 16 * i
+            entries[name] = entry
+        return entries
+
+    def executable_ranges(self) -> List[Tuple[int, int]]:
+        """(vaddr, size) of executable sections, falling back to executable segments"""
+        ranges = [(s['addr'], s['size']) for s in self.sections if s['flags'] & SHF_EXECINSTR and s['size']]
+        if not ranges:
+            ranges = [(s['vaddr'], s['memsz']) for s in self.segments if s['type'] == PT_LOAD and s['flags'] & PF_X]
+        return ranges
+
+    def summary(self) -> Dict[str, Any]:
+        dynsym = self.symbols('.dynsym')
+        symtab = self.symbols('.symtab')
+        imports = sorted({s['name'] for s in dynsym if not s['defined']})
+        exports = sorted({s['name'] for s in dynsym if s['defined'] and s['bind'] in (STB_GLOBAL, STB_WEAK)
+                          and s['type'] in (STT_FUNC, STT_OBJECT)})
+        functions = sorted(
+            ({'name': s['name'], 'addr': s['value'], 'size': s['size']}
+             for s in symtab if s['type'] == STT_FUNC and s['defined'] and s['value']),
+            key=lambda f: f['addr'])
+        return {
+            'format': 'elf',
+            'bits': self.bits,
+            'arch': self.arch,
+            'endian': 'little' if self.endian == '<' else 'big',
+            'type': ELF_TYPES.get(self.e_type, str(self.e_type)),
+            'entry': self.entry,
+            'interpreter': self.interpreter,
+            'static': PT_DYNAMIC not in {s['type'] for s in self.segments},
+            'stripped': not symtab,
+            'needed': self.needed,
+            'protections': self.protections(),
+            'imports': imports,
+            'plt_got': self.plt_got(),
+            'exports': exports,
+            'functions': functions,
+            'sections': [{'name': s['name'], 'addr': s['addr'], 'offset': s['offset'], 'size': s['size'],
+                          'exec': bool(s['flags'] & SHF_EXECINSTR)}
+                         for s in self.sections if s['name'] and s['type']],
+        }
+
+
+class PEFile:
+    def __init__(self, data: bytes):
+        if data[:2] != b'MZ':
+            raise FormatError("not a PE file")
+        self.data = data
+        (pe_offset,) = _unpack('<I', data, 0x3c)
+        if data[pe_offset:pe_offset + 4] != b'PE\0\0':
+            raise FormatError("missing PE signature")
+        coff = pe_offset + 4
+        (self.machine, nsections, self.timestamp, _, _, opt_size, self.characteristics) = _unpack('<HHIIIHH', data, coff)
+        opt = coff + 20
+        (magic,) = _unpack('<H', data, opt)
+        self.pe32_plus = magic == 0x20b
+        (self.entry_rva,) = _unpack('<I', data, opt + 16)
+        if self.pe32_plus:
+            (self.image_base,) = _unpack('<Q', data, opt + 24)
+            dirs_count_off, dirs_off = opt + 108, opt + 112
+        else:
+            (self.image_base,) = _unpack('<I', data, opt + 28)
+            dirs_count_off, dirs_off = opt + 92, opt + 96
+        (self.dll_characteristics,) = _unpack('<H', data, opt + 70)
+        (ndirs,) = _unpack('<I', data, dirs_count_off)
+        self.directories = [_unpack('<II', data, dirs_off + 8 * i) for i in range(min(ndirs, 16))]
+        self.sections = []
+        for i in range(nsections):
+            off = opt + opt_size + 40 * i
+            name, vsize, vaddr, raw_size, raw_ptr = _unpack('<8sIIII', data, off)
+            (chars,) = _unpack('<I', data, off + 36)
+            self.sections.append({
+                'name': name.rstrip(b'\0').decode('utf-8', errors='replace'), 'addr': vaddr,
+                'vsize': vsize, 'offset': raw_ptr, 'size': raw_size,
+                'exec': bool(chars & IMAGE_SCN_MEM_EXECUTE),
+            })
+
+    @property
+    def arch(self) -> str:
+        return PE_MACHINES.get(self.machine, f'machine_{self.machine:#x}')
+
+    def rva_to_offset(self, rva: int) -> Optional[int]:
+        for s in self.sections:
+            if s['addr'] <= rva < s['addr'] + max(s['vsize'], s['size']):
+                return s['offset'] + rva - s['addr']
+        return None
+
+    def imports(self) -> Dict[str, List[str]]:
+        result: Dict[str, List[str]] = {}
+        if len(self.directories) < 2 or not self.directories[1][0]:
+            return result
+        offset = self.rva_to_offset(self.directories[1][0])
+        thunk_fmt, ordinal_flag = ('<Q', 1 << 63) if self.pe32_plus else ('<I', 1 << 31)
+        thunk_size = struct.calcsize(thunk_fmt)
+        while offset is not None:
+            original_thunk, _, _, name_rva, first_thunk = _unpack('<IIIII', self.data, offset)
+            if not name_rva:
+                break
+            name_off = self.rva_to_offset(name_rva)
+            dll = _cstr(self.data, name_off) if name_off is not None else f'rva_{name_rva:#x}'
+            functions = result.setdefault(dll, [])
+            thunk = self.rva_to_offset(original_thunk or first_thunk)
+            while thunk is not None and len(functions) < 4096:
+                (value,) = _unpack(thunk_fmt, self.data, thunk)
+                if not value:
+                    break
+                if value & ordinal_flag:
+                    functions.append(f'ordinal_{value & 0xffff}')
+                else:
+                    hint_off = self.rva_to_offset(value & 0x7fffffff)
+                    if hint_off is not None:
+                        functions.append(_cstr(self.data, hint_off + 2))
+                thunk += thunk_size
+            offset += 20
+        return result
+
+    def exports(self) -> List[str]:
+        if not self.directories or not self.directories[0][0]:
+            return []
+        offset = self.rva_to_offset(self.directories[0][0])
+        if offset is None:
+            return []
+        (count,) = _unpack('<I', self.data, offset + 24)
+        (names_rva,) = _unpack('<I', self.data, offset + 32)
+        names_off = self.rva_to_offset(names_rva)
+        exports = []
+        for i in range(min(count, 4096) if names_off is not None else 0):
+            (name_rva,) = _unpack('<I', self.data, names_off + 4 * i)
+            name_off = self.rva_to_offset(name_rva)
+            if name_off is not None:
+                exports.append(_cstr(self.data, name_off))
+        return exports
+
+    def protections(self) -> Dict[str, Any]:
+        flags = [name for bit, name in IMAGE_DLLCHARACTERISTICS.items() if self.dll_characteristics & bit]
+        return {
+            'nx': 'nx_compat' in flags,
+            'aslr': 'dynamic_base' in flags,
+            'high_entropy_va': 'high_entropy_va' in flags,
+            'cfg': 'guard_cf' in flags,
+            'seh': 'no_seh' not in flags,
+        }
+
+    def executable_ranges(self) -> List[Tuple[int, int]]:
+        return [(self.image_base + s['addr'], s['vsize']) for s in self.sections if s['exec']]
+
+    def summary(self) -> Dict[str, Any]:
+        return {
+            'format': 'pe',
+            'bits': 64 if self.pe32_plus else 32,
+            'arch': self.arch,
+            'type': 'dll' if self.characteristics & 0x2000 else 'executable',
+            'entry': self.image_base + self.entry_rva,
+            'image_base': self.image_base,
+            'protections': self.protections(),
+            'imports': self.imports(),
+            'exports': self.exports(),
+            'sections': [{'name': s['name'], 'addr': self.image_base + s['addr'], 'offset': s['offset'],
+                          'size': s['size'], 'exec': s['exec']} for s in self.sections],
+        }
+
+
+class ArFile:
+    """Unix ar archive (static library); members are yielded as (name, offset, size)"""
+
+    def __init__(self, data: bytes):
+        if data[:8] != b'!<arch>\n':
+            raise FormatError("not an ar archive")
+        self.data = data
+        self._long_names = b''
+
+    def members(self) -> Iterator[Tuple[str, int, int]]:
+        offset = 8
+        while offset + 60 <= len(self.data):
+            header = self.data[offset:offset + 60]
+            try:
+                size = int(header[48:58].strip() or b'0')
+            except ValueError:
+                raise FormatError(f"bad ar member header at {offset:#x}")
+            body = offset + 60
+            name = header[:16].rstrip(b' ')
+            if name == b'//':
+                self._long_names = self.data[body:body + size]
+            elif name not in (b'/', b'/SYM64/'):
+                if name.startswith(b'/') and name[1:].isdigit():
+                    start = int(name[1:])
+                    end = self._long_names.find(b'/\n', start)
+                    name = self._long_names[start:end if end >= 0 else None]
+                elif name.startswith(b'#1/'):
+                    # BSD: the name follows the header and is counted in the size
+                    name_len = int(name[3:])
+                    name, body, size = self.data[body:body + name_len].rstrip(b'\0'), body + name_len, size - name_len
+                yield name.rstrip(b'/').decode('utf-8', errors='replace'), body, size
+            offset = body + size + ((body + size) & 1)
+
+    def summary(self, max_members: Optional[int] = None) -> Dict[str, Any]:
+        """Member count plus the defined functions of ELF object members"""
+        members = 0
+        objects = 0
+        defined: List[str] = []
+        for name, offset, size in self.members():
+            members += 1
+            if max_members is not None and members > max_members:
+                continue
+            if self.data[offset:offset + 4] != b'\x7fELF':
+                continue
+            try:
+                elf = ELFFile(self.data[offset:offset + size])
+            except FormatError:
+                continue
+            objects += 1
+            defined.extend(s['name'] for s in elf.symbols('.symtab')
+                           if s['defined'] and s['type'] == STT_FUNC and s['bind'] in (STB_GLOBAL, STB_WEAK))
+        return {'format': 'ar', 'members': members, 'elf_objects': objects,
+                'defined_functions': len(defined), 'sample_functions': sorted(defined)[:50]}
+
+
+def parse_binary(data: bytes):
+    """ELFFile/PEFile/ArFile for data, or None for other formats"""
+    kind = detect_format(data)
+    if kind == 'elf':
+        return ELFFile(data)
+    if kind == 'pe':
+        return PEFile(data)
+    if kind == 'ar':
+        return ArFile(data)
+    return None
@@ -0,0 +1,110 @@
+"""
+Binary facts for the agent's discovered_info
+
+Reads the workspace binaries directly (header parsing, tens of microseconds per
+file) instead of hoping the agent ran `file`/`checksec` and pattern-matching
+their output. Files are listed and read through the execution backend, since a
+pooled container only syncs its workspace back to the host on release. Results
+are cached per (name, size, mtime), so refreshing after every step only costs a
+directory listing.
+"""
+import logging
+from typing import Any, Dict, Optional, Tuple
+
+from ctf_solver.analysis.binfmt import ELFFile, FormatError, PEFile, detect_format, mapped
+
+
+logger = logging.getLogger(__name__)
+
+MAX_GOT_ENTRIES = 32
+MAX_FACTS_BYTES = 64 * 1024 * 1024  # Larger files (core dumps, disk images) are not pulled out to parse
+WORKSPACE_DIR = '/challenge'
+
+
+def binary_facts(path: str) -> Optional[Dict[str, Any]]:
+    """Compact facts for one ELF/PE file, or None if path is not one"""
+    with mapped(path) as data:
+        return data_facts(data, path)
+
+
+def data_facts(data: bytes, source: str) -> Optional[Dict[str, Any]]:
+    """binary_facts for file contents already in memory (source is only used in logs)"""
+    kind = detect_format(data)
+    if kind not in ('elf', 'pe'):
+        return None
+    try:
+        if kind == 'elf':
+            elf = ELFFile(data)
+            protections = elf.protections()
+            if protections['pie']:
+                elf_type = 'pie'
+            else:
+                elf_type = {2: 'executable', 3: 'shared'}.get(elf.e_type, 'relocatable')
+            facts = {
+                'format': 'elf', 'arch': elf.arch, 'bits': elf.bits, 'type': elf_type,
+                'static': not elf.dynamic,
+                'stripped': elf.section('.symtab') is None,
+                'entry': hex(elf.entry),
+                **protections,
+            }
+            slots = elf.plt_got()
+            if slots and len(slots) <= MAX_GOT_ENTRIES:
+                facts['got'] = {name: hex(entry['got']) for name, entry in slots.items()}
+                facts['plt'] = {name: hex(entry['plt']) for name, entry in slots.items() if 'plt' in entry}
+            return facts
+        pe = PEFile(data)
+        return {'format': 'pe', 'arch': pe.arch, 'bits': 64 if pe.pe32_plus else 32,
+                'entry': hex(pe.image_base + pe.entry_rva), **pe.protections()}
+    except FormatError as e:
+        logger.debug(f"Cannot parse {source}: {e}")
+        return None
+
+
+def _is_primary(facts: Dict[str, Any]) -> bool:
+    return facts['format'] == 'pe' or facts.get('type') in ('executable', 'pie')
+
+
+class WorkspaceFacts:
+    """discovered_info entries derived from the binaries in an attempt workspace"""
+
+    def __init__(self, backend, directory: str = WORKSPACE_DIR):
+        self.backend = backend
+        self.directory = directory
+        self._cache: Dict[str, Tuple[Tuple[int, int], Optional[Dict[str, Any]]]] = {}
+
+    def _read_facts(self, name: str, size: int) -> Optional[Dict[str, Any]]:
+        if not 0 < size <= MAX_FACTS_BYTES:
+            return None
+        path = f'{self.directory}/{name}'
+        try:
+            data, _ = self.backend.get_file(path)
+        except Exception as e:
+            logger.debug(f"Cannot read {path}: {e}")
+            return None
+        return data_facts(data, path)
+
+    def refresh(self) -> Dict[str, Any]:
+        binaries: Dict[str, Dict[str, Any]] = {}
+        try:
+            files = self.backend.list_files(self.directory)
+        except Exception as e:
+            logger.debug(f"Cannot list {self.directory}: {e}")
+            return {}
+        for name in sorted(files):
+            stamp = files[name]
+            cached = self._cache.get(name)
+            if cached is None or cached[0] != stamp:
+                cached = (stamp, self._read_facts(name, stamp[0]))
+                self._cache[name] = cached
+            if cached[1] is not None:
+                binaries[name] = cached[1]
+        if not binaries:
+            return {}
+
+        # The challenge binary's properties also go at the top level, where prompts expect them
+        primary = next((name for name, facts in binaries.items() if _is_primary(facts)), next(iter(binaries)))
+        info = {key: binaries[primary][key] for key in ('arch', 'nx', 'canary', 'pie', 'relro')
+                if key in binaries[primary]}
+        info['binary'] = primary
+        info['binaries'] = binaries
+        return info
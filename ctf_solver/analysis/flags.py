@@ -0,0 +1,221 @@
+"""
+Flag detection in command output, compiled once per challenge
+
+FlagMatcher holds the challenge's flag-format regex (compiled for bytes) and,
+when the format has a literal prefix such as `picoCTF{`, that prefix in encoded
+form: base64 at each of the three byte alignments, hex, reversed and URL-encoded.
+Output is searched for the prefix, a `flag:` label and the encoded needles with
+bytes.find; the regex only runs where a needle hit, and the token around an
+encoded hit is decoded and must match the full flag format.
+
+FlagStream feeds the same search chunk by chunk with a fixed overlap, so matches
+spanning chunk boundaries are found while only a bounded window is kept.
+"""
+import base64
+import binascii
+import functools
+import logging
+import re
+import urllib.parse
+from typing import Iterator, List, Optional, Tuple
+
+from ctf_solver.analysis.xorscan import MAX_FLAG_LEN, flag_prefix
+
+
+logger = logging.getLogger(__name__)
+
+DEFAULT_FORMAT = r'picoCTF\{[^}]+\}'
+# Bytes kept between stream chunks: enough for the hex form of the longest flag plus context
+STREAM_OVERLAP = 4 * MAX_FLAG_LEN
+_MAX_FINDINGS = 50
+
+_INDICATOR = re.compile(rb'flag:\s*(\S+)', re.IGNORECASE)
+_BRACES = re.compile(r'\{([^}]*)\}')
+_PLACEHOLDER = re.compile(r'\s*%[a-zA-Z]|%\(.*?\)[sd]|\{\w+\}|\s*')
+_B64_CHARS = frozenset(b'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/-_')
+_TOKENS = {
+    'base64': re.compile(rb'[A-Za-z0-9+/_-]+={0,2}'),
+    'hex': re.compile(rb'[0-9a-fA-F]+'),
+    'url': re.compile(rb'[A-Za-z0-9%._~+!*\'()-]+'),
+}
+
+
+def plausible(flag: str) -> bool:
+    """Reject placeholders and templates (`picoCTF{%s}`, `flag{...}` with a tiny body)"""
+    inner_match = _BRACES.search(flag)
+    inner = inner_match.group(1) if inner_match else ''
+    return not _PLACEHOLDER.fullmatch(inner) and len(inner) >= 4
+
+
+def _find_all(data: bytes, needle: bytes, start: int, stop: int) -> Iterator[int]:
+    pos = data.find(needle, start)
+    while 0 <= pos < stop:
+        yield pos
+        pos = data.find(needle, pos + 1)
+
+
+def _b64_needles(prefix: bytes) -> List[bytes]:
+    """Base64 characters fixed by the prefix alone, for each alignment of it in the encoded data"""
+    needles = []
+    for shift in range(3):
+        encoded = base64.b64encode(b'\0' * shift + prefix)
+        # Character i covers bits 6i..6i+6; keep those inside the prefix's bits
+        first = -(-8 * shift // 6)
+        last = 8 * (shift + len(prefix)) // 6
+        needle = encoded[first:last]
+        if len(needle) >= 4:
+            needles.append(needle)
+    return needles
+
+
+class FlagMatcher:
+    """Compiled flag detector for one flag format"""
+
+    def __init__(self, flag_format: Optional[str]):
+        self.flag_format = flag_format or DEFAULT_FORMAT
+        try:
+            self._flag_re = re.compile(self.flag_format.encode('utf-8'), re.IGNORECASE | re.MULTILINE)
+        except (re.error, UnicodeEncodeError):
+            logger.warning(f"Invalid flag format {self.flag_format!r}; using {DEFAULT_FORMAT}")
+            self.flag_format = DEFAULT_FORMAT
+            self._flag_re = re.compile(DEFAULT_FORMAT.encode('utf-8'), re.IGNORECASE | re.MULTILINE)
+        self.prefix = flag_prefix(self.flag_format)
+        # (needle, kind, case-insensitive) for the encoded forms of the prefix
+        self._needles: List[Tuple[bytes, str, bool]] = []
+        if self.prefix:
+            self._needles += [(needle, 'base64', False) for needle in _b64_needles(self.prefix)]
+            self._needles += [
+                (self.prefix.hex().encode(), 'hex', True),
+                (self.prefix[::-1].lower(), 'reversed', True),
+                (urllib.parse.quote(self.prefix, safe='').encode().lower(), 'url', True),
+            ]
+
+    @classmethod
+    @functools.lru_cache(maxsize=64)
+    def for_format(cls, flag_format: Optional[str]) -> 'FlagMatcher':
+        """Shared matcher per format (compiling the needles is the expensive part)"""
+        return cls(flag_format)
+
+    # ===== Whole-output search =====
+
+    def find(self, text: str) -> Optional[str]:
+        """The first plausible flag in text: as printed, after a `flag:` label, then in encoded form"""
+        if not text:
+            return None
+        for flag, _ in self.scan(text.encode('utf-8', errors='replace')):
+            return flag
+        return None
+
+    def scan(self, data: bytes, start: int = 0, stop: Optional[int] = None) -> Iterator[Tuple[str, str]]:
+        """(flag, how it was found) for matches beginning in data[start:stop], plain ones first.
+
+        Literal needles are located with bytes.find (on a lowercased copy where the match is
+        case-insensitive) and only confirmed by a regex, which keeps large outputs fast.
+        """
+        stop = len(data) if stop is None else stop
+        lowered = data.lower()
+        if self.prefix:
+            starts = _find_all(lowered, self.prefix.lower(), start, stop)
+            plain = (self._flag_re.match(data, pos) for pos in starts)
+        else:
+            plain = (m for m in self._flag_re.finditer(data, start) if m.start() < stop)
+        for m in plain:
+            if m is None:
+                continue
+            flag = m.group(0).decode('utf-8', errors='replace').strip()
+            if plausible(flag):
+                yield flag, 'plain'
+        for pos in _find_all(lowered, b'flag:', start, stop):
+            m = _INDICATOR.match(data, pos)
+            if m and self._flag_re.match(m.group(1)):
+                flag = m.group(1).decode('utf-8', errors='replace')
+                if plausible(flag):
+                    yield flag, 'indicator'
+        for needle, kind, nocase in self._needles:
+            for pos in _find_all(lowered if nocase else data, needle, start, stop):
+                flag = self._decode_at(data, kind, pos, pos + len(needle))
+                if flag and plausible(flag):
+                    yield flag, kind
+
+    def _decode_at(self, data: bytes, kind: str, begin: int, end: int) -> Optional[str]:
+        if kind == 'base64':
+            decoded = self._decode_b64(data, begin)
+        elif kind == 'hex':
+            token = _TOKENS['hex'].match(data, begin).group(0)
+            try:
+                decoded = binascii.unhexlify(token[:len(token) // 2 * 2])
+            except binascii.Error:
+                return None
+        elif kind == 'url':
+            token = _TOKENS['url'].match(data, begin).group(0)
+            decoded = urllib.parse.unquote_to_bytes(token)
+        else:
+            # The reversed prefix ends the reversed flag: read backwards from its end
+            decoded = data[max(0, end - 2 * MAX_FLAG_LEN):end][::-1]
+        found = self._flag_re.search(decoded)
+        if found is None:
+            return None
+        return found.group(0).decode('utf-8', errors='replace').strip()
+
+    def _decode_b64(self, data: bytes, pos: int) -> bytes:
+        """Decode the base64 token around pos, trying each 4-character phase until the prefix appears"""
+        begin = pos
+        floor = max(0, pos - 2 * MAX_FLAG_LEN)
+        while begin > floor and data[begin - 1] in _B64_CHARS:
+            begin -= 1
+        token = _TOKENS['base64'].match(data, begin).group(0).rstrip(b'=')
+        altchars = b'-_' if b'-' in token or b'_' in token else None
+        for skip in range(4):
+            chunk = token[skip:]
+            # A lone trailing character carries no whole byte; otherwise pad the last group
+            chunk = chunk[:-1] if len(chunk) % 4 == 1 else chunk + b'=' * (-len(chunk) % 4)
+            try:
+                decoded = base64.b64decode(chunk, altchars=altchars)
+            except (binascii.Error, ValueError):
+                continue
+            if self.prefix.lower() in decoded.lower():
+                return decoded
+        return b''
+
+    def stream(self) -> 'FlagStream':
+        return FlagStream(self)
+
+
+class FlagStream:
+    """Incremental scan over a byte stream; findings are (flag, kind), deduplicated by flag"""
+
+    def __init__(self, matcher: FlagMatcher):
+        self.matcher = matcher
+        self.findings: List[Tuple[str, str]] = []
+        self._buf = b''
+        self._next = 0  # offset in _buf where unscanned match starts begin
+
+    def feed(self, data: bytes) -> None:
+        if len(self.findings) >= _MAX_FINDINGS:
+            return
+        self._buf += data
+        # Match starts within STREAM_OVERLAP of the end wait for more data (their token may continue)
+        stop = len(self._buf) - STREAM_OVERLAP
+        if stop <= self._next:
+            return
+        self._collect(stop)
+        # Keep context before the next scan position for tokens that begin earlier (base64, reversed)
+        drop = max(0, stop - 2 * MAX_FLAG_LEN)
+        self._buf = self._buf[drop:]
+        self._next = stop - drop
+
+    def results(self) -> List[Tuple[str, str]]:
+        """Findings including the held-back tail (feeding may continue afterwards)"""
+        if len(self.findings) < _MAX_FINDINGS:
+            self._collect(len(self._buf))
+        return self.findings
+
+    def _collect(self, stop: int) -> None:
+        seen = {flag for flag, _ in self.findings}
+        for flag, kind in self.matcher.scan(self._buf, self._next, stop):
+            if flag not in seen:
+                seen.add(flag)
+                self.findings.append((flag, kind))
+                if len(self.findings) >= _MAX_FINDINGS:
+                    break
+        self._next = stop
@@ -0,0 +1,403 @@
+"""
+Library function signatures for stripped static binaries
+
+Statically linked challenges often ship the libc.a/libstdc++.a they were built
+against, so most of the stripped binary is code whose names are one archive
+parse away. FLIRT-style, every function in an archive's object members becomes
+a signature: its bytes with the relocated fields (and the instruction bytes the
+linker may relax around them) masked out. As static link layouts are not
+aligned, the stripped binary is searched for each signature's longest unmasked run
+with bytes.find and every hit is verified by hashing the masked window, with
+the anchors split across worker processes.
+
+Indexes are cached per archive SHA-256 and symbol maps per (binary, archives),
+both under ANALYSIS_DIR, so a challenge pays for this once at sync time.
+"""
+import bisect
+import hashlib
+import json
+import logging
+import os
+import re
+import tempfile
+from collections import Counter
+from concurrent.futures import ProcessPoolExecutor
+from pathlib import Path
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+
+from ctf_solver.analysis.binfmt import (
+    SHF_EXECINSTR, STB_GLOBAL, STB_WEAK, STT_FUNC, ArFile, ELFFile, FormatError, detect_format, mapped,
+)
+from ctf_solver.analysis.triage import sha256_file
+from ctf_solver.config import ANALYSIS_DIR, ANALYSIS_WORKERS
+
+
+logger = logging.getLogger(__name__)
+
+# Bump whenever signature generation or the symbol map layout changes
+SIGNATURE_VERSION = 1
+
+MIN_FUNC_LEN = 24
+ANCHOR_LEN = 16
+MIN_ANCHOR_LEN = 6
+# Signatures that are mostly relocations say little about the code
+MAX_MASKED_RATIO = 0.5
+# Short signatures matching more often than this are compiler idioms, not functions
+MAX_OCCURRENCES = 4
+UNIQUE_LEN = 64
+# Bytes of code per matcher job
+SPAN = 1 << 20
+SHT_NOBITS = 8
+
+# Relocated field widths by ELF relocation type; anything else is 4 bytes
+_X86_64_WIDTHS = {1: 8, 12: 2, 13: 2, 14: 1, 15: 1, 24: 8, 25: 8, 33: 8}
+_I386_WIDTHS = {20: 2, 21: 2, 22: 1, 23: 1}
+# Relaxable GOT/TLS loads: the linker may rewrite the opcode/ModRM (and REX) before the field
+_X86_64_RELAXED = {9: 3, 22: 3, 41: 3, 42: 3}
+_I386_RELAXED = {3: 2, 43: 2, 15: 2, 16: 2}
+# General/local-dynamic TLS sequences are replaced wholesale by the linker
+_X86_64_TLS_SEQUENCES = {19: (4, 12), 20: (3, 9)}
+
+_BIND_RANK = {STB_GLOBAL: 0, STB_WEAK: 1}
+
+
+def _masks(arch: str, relocations: Iterable[Tuple[int, int]], start: int, length: int) -> List[Tuple[int, int]]:
+    """Merged (begin, end) byte ranges of a function to ignore, relative to its start"""
+    if arch == 'x86_64':
+        widths, relaxed, sequences = _X86_64_WIDTHS, _X86_64_RELAXED, _X86_64_TLS_SEQUENCES
+    else:
+        widths, relaxed, sequences = _I386_WIDTHS, _I386_RELAXED, {}
+    ranges = []
+    for offset, rtype in relocations:
+        rel = offset - start
+        if rtype in sequences:
+            before, after = sequences[rtype]
+            begin, end = rel - before, rel + after
+        else:
+            begin, end = rel - relaxed.get(rtype, 0), rel + widths.get(rtype, 4)
+        if end > 0 and begin < length:
+            ranges.append((max(begin, 0), min(end, length)))
+    merged: List[Tuple[int, int]] = []
+    for begin, end in sorted(ranges):
+        if merged and begin <= merged[-1][1]:
+            merged[-1] = (merged[-1][0], max(merged[-1][1], end))
+        else:
+            merged.append((begin, end))
+    return merged
+
+
+def _apply(window: bytes, masks: Iterable[Tuple[int, int]]) -> bytes:
+    if not masks:
+        return bytes(window)
+    out = bytearray(window)
+    for begin, end in masks:
+        out[begin:end] = bytes(end - begin)
+    return bytes(out)
+
+
+def object_signatures(data: bytes) -> List[Dict[str, Any]]:
+    """Signatures of the functions defined in one relocatable ELF object"""
+    elf = ELFFile(data)
+    if elf.arch not in ('x86_64', 'i386'):
+        return []
+    symbols = [s for s in elf.symbols('.symtab')
+               if s['defined'] and s['shndx'] < len(elf.sections) and elf.sections[s['shndx']]['flags'] & SHF_EXECINSTR]
+    # Hand-written assembly (memcpy & co.) often has size-0 symbols: they run up to the next one
+    starts: Dict[int, List[int]] = {}
+    for symbol in symbols:
+        starts.setdefault(symbol['shndx'], []).append(symbol['value'])
+    by_location: Dict[Tuple[int, int], Dict[str, Any]] = {}
+    for symbol in symbols:
+        if symbol['type'] != STT_FUNC:
+            continue
+        shndx = symbol['shndx']
+        size = symbol['size']
+        if not size:
+            later = [v for v in starts[shndx] if v > symbol['value']]
+            size = min(later, default=elf.sections[shndx]['size']) - symbol['value']
+        if size < MIN_FUNC_LEN:
+            continue
+        entry = by_location.setdefault((shndx, symbol['value']), {'names': [], 'size': size})
+        entry['names'].append((_BIND_RANK.get(symbol['bind'], 2), symbol['name'].startswith('_'), symbol['name']))
+    relocations: Dict[int, List[Tuple[int, int]]] = {}
+    signatures = []
+    for (shndx, value), entry in by_location.items():
+        if shndx not in relocations:
+            relocations[shndx] = [(offset, rtype) for offset, rtype, _ in elf.relocations(shndx)]
+        section = elf.sections[shndx]
+        length = min(entry['size'], section['size'] - value)
+        if length < MIN_FUNC_LEN:
+            continue
+        masks = _masks(elf.arch, relocations[shndx], value, length)
+        if sum(end - begin for begin, end in masks) > length * MAX_MASKED_RATIO:
+            continue
+        start = section['offset'] + value
+        # Public names first (fwrite before its weak alias fwrite_unlocked): they are what a reverser looks up
+        names = [name for _, _, name in sorted(entry['names'])]
+        signatures.append({'names': names, 'length': length, 'masks': masks,
+                           'pattern': _apply(data[start:start + length], masks).hex()})
+    return signatures
+
+
+def archive_signatures(path: str) -> Dict[str, Any]:
+    """Signatures for every ELF object member of a static library"""
+    signatures: List[Dict[str, Any]] = []
+    arch = None
+    with mapped(path) as data:
+        for name, offset, size in ArFile(data).members():
+            if data[offset:offset + 4] != b'\x7fELF':
+                continue
+            member = data[offset:offset + size]
+            try:
+                found = object_signatures(member)
+            except FormatError as e:
+                logger.debug(f"Skipping {name} in {path}: {e}")
+                continue
+            if found and arch is None:
+                arch = ELFFile(member).arch
+            signatures.extend(found)
+    return {'version': SIGNATURE_VERSION, 'archive': os.path.basename(path), 'arch': arch,
+            'signatures': signatures}
+
+
+class SignatureIndex:
+    """Signatures keyed by an anchor: their longest unmasked run of bytes (capped at ANCHOR_LEN).
+
+    Statically linked code is packed without alignment, so instead of guessing
+    where functions start, every offset of the code is checked against the anchors'
+    8-byte heads (one pass per byte phase over the code read as 64-bit words) and
+    the full masked pattern is verified around each hit.
+    """
+
+    def __init__(self, signatures: Iterable[Dict[str, Any]]):
+        self.anchors: Dict[bytes, Dict[Tuple, Dict[bytes, List[str]]]] = {}
+        self.size = 0
+        for sig in signatures:
+            pattern = bytes.fromhex(sig['pattern'])
+            masks = tuple(tuple(m) for m in sig['masks'])
+            offset, length = _longest_run(sig['length'], masks)
+            if length < MIN_ANCHOR_LEN:
+                continue  # nothing distinctive to search for
+            anchor = pattern[offset:offset + length]
+            groups = self.anchors.setdefault(anchor, {})
+            names = groups.setdefault((offset, sig['length'], masks), {}).setdefault(pattern, [])
+            names.extend(n for n in sig['names'] if n not in names)
+            self.size += 1
+
+        # 8-byte heads let a single pass over the code find every anchor occurrence
+        self.heads: Dict[int, List[bytes]] = {}
+        self.short: List[bytes] = []
+        for anchor in self.anchors:
+            if len(anchor) >= 8:
+                self.heads.setdefault(int.from_bytes(anchor[:8], 'little'), []).append(anchor)
+            else:
+                self.short.append(anchor)
+
+    def _hits(self, data: bytes, lo: int, hi: int) -> Dict[bytes, List[int]]:
+        """Anchor -> offsets in [lo, hi) where it occurs"""
+        hits: Dict[bytes, List[int]] = {}
+        heads = self.heads
+        with memoryview(data) as view:
+            # Reading the code as 64-bit words at each of the 8 byte phases covers every 8-byte window
+            for phase in range(8):
+                first = lo + phase
+                count = (min(hi, len(data) - 7) - first + 7) // 8
+                if count <= 0:
+                    continue
+                with view[first:first + count * 8].cast('Q') as words:
+                    found = [(i, w) for i, w in enumerate(words) if w in heads]
+                for i, head in found:
+                    pos = first + 8 * i
+                    for anchor in heads[head]:
+                        if data[pos:pos + len(anchor)] == anchor:
+                            hits.setdefault(anchor, []).append(pos)
+        for anchor in self.short:
+            pos = data.find(anchor, lo, hi + len(anchor) - 1)
+            while pos >= 0:
+                hits.setdefault(anchor, []).append(pos)
+                pos = data.find(anchor, pos + 1, hi + len(anchor) - 1)
+        return hits
+
+    def match(self, data: bytes, begin: int, end: int, lo: int, hi: int) -> List[Tuple[int, int, List[str]]]:
+        """(offset, length, names) of verified matches within data[begin:end] whose anchor starts in [lo, hi)"""
+        matches = []
+        for anchor, positions in self._hits(data, lo, hi).items():
+            for (offset, length, masks), patterns in self.anchors[anchor].items():
+                for pos in positions:
+                    start = pos - offset
+                    if start < begin or start + length > end:
+                        continue
+                    names = patterns.get(_apply(data[start:start + length], masks))
+                    if names:
+                        matches.append((start, length, names))
+        return matches
+
+
+def _longest_run(length: int, masks: Tuple[Tuple[int, int], ...]) -> Tuple[int, int]:
+    """(offset, length) of the longest unmasked run, capped at ANCHOR_LEN"""
+    best = (0, 0)
+    previous = 0
+    for begin, end in (*masks, (length, length)):
+        if begin - previous > best[1]:
+            best = (previous, begin - previous)
+        previous = end
+    return best[0], min(best[1], ANCHOR_LEN)
+
+
+def _text_ranges(elf: ELFFile) -> List[Tuple[int, int]]:
+    return [(s['offset'], s['offset'] + s['size']) for s in elf.sections
+            if s['flags'] & SHF_EXECINSTR and s['size'] and s['type'] != SHT_NOBITS]
+
+
+def _offset_to_addr(elf: ELFFile, offset: int) -> Optional[int]:
+    for section in elf.sections:
+        if section['addr'] and section['offset'] <= offset < section['offset'] + section['size']:
+            return section['addr'] + offset - section['offset']
+    return None
+
+
+# Per-process matcher state for the worker pool (set once by the initializer)
+_worker_index: Optional[SignatureIndex] = None
+_worker_path: Optional[str] = None
+
+
+def _init_worker(index: SignatureIndex, path: str) -> None:
+    global _worker_index, _worker_path
+    _worker_index, _worker_path = index, path
+
+
+def _match_span(region: Tuple[int, int], span: Tuple[int, int]) -> List[Tuple[int, int, List[str]]]:
+    with mapped(_worker_path) as data:
+        return _worker_index.match(data, region[0], region[1], span[0], span[1])
+
+
+def match_binary(path: str, index: SignatureIndex, workers: int = ANALYSIS_WORKERS) -> Dict[str, Any]:
+    """Label the functions of a stripped ELF: {'functions': {addr: {'name', 'size', 'aliases'}}, ...}"""
+    with mapped(path) as data:
+        regions = _text_ranges(ELFFile(data))
+    jobs = []
+    for begin, end in regions:
+        step = max(SPAN, -(-(end - begin) // max(workers, 1)))
+        jobs.extend(((begin, end), (lo, min(lo + step, end))) for lo in range(begin, end, step))
+    if workers <= 1 or len(jobs) <= 1:
+        _init_worker(index, path)
+        matches = [m for region, span in jobs for m in _match_span(region, span)]
+    else:
+        with ProcessPoolExecutor(max_workers=min(workers, len(jobs)), initializer=_init_worker,
+                                 initargs=(index, path)) as executor:
+            matches = [m for found in executor.map(_match_span, *zip(*jobs)) for m in found]
+
+    # Code that recurs all over the binary is a generic idiom, not an identification
+    occurrences = Counter((length, names[0]) for _, length, names in matches)
+    matches = [m for m in matches if m[1] >= UNIQUE_LEN or occurrences[(m[1], m[2][0])] <= MAX_OCCURRENCES]
+
+    # Longest matches claim their bytes first; shorter ones overlapping them are coincidences
+    claimed: List[Tuple[int, int]] = []
+    accepted = []
+    for start, length, names in sorted(matches, key=lambda m: (-m[1], m[0])):
+        i = bisect.bisect_left(claimed, (start, 0))
+        if (i < len(claimed) and claimed[i][0] < start + length) or (i and claimed[i - 1][1] > start):
+            continue
+        claimed.insert(i, (start, start + length))
+        accepted.append((start, length, names))
+
+    functions: Dict[str, Dict[str, Any]] = {}
+    with mapped(path) as data:
+        elf = ELFFile(data)
+        for start, length, names in sorted(accepted):
+            addr = _offset_to_addr(elf, start)
+            if addr is None:
+                continue
+            entry = {'name': names[0], 'size': length}
+            if len(names) > 1:
+                entry['aliases'] = names[1:8]
+            functions[f'{addr:#x}'] = entry
+    return {'version': SIGNATURE_VERSION, 'binary': os.path.basename(path), 'functions': functions}
+
+
+def _symbol_ident(name: str) -> str:
+    return re.sub(r'[^A-Za-z0-9_]', '_', name)
+
+
+def render_scripts(symbol_map: Dict[str, Any]) -> Dict[str, str]:
+    """gdb and radare2 scripts naming the matched functions"""
+    gdb = ['# Recovered library functions: `source` this, then e.g. `break *$fn_printf`']
+    r2 = ['# Recovered library functions: load with `. <file>` or r2 -i <file>']
+    for addr, entry in symbol_map['functions'].items():
+        ident = _symbol_ident(entry['name'])
+        gdb.append(f"set $fn_{ident} = {addr}")
+        r2.append(f"f sym.{ident} {entry['size']} @ {addr}")
+        r2.append(f"af {ident} @ {addr}")
+    return {'gdb': '\n'.join(gdb) + '\n', 'r2': '\n'.join(r2) + '\n'}
+
+
+class SignatureStore:
+    """Cached archive indexes and symbol maps under <ANALYSIS_DIR>/signatures/v<SIGNATURE_VERSION>"""
+
+    def __init__(self, root: str = ANALYSIS_DIR):
+        self.root = Path(root).expanduser() / 'signatures' / f'v{SIGNATURE_VERSION}'
+
+    def _load(self, path: Path) -> Optional[Dict[str, Any]]:
+        try:
+            with open(path) as f:
+                return json.load(f)
+        except (OSError, ValueError):
+            return None
+
+    def _save(self, path: Path, payload: Dict[str, Any]) -> None:
+        path.parent.mkdir(parents=True, exist_ok=True)
+        fd, tmp = tempfile.mkstemp(dir=path.parent, suffix='.tmp')
+        with os.fdopen(fd, 'w') as f:
+            json.dump(payload, f)
+        os.replace(tmp, path)
+
+    def archive(self, path: str, digest: Optional[str] = None) -> Dict[str, Any]:
+        digest = digest or sha256_file(path)
+        cached = self.root / 'archives' / digest[:2] / f'{digest}.json'
+        signatures = self._load(cached)
+        if signatures is None:
+            signatures = archive_signatures(path)
+            self._save(cached, signatures)
+            logger.info(f"Built {len(signatures['signatures'])} signatures from {os.path.basename(path)}")
+        return signatures
+
+    def symbol_map(self, binary: str, archives: List[str], workers: int = ANALYSIS_WORKERS) -> Optional[Dict[str, Any]]:
+        """Symbol map for binary from the given archives (cached by their contents)"""
+        binary_digest = sha256_file(binary)
+        archive_digests = {path: sha256_file(path) for path in archives}
+        combined = hashlib.sha256(''.join(sorted(archive_digests.values())).encode()).hexdigest()[:16]
+        cached = self.root / 'maps' / binary_digest[:2] / f'{binary_digest}-{combined}.json'
+        symbol_map = self._load(cached)
+        if symbol_map is not None:
+            return symbol_map
+        signatures: List[Dict[str, Any]] = []
+        for path, digest in archive_digests.items():
+            signatures.extend(self.archive(path, digest)['signatures'])
+        if not signatures:
+            return None
+        index = SignatureIndex(signatures)
+        symbol_map = match_binary(binary, index, workers)
+        symbol_map['archives'] = sorted(os.path.basename(path) for path in archives)
+        symbol_map['signatures'] = index.size
+        self._save(cached, symbol_map)
+        logger.info(f"Named {len(symbol_map['functions'])} functions in {os.path.basename(binary)} "
+                    f"from {len(signatures)} signatures")
+        return symbol_map
+
+
+def stripped_static_targets(paths: Iterable[str]) -> Tuple[List[str], List[str]]:
+    """(stripped ELF executables, ar archives) among paths: the inputs for symbol recovery"""
+    binaries, archives = [], []
+    for path in paths:
+        try:
+            with mapped(path) as data:
+                kind = detect_format(data)
+                if kind == 'ar':
+                    archives.append(path)
+                elif kind == 'elf':
+                    elf = ELFFile(data)
+                    if elf.e_type in (2, 3) and elf.section('.symtab') is None:
+                        binaries.append(path)
+        except (OSError, FormatError):
+            continue
+    return binaries, archives
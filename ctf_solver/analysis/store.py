@@ -0,0 +1,114 @@
+"""
+On-disk store of triage artifacts and the parallel pipeline that fills it
+
+Artifacts live at <ANALYSIS_DIR>/v<ANALYSIS_VERSION>/<sha[:2]>/<sha>.json, so the
+same binary shipped with several challenges (or re-imported) is analysed once,
+and bumping ANALYSIS_VERSION invalidates everything without a migration.
+Symbol maps recovered for a challenge are kept next to them under symbols/,
+keyed by the contents of the challenge's whole file set.
+"""
+import json
+import logging
+import os
+import tempfile
+from concurrent.futures import ProcessPoolExecutor, as_completed
+from pathlib import Path
+from typing import Any, Dict, Iterable, List, Optional
+
+from ctf_solver.analysis.triage import ANALYSIS_VERSION, analyze_file, sha256_file
+from ctf_solver.config import ANALYSIS_DIR, ANALYSIS_WORKERS
+
+
+logger = logging.getLogger(__name__)
+
+
+class AnalysisStore:
+    def __init__(self, root: str = ANALYSIS_DIR):
+        self.root = Path(root).expanduser() / f'v{ANALYSIS_VERSION}'
+
+    def _path(self, sha256: str) -> Path:
+        return self.root / sha256[:2] / f'{sha256}.json'
+
+    def get(self, sha256: str) -> Optional[Dict[str, Any]]:
+        try:
+            with open(self._path(sha256)) as f:
+                return json.load(f)
+        except (OSError, ValueError):
+            return None
+
+    def put(self, artifact: Dict[str, Any]) -> None:
+        self._save(self._path(artifact['sha256']), artifact)
+
+    def _symbols_path(self, key: str) -> Path:
+        return self.root / 'symbols' / key[:2] / f'{key}.json'
+
+    def get_symbols(self, key: str) -> Optional[Dict[str, Any]]:
+        """Symbol maps (binary name -> map) stored for a challenge file set, or None"""
+        try:
+            with open(self._symbols_path(key)) as f:
+                return json.load(f)
+        except (OSError, ValueError):
+            return None
+
+    def put_symbols(self, key: str, maps: Dict[str, Any]) -> None:
+        self._save(self._symbols_path(key), maps)
+
+    @staticmethod
+    def _save(path: Path, payload: Dict[str, Any]) -> None:
+        path.parent.mkdir(parents=True, exist_ok=True)
+        fd, tmp = tempfile.mkstemp(dir=path.parent, suffix='.tmp')
+        with os.fdopen(fd, 'w') as f:
+            json.dump(payload, f)
+        os.replace(tmp, path)
+
+    def analyze_files(self, paths: Iterable[str], workers: int = ANALYSIS_WORKERS) -> Dict[str, Dict[str, Any]]:
+        """Artifacts for paths (path -> artifact), analysing files not yet in the store in parallel"""
+        artifacts: Dict[str, Dict[str, Any]] = {}
+        pending: Dict[str, List[str]] = {}  # sha256 -> paths with that content
+        for path in paths:
+            try:
+                digest = sha256_file(path)
+            except OSError as e:
+                logger.warning(f"Cannot hash {path} for analysis: {e}")
+                continue
+            artifact = self.get(digest)
+            if artifact is not None:
+                artifacts[path] = artifact
+            else:
+                pending.setdefault(digest, []).append(path)
+        if not pending:
+            return artifacts
+
+        logger.info(f"Analysing {len(pending)} new file(s) with {workers} worker(s)")
+        jobs = {digest: same[0] for digest, same in pending.items()}
+        for digest, artifact in self._run(jobs, workers):
+            if artifact is None:
+                continue
+            self.put(artifact)
+            for path in pending[digest]:
+                artifacts[path] = artifact
+        return artifacts
+
+    def _run(self, jobs: Dict[str, str], workers: int):
+        """Yield (sha256, artifact or None) for each job; one file per worker process"""
+        if workers <= 1 or len(jobs) == 1:
+            for digest, path in jobs.items():
+                yield digest, self._analyze(path, digest)
+            return
+        with ProcessPoolExecutor(max_workers=min(workers, len(jobs))) as executor:
+            futures = {executor.submit(analyze_file, path, digest): digest for digest, path in jobs.items()}
+            for future in as_completed(futures):
+                digest = futures[future]
+                try:
+                    yield digest, future.result()
+                except Exception as e:
+                    logger.warning(f"Analysis of {jobs[digest]} failed: {e}")
+                    yield digest, None
+
+    @staticmethod
+    def _analyze(path: str, digest: str) -> Optional[Dict[str, Any]]:
+        try:
+            return analyze_file(path, digest)
+        except Exception as e:
+            logger.warning(f"Analysis of {path} failed: {e}")
+            return None
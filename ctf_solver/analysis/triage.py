@@ -0,0 +1,193 @@
+"""
+Static triage of one challenge file
+
+analyze_file() produces a JSON-serialisable artifact: format/header info,
+protections, imports/exports, strings with offsets, per-section entropy and the
+disassembly of the entry point and named functions. Artifacts only depend on the
+file's bytes (plus ANALYSIS_VERSION), so they are stored by SHA-256.
+"""
+import hashlib
+import math
+import os
+import re
+import shutil
+import subprocess
+from collections import Counter
+from typing import Any, Dict, List, Optional
+
+from ctf_solver.analysis.binfmt import ArFile, FormatError, detect_format, mapped, parse_binary
+
+# Bump whenever the artifact layout or content changes; old artifacts are ignored
+ANALYSIS_VERSION = 2
+
+MIN_STRING_LEN = 6
+MAX_STRINGS = 300
+_PRINTABLE = re.compile(rb'[\x20-\x7e]{%d,}' % MIN_STRING_LEN)
+# Strings worth surfacing first: flag-ish, paths, format strings, secrets, messages
+_INTERESTING = re.compile(
+    rb'flag|ctf\{|\{.*\}|passw|secret|admin|/bin/|%[0-9$]*[sxnpd]|correct|wrong|'
+    rb'denied|granted|usage|\.txt|http',
+    re.IGNORECASE)
+
+# Function names that are almost always challenge logic rather than libc/CRT glue
+_CRT_PREFIXES = ('_', 'frame_dummy', 'register_tm_clones', 'deregister_tm_clones')
+MAX_FUNCTIONS = 12
+MAX_DISASM_LINES = 80
+
+_ENTROPY_SAMPLE = 1 << 20
+
+
+def sha256_file(path: str) -> str:
+    h = hashlib.sha256()
+    with open(path, 'rb') as f:
+        for chunk in iter(lambda: f.read(1 << 20), b''):
+            h.update(chunk)
+    return h.hexdigest()
+
+
+def entropy(data: bytes) -> float:
+    """Shannon entropy in bits per byte; large regions are estimated from evenly spaced samples"""
+    if not data:
+        return 0.0
+    if len(data) > _ENTROPY_SAMPLE:
+        block = 16 * 1024
+        step = len(data) // (_ENTROPY_SAMPLE // block)
+        data = b''.join(data[i:i + block] for i in range(0, len(data), step))
+    counts = Counter(bytes(data))
+    total = len(data)
+    return round(-sum(c / total * math.log2(c / total) for c in counts.values()), 3)
+
+
+def extract_strings(data: bytes, limit: int = MAX_STRINGS) -> Dict[str, Any]:
+    """Printable strings with file offsets; interesting ones are kept first"""
+    interesting: List[List[Any]] = []
+    other: List[List[Any]] = []
+    total = 0
+    for m in _PRINTABLE.finditer(data):
+        total += 1
+        entry = [m.start(), m.group(0)[:200].decode('ascii')]
+        if _INTERESTING.search(m.group(0)):
+            if len(interesting) < limit:
+                interesting.append(entry)
+        elif len(other) < limit:
+            other.append(entry)
+    kept = interesting + other[:max(0, limit - len(interesting))]
+    return {'total': total, 'interesting': len(interesting), 'strings': kept}
+
+
+def _objdump(path: str, start: int, stop: int, intel: bool = True) -> List[str]:
+    cmd = ['objdump', '-d', '--no-show-raw-insn', f'--start-address={start:#x}', f'--stop-address={stop:#x}']
+    if intel:
+        cmd += ['-M', 'intel']
+    try:
+        out = subprocess.run(cmd + [path], capture_output=True, timeout=30).stdout
+    except (OSError, subprocess.TimeoutExpired):
+        return []
+    lines = [line for line in out.decode('utf-8', errors='replace').splitlines()
+             if line.startswith(' ') and ':' in line]
+    return [line.strip() for line in lines[:MAX_DISASM_LINES]]
+
+
+def _pick_functions(summary: Dict[str, Any]) -> List[Dict[str, Any]]:
+    functions = [f for f in summary.get('functions', []) if f['size']]
+    named = [f for f in functions if f['name'] == 'main']
+    named += [f for f in functions if f['name'] != 'main' and not f['name'].startswith(_CRT_PREFIXES)
+              and '@' not in f['name']]
+    return named[:MAX_FUNCTIONS]
+
+
+def disassemble(path: str, summary: Dict[str, Any]) -> Dict[str, List[str]]:
+    """Entry point plus named functions, using the host objdump when it is installed"""
+    if not shutil.which('objdump') or summary.get('arch') not in ('x86_64', 'i386', 'aarch64', 'arm'):
+        return {}
+    intel = summary['arch'] in ('x86_64', 'i386')
+    listings = {}
+    entry = summary.get('entry')
+    if entry:
+        listings['_entry'] = _objdump(path, entry, entry + 0x80, intel)
+    for function in _pick_functions(summary):
+        listings[function['name']] = _objdump(path, function['addr'], function['addr'] + function['size'], intel)
+    return {name: lines for name, lines in listings.items() if lines}
+
+
+def analyze_file(path: str, sha256: Optional[str] = None) -> Dict[str, Any]:
+    """Full triage artifact for one file (runs in a worker process at sync time)"""
+    with mapped(path) as data:
+        artifact: Dict[str, Any] = {
+            'version': ANALYSIS_VERSION,
+            'sha256': sha256 or sha256_file(path),
+            'name': os.path.basename(path),
+            'size': len(data),
+            'format': detect_format(data) or 'data',
+        }
+        try:
+            binary = parse_binary(data)
+            if isinstance(binary, ArFile):
+                artifact['archive'] = binary.summary()
+            elif binary is not None:
+                summary = binary.summary()
+                for section in summary['sections']:
+                    section['entropy'] = entropy(data[section['offset']:section['offset'] + section['size']])
+                artifact['binary'] = summary
+                artifact['disassembly'] = disassemble(path, summary)
+        except FormatError as e:
+            artifact['parse_error'] = str(e)
+        artifact['entropy'] = entropy(data)
+        artifact['strings'] = extract_strings(data)
+    return artifact
+
+
+def _fmt_protections(protections: Dict[str, Any]) -> str:
+    parts = []
+    for key, value in protections.items():
+        if isinstance(value, bool):
+            parts.append(f"{key}={'yes' if value else 'no'}")
+        else:
+            parts.append(f"{key}={value}")
+    return ', '.join(parts)
+
+
+def render_summary(artifacts: List[Dict[str, Any]], max_chars: int = 6000) -> str:
+    """Compact, prompt-sized text for the agent's initial state"""
+    blocks = []
+    for artifact in artifacts:
+        lines = [f"== {artifact['name']} ({artifact['size']:,} bytes, {artifact['format']}, sha256 {artifact['sha256'][:12]})"]
+        binary = artifact.get('binary')
+        if binary:
+            kind = f"{binary['format'].upper()} {binary['bits']}-bit {binary['arch']} {binary['type']}"
+            if binary['format'] == 'elf':
+                kind += ', statically linked' if binary['static'] else ', dynamically linked'
+                kind += ', stripped' if binary['stripped'] else ', not stripped'
+            lines.append(f"{kind}; entry {binary['entry']:#x}")
+            lines.append(f"protections: {_fmt_protections(binary['protections'])}")
+            if binary.get('needed'):
+                lines.append(f"libraries: {', '.join(binary['needed'])}")
+            imports = binary.get('imports')
+            if isinstance(imports, dict):
+                lines.append("imports: " + '; '.join(f"{dll}: {', '.join(funcs[:15])}" for dll, funcs in imports.items()))
+            elif imports:
+                lines.append(f"imports: {', '.join(imports[:40])}")
+            named = [f['name'] for f in binary.get('functions', []) if not f['name'].startswith(_CRT_PREFIXES)]
+            if named:
+                lines.append(f"functions: {', '.join(named[:30])}")
+            packed = [s['name'] for s in binary['sections'] if s.get('entropy', 0) > 7.2 and s['size'] > 512]
+            if packed:
+                lines.append(f"high-entropy sections (packed/encrypted?): {', '.join(packed)}")
+        archive = artifact.get('archive')
+        if archive:
+            lines.append(f"ar archive: {archive['members']} members, {archive['defined_functions']} defined functions")
+        strings = artifact.get('strings', {})
+        if strings.get('interesting'):
+            shown = [f"{off:#x}:{text!r}" for off, text in strings['strings'][:min(strings['interesting'], 15)]]
+            lines.append(f"interesting strings ({strings['interesting']} of {strings['total']}): {' '.join(shown)}")
+        for name in ('main', '_entry'):
+            listing = artifact.get('disassembly', {}).get(name)
+            if listing:
+                lines.append(f"disassembly of {name} (first {min(len(listing), 25)} lines):")
+                lines.extend('  ' + line for line in listing[:25])
+                break
+        blocks.append('\n'.join(lines))
+    text = '\n'.join(blocks)
+    if len(text) > max_chars:
+        text = text[:max_chars] + '\n[... analysis summary truncated ...]'
+    return text
@@ -0,0 +1,312 @@
+"""
+Scanner for flags hidden behind trivial byte encodings
+
+Looks for the challenge's flag prefix under every single-byte XOR key, short
+repeating XOR keys, single-byte ADD/SUB and ROT-n. Rather than trying keys one
+by one, the XOR and ADD searches use key-invariant transforms: with a repeating
+key of length L, data[j] ^ data[j+L] equals prefix[i] ^ prefix[i+L] wherever
+the encoded prefix starts, whatever the key (and likewise for byte differences
+under ADD). Each transform is one whole-buffer operation on a Python integer
+(SWAR: all bytes of the chunk processed as lanes of one wide register), followed
+by a bytes.find, so the cost is a handful of linear passes per file instead of
+hundreds. Candidates are decoded and kept only if they match the full flag format.
+"""
+import logging
+import os
+import re
+from typing import Any, Dict, Iterator, List, Optional
+
+from ctf_solver.analysis.binfmt import mapped
+
+
+logger = logging.getLogger(__name__)
+
+MAX_KEY_LEN = 8
+MAX_FLAG_LEN = 128
+# Repeating-key matches need this many key-invariant bytes to be worth validating
+MIN_INVARIANT = 3
+CHUNK = 8 * 1024 * 1024
+MAX_FINDINGS = 20
+_FALLBACK_PREFIXES = (b'flag{', b'FLAG{', b'CTF{')
+_REGEX_META = set('.^$*+?[]|()\\')
+
+
+def flag_prefix(flag_format: Optional[str]) -> Optional[bytes]:
+    """Literal leading part of a flag-format regex ('picoCTF{.*}' -> b'picoCTF{')"""
+    if not flag_format:
+        return None
+    prefix = []
+    i = 0
+    while i < len(flag_format):
+        ch = flag_format[i]
+        if ch == '\\' and i + 1 < len(flag_format) and not flag_format[i + 1].isalnum():
+            prefix.append(flag_format[i + 1])
+            i += 2
+            continue
+        if ch in _REGEX_META or (ch == '{' and i + 1 < len(flag_format) and flag_format[i + 1].isdigit()):
+            break
+        following = flag_format[i + 1:i + 3]
+        if following[:1] in ('*', '?') or (following[:1] == '{' and following[1:2].isdigit()):
+            break  # the character is quantified, so it is not a fixed part of the prefix
+        prefix.append(ch)
+        i += 1
+    try:
+        encoded = ''.join(prefix).encode('ascii')
+    except UnicodeEncodeError:
+        return None
+    return encoded if len(encoded) >= 4 else None
+
+
+def _rot(data: bytes, n: int) -> bytes:
+    out = bytearray(data)
+    for i, b in enumerate(out):
+        if 65 <= b <= 90:
+            out[i] = (b - 65 + n) % 26 + 65
+        elif 97 <= b <= 122:
+            out[i] = (b - 97 + n) % 26 + 97
+    return bytes(out)
+
+
+def _stack_blob(chunk: bytes, pos: int, max_span: int = 1024) -> Optional[bytes]:
+    """Reassemble an x86-64 "stack string" whose first 8 bytes are the immediate at pos.
+
+    Compilers initialise local char arrays with movabs reg, imm64 followed by stores
+    to [rbp/rsp+disp] (plus mov [mem], imm32/16/8 for the tail), so the bytes are
+    interleaved with opcodes and stores may overlap. The straight-line store sequence
+    is replayed into a small memory map and the contiguous bytes starting where the
+    first immediate lands are returned.
+    """
+    start = pos - 2
+    if start < 0 or chunk[start] not in (0x48, 0x49) or not 0xb8 <= chunk[start + 1] <= 0xbf:
+        return None
+    regs: Dict[int, bytes] = {}
+    memory: Dict[int, int] = {}
+    first_imm: Optional[bytes] = None
+    first_store: Optional[int] = None
+    frame = None
+    i = start
+    end = min(len(chunk), start + max_span)
+    while i < end:
+        rex = 0
+        operand = 4
+        if chunk[i] == 0x66:
+            operand = 2
+            i += 1
+        if i < end and 0x40 <= chunk[i] <= 0x4f:
+            rex = chunk[i]
+            i += 1
+        if i >= end:
+            break
+        op = chunk[i]
+        if rex & 8 and 0xb8 <= op <= 0xbf:
+            imm = bytes(chunk[i + 1:i + 9])
+            regs[((rex & 1) << 3) | (op - 0xb8)] = imm
+            if first_imm is None:
+                first_imm = imm
+            i += 9
+            continue
+        if op not in (0x89, 0xc7, 0xc6) or i + 1 >= end:
+            break
+        modrm = chunk[i + 1]
+        mod, reg, rm = modrm >> 6, (modrm >> 3) & 7, modrm & 7
+        j = i + 2
+        if rm == 4:
+            if j >= end or chunk[j] != 0x24:
+                break  # only [rsp+disp] is understood among SIB forms
+            j += 1
+        if mod == 1:
+            disp = int.from_bytes(chunk[j:j + 1], 'little', signed=True)
+            j += 1
+        elif mod == 2:
+            disp = int.from_bytes(chunk[j:j + 4], 'little', signed=True)
+            j += 4
+        else:
+            break
+        base = (rm, bool(rex & 1))
+        if op == 0x89:
+            if not rex & 8:
+                break
+            value = regs.get(((rex >> 2) & 1) << 3 | reg)
+            if value is None:
+                break
+            i = j
+        else:
+            size = 1 if op == 0xc6 else operand
+            value = bytes(chunk[j:j + size])
+            if op == 0xc7 and rex & 8:
+                value = int.from_bytes(value, 'little', signed=True).to_bytes(8, 'little', signed=True)
+            i = j + size
+        if first_store is None and value == first_imm:
+            first_store = disp
+            frame = base
+        if first_store is None or base != frame:
+            break
+        for k, b in enumerate(value):
+            memory[disp + k] = b
+    if first_store is None:
+        return None
+    blob = bytearray()
+    addr = first_store
+    while addr in memory:
+        blob.append(memory[addr])
+        addr += 1
+    return bytes(blob) if len(blob) > 8 else None
+
+
+def _find_all(haystack: bytes, needle: bytes, limit: int) -> Iterator[int]:
+    pos = haystack.find(needle)
+    while pos >= 0 and pos < limit:
+        yield pos
+        pos = haystack.find(needle, pos + 1)
+
+
+class XorScanner:
+    def __init__(self, flag_format: Optional[str] = None, max_key_len: int = MAX_KEY_LEN):
+        prefix = flag_prefix(flag_format)
+        self.prefixes = [prefix] if prefix else list(_FALLBACK_PREFIXES)
+        self.flag_re = None
+        if flag_format:
+            try:
+                self.flag_re = re.compile(flag_format)
+            except re.error:
+                pass
+        self.max_key_len = max_key_len
+
+    # ===== Validation =====
+
+    def _accept(self, decoded: bytes, prefix: bytes) -> Optional[str]:
+        try:
+            text = decoded.decode('ascii')
+        except UnicodeDecodeError:
+            # Keep the printable run that starts with the prefix
+            end = next((i for i, b in enumerate(decoded) if not 0x20 <= b < 0x7f), len(decoded))
+            text = decoded[:end].decode('ascii', errors='replace')
+        if self.flag_re is not None:
+            m = self.flag_re.match(text)
+            if m and m.group(0).isprintable():
+                # Non-greedy view: stop at the first closing brace for {.*} style formats
+                flag = m.group(0)
+                if '}' in flag:
+                    flag = flag[:flag.index('}') + 1]
+                return flag
+            return None
+        close = text.find('}')
+        if close > len(prefix) and text[:close + 1].isprintable():
+            return text[:close + 1]
+        return None
+
+    @staticmethod
+    def _windows(chunk: bytes, pos: int) -> Iterator[tuple]:
+        """Bytes that may hold the encoded flag starting at pos: in place, then as a stack string"""
+        yield chunk[pos:pos + MAX_FLAG_LEN], False
+        blob = _stack_blob(chunk, pos)
+        if blob:
+            yield blob[:MAX_FLAG_LEN], True
+
+    # ===== Transforms =====
+
+    def _scan_xor(self, chunk: bytes, value: int, prefix: bytes, limit: int) -> Iterator[Dict[str, Any]]:
+        n = len(chunk)
+        for key_len in range(1, self.max_key_len + 1):
+            invariant = bytes(prefix[i] ^ prefix[i + key_len] for i in range(len(prefix) - key_len))
+            if len(invariant) < MIN_INVARIANT:
+                break
+            mixed = (value ^ (value >> (8 * key_len))).to_bytes(n, 'little')
+            for pos in _find_all(mixed, invariant, limit):
+                key = bytes(chunk[pos + i] ^ prefix[i] for i in range(key_len))
+                if key_len > 1 and any(key[:d] * (key_len // d) == key for d in range(1, key_len) if key_len % d == 0):
+                    continue  # periodic key (incl. single-byte), reported at its shorter length
+                for window, stacked in self._windows(chunk, pos):
+                    if not any(key) and not stacked:
+                        continue  # plain text in place is what `strings` is for
+                    decoded = bytes(b ^ key[i % key_len] for i, b in enumerate(window))
+                    flag = self._accept(decoded, prefix)
+                    if flag:
+                        yield self._finding(pos, 'xor' if any(key) else 'none', key.hex(), flag, stacked)
+                        break
+
+    def _scan_add(self, chunk: bytes, value: int, prefix: bytes, limit: int) -> Iterator[Dict[str, Any]]:
+        """stored = plain + k (mod 256); SUB k is ADD 256-k"""
+        n = len(chunk)
+        if n < 2:
+            return
+        mask = (1 << (8 * n)) - 1
+        high = int.from_bytes(b'\x80' * n, 'little')
+        low = mask ^ high
+        nxt = value >> 8
+        # Per-byte (next - current) mod 256 without borrows crossing lanes
+        diff = (((nxt | high) - (value & low)) ^ ((nxt ^ (value ^ mask)) & high)) & mask
+        deltas = diff.to_bytes(n, 'little')
+        invariant = bytes((prefix[i + 1] - prefix[i]) & 0xff for i in range(len(prefix) - 1))
+        for pos in _find_all(deltas, invariant, limit):
+            k = (chunk[pos] - prefix[0]) & 0xff
+            if not k:
+                continue  # plain text; covered by the XOR pass
+            for window, stacked in self._windows(chunk, pos):
+                flag = self._accept(bytes((b - k) & 0xff for b in window), prefix)
+                if flag:
+                    yield self._finding(pos, 'add', f'{k:#04x}', flag, stacked)
+                    break
+
+    def _scan_rot(self, chunk: bytes, prefix: bytes, limit: int) -> Iterator[Dict[str, Any]]:
+        if not any(chr(b).isalpha() for b in prefix):
+            return
+        for n in range(1, 26):
+            for pos in _find_all(chunk, _rot(prefix, n), limit):
+                for window, stacked in self._windows(chunk, pos):
+                    flag = self._accept(_rot(window, 26 - n), prefix)
+                    if flag:
+                        yield self._finding(pos, 'rot', str(n), flag, stacked)
+                        break
+
+    @staticmethod
+    def _finding(offset: int, encoding: str, key: str, flag: str, stacked: bool) -> Dict[str, Any]:
+        finding = {'offset': offset, 'encoding': encoding, 'key': key, 'flag': flag}
+        if stacked:
+            finding['stack_string'] = True
+        return finding
+
+    # ===== Entry points =====
+
+    def scan_bytes(self, data: bytes, base: int = 0) -> List[Dict[str, Any]]:
+        findings: List[Dict[str, Any]] = []
+        seen = set()
+        # Chunks overlap so an encoded flag straddling a boundary is seen whole in one of them
+        step = CHUNK
+        for start in range(0, max(len(data), 1), step):
+            chunk = bytes(data[start:start + step + MAX_FLAG_LEN])
+            limit = min(step, len(chunk))
+            value = int.from_bytes(chunk, 'little')
+            for prefix in self.prefixes:
+                for finding in (*self._scan_xor(chunk, value, prefix, limit),
+                                *self._scan_add(chunk, value, prefix, limit),
+                                *self._scan_rot(chunk, prefix, limit)):
+                    finding['offset'] += base + start
+                    marker = (finding['offset'], finding['flag'])
+                    if marker not in seen:
+                        seen.add(marker)
+                        findings.append(finding)
+                    if len(findings) >= MAX_FINDINGS:
+                        return findings
+        return findings
+
+    def scan_file(self, path: str) -> List[Dict[str, Any]]:
+        with mapped(path) as data:
+            findings = self.scan_bytes(data)
+        for finding in findings:
+            finding['file'] = os.path.basename(path)
+        return findings
+
+    def scan_directory(self, directory: str) -> List[Dict[str, Any]]:
+        findings: List[Dict[str, Any]] = []
+        try:
+            entries = sorted(os.scandir(directory), key=lambda e: e.name)
+        except OSError:
+            return findings
+        for entry in entries:
+            try:
+                if entry.is_file():
+                    findings.extend(self.scan_file(entry.path))
+            except OSError as e:
+                logger.debug(f"Encoded-flag scan skipped {entry.path}: {e}")
+        return findings
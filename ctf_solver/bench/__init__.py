@@ -0,0 +1 @@
+"""Micro-benchmarks for flaggy subsystems (run via `flaggy bench ...`)"""
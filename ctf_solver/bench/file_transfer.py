@@ -0,0 +1,63 @@
+"""
+Throughput of container file transfer: archive API (put_file/get_file) vs exec + cat
+"""
+import hashlib
+import os
+import time
+from typing import Any, Dict, List
+
+from ctf_solver.containers.exegol import ExegolContainer
+
+
+def _mb_per_s(size: int, seconds: float) -> float:
+    return round(size / (1024 * 1024) / seconds, 1) if seconds > 0 else float('inf')
+
+
+def run_file_transfer_bench(sizes_mb: List[int], repeat: int = 3, legacy: bool = True) -> List[Dict[str, Any]]:
+    """Write and read back random files of each size inside a throwaway container"""
+    container = ExegolContainer(f"flaggy_bench_{int(time.time())}")
+    if not container.start():
+        raise RuntimeError("Failed to start benchmark container")
+    rows: List[Dict[str, Any]] = []
+    try:
+        for size_mb in sizes_mb:
+            size = size_mb * 1024 * 1024
+            data = os.urandom(size)
+            digest = hashlib.sha256(data).hexdigest()
+            path = f'/tmp/flaggy_bench_{size_mb}mb.bin'
+            row: Dict[str, Any] = {'size_mb': size_mb}
+
+            timings = []
+            for _ in range(repeat):
+                start = time.perf_counter()
+                container.put_file(path, data)
+                timings.append(time.perf_counter() - start)
+            row['put_mb_s'] = _mb_per_s(size, min(timings))
+
+            timings = []
+            for _ in range(repeat):
+                start = time.perf_counter()
+                read_back, _ = container.get_file(path)
+                timings.append(time.perf_counter() - start)
+            row['get_mb_s'] = _mb_per_s(size, min(timings))
+            row['intact'] = hashlib.sha256(read_back).hexdigest() == digest
+
+            start = time.perf_counter()
+            head, _ = container.get_file(path, offset=size // 2, length=4096)
+            row['range_4k_ms'] = round((time.perf_counter() - start) * 1000, 1)
+            row['range_intact'] = head == data[size // 2:size // 2 + 4096]
+
+            if legacy:
+                # Previous read path: exec `cat` and collect the whole output
+                timings = []
+                for _ in range(repeat):
+                    start = time.perf_counter()
+                    result = container._container_obj.exec_run(['cat', path], stdout=True, stderr=False)
+                    timings.append(time.perf_counter() - start)
+                row['legacy_cat_mb_s'] = _mb_per_s(size, min(timings))
+                row['legacy_intact'] = hashlib.sha256(result.output or b'').hexdigest() == digest
+            container._container_obj.exec_run(['rm', '-f', path])
+            rows.append(row)
+    finally:
+        container.stop()
+    return rows
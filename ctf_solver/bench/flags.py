@@ -0,0 +1,88 @@
+"""
+Throughput of flag detection on large command outputs: compiled FlagMatcher vs the per-step regexes
+"""
+import base64
+import random
+import re
+import string
+import time
+import urllib.parse
+from typing import Any, Callable, Dict, List, Optional
+
+from ctf_solver.analysis.flags import FlagMatcher
+
+FLAG = 'picoCTF{b3nchm4rk_fl4g_0123456789}'
+ENCODINGS: Dict[str, Callable[[str], str]] = {
+    'none': lambda flag: '',
+    'plain': lambda flag: flag,
+    'base64': lambda flag: base64.b64encode(f'secret={flag}'.encode()).decode(),
+    'hex': lambda flag: flag.encode().hex(),
+    'reversed': lambda flag: flag[::-1],
+    'url': lambda flag: urllib.parse.quote(flag, safe=''),
+}
+STREAM_CHUNK = 64 * 1024
+
+
+def _legacy_find(flag_format: str, text: str) -> Optional[str]:
+    """The runner's previous per-step search (minus its flag_format query): format, then three indicators"""
+    matches = re.findall(flag_format, text, re.IGNORECASE | re.MULTILINE)
+    if matches:
+        return matches[0].strip()
+    for pattern in (r'Flag:\s*([^\s\n]+)', r'flag:\s*([^\s\n]+)', r'FLAG:\s*([^\s\n]+)'):
+        matches = re.findall(pattern, text, re.IGNORECASE | re.MULTILINE)
+        if matches and re.match(flag_format, matches[0].strip(), re.IGNORECASE):
+            return matches[0].strip()
+    return None
+
+
+def _output(size: int, payload: str, rng: random.Random) -> str:
+    """strings/objdump-like lines with the payload in the middle"""
+    words = [''.join(rng.choice(string.ascii_letters + string.digits + '_.') for _ in range(rng.randint(3, 14)))
+             for _ in range(2000)]
+    lines = []
+    total = 0
+    while total < size:
+        line = f"{rng.randrange(1 << 32):08x}: " + ' '.join(rng.choice(words) for _ in range(rng.randint(2, 9)))
+        lines.append(line)
+        total += len(line) + 1
+    if payload:
+        lines.insert(len(lines) // 2, f"result: {payload}")
+    return '\n'.join(lines) + '\n'
+
+
+def _best(fn: Callable[[], Any], repeat: int):
+    timings, value = [], None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        value = fn()
+        timings.append(time.perf_counter() - start)
+    return min(timings), value
+
+
+def run_flag_bench(sizes_mb: List[int], flag_format: str = r'picoCTF\{.*\}', repeat: int = 3) -> List[Dict[str, Any]]:
+    """Time each detector on generated outputs of each size, for every way of hiding the flag"""
+    matcher = FlagMatcher.for_format(flag_format)
+    rng = random.Random(0)
+    rows: List[Dict[str, Any]] = []
+    for size_mb in sizes_mb:
+        for encoding, encode in ENCODINGS.items():
+            text = _output(size_mb * 1024 * 1024, encode(FLAG), rng)
+            data = text.encode()
+            mb = len(data) / 1e6
+
+            def stream():
+                s = matcher.stream()
+                for i in range(0, len(data), STREAM_CHUNK):
+                    s.feed(data[i:i + STREAM_CHUNK])
+                return [flag for flag, _ in s.results()]
+
+            legacy_s, legacy_flag = _best(lambda: _legacy_find(flag_format, text), repeat)
+            matcher_s, matcher_flag = _best(lambda: matcher.find(text), repeat)
+            stream_s, stream_flags = _best(stream, repeat)
+            rows.append({
+                'size_mb': size_mb, 'encoding': encoding,
+                'legacy_mb_s': round(mb / legacy_s, 1), 'legacy_found': legacy_flag == FLAG,
+                'matcher_mb_s': round(mb / matcher_s, 1), 'matcher_found': matcher_flag == FLAG,
+                'stream_mb_s': round(mb / stream_s, 1), 'stream_found': FLAG in stream_flags,
+            })
+    return rows
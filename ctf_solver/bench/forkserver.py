@@ -0,0 +1,43 @@
+"""
+Executions per second of the fork server versus one exec per run on the pwn challenges
+"""
+import os
+import time
+from typing import Any, Dict, List, Optional
+
+from ctf_solver.containers.forkserver_engine import ForkServer
+
+# challenge binary -> one representative stdin (each run must terminate on its own)
+TARGETS = {
+    'buffer_overflow_basic/vuln': b'A' * 64 + b'\n',
+    'format_string_basic/vuln': b'%p.%p.%p.%p\n',
+    'babyheap_0ctf2017/babyheap': b'1\n32\n4\n0\n5\n',
+}
+
+
+def _rate(fs: ForkServer, data: bytes, runs: int) -> Dict[str, Any]:
+    start = time.perf_counter()
+    for _ in range(runs):
+        last = fs.run(data)
+    elapsed = time.perf_counter() - start
+    return {'mode': fs.mode, 'runs': runs, 'execs_per_sec': round(runs / elapsed, 1),
+            'exit_code': last['exit_code'], 'signal': last['signal']}
+
+
+def run_forkserver_bench(root: str, runs: int = 2000, exec_runs: Optional[int] = 200) -> List[Dict[str, Any]]:
+    """Time `runs` fork-server executions per target, and `exec_runs` plain execs as the baseline"""
+    rows: List[Dict[str, Any]] = []
+    for target, data in TARGETS.items():
+        binary = os.path.abspath(os.path.join(root, target))
+        if not os.path.exists(binary):
+            rows.append({'target': target, 'status': 'missing'})
+            continue
+        row: Dict[str, Any] = {'target': target}
+        with ForkServer([binary], cwd=os.path.dirname(binary)) as fs:
+            row['forkserver'] = _rate(fs, data, runs)
+        if exec_runs:
+            with ForkServer([binary], cwd=os.path.dirname(binary), mode='exec') as fs:
+                row['exec'] = _rate(fs, data, exec_runs)
+            row['speedup'] = round(row['forkserver']['execs_per_sec'] / row['exec']['execs_per_sec'], 1)
+        rows.append(row)
+    return rows
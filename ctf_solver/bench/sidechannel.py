@@ -0,0 +1,30 @@
+"""
+End-to-end timing of the instruction-count side-channel solver on the password-check challenges
+"""
+import os
+from typing import Any, Dict, List, Optional
+
+from ctf_solver.containers.sidechannel_engine import CounterUnavailable, Solver, make_counter
+
+TARGETS = ('reverse_basic', 'reverse_intermediate', 'reverse_advanced')
+
+
+def run_sidechannel_bench(root: str, counter: str = 'auto', workers: Optional[int] = None,
+                          time_limit: float = 600, targets=TARGETS) -> List[Dict[str, Any]]:
+    """Solve each target's password from scratch and report the counter, runs and wall time"""
+    rows: List[Dict[str, Any]] = []
+    for name in targets:
+        binary = os.path.abspath(os.path.join(root, name, 'challenge'))
+        if not os.path.exists(binary):
+            rows.append({'challenge': name, 'status': 'missing'})
+            continue
+        try:
+            solver = Solver(make_counter(counter, [binary], 'stdin', timeout=60), workers=workers,
+                            time_limit=time_limit, log=lambda line: None)
+            result = solver.solve()
+        except CounterUnavailable as e:
+            rows.append({'challenge': name, 'status': 'no_counter', 'error': str(e)})
+            continue
+        rows.append({'challenge': name, **{k: v for k, v in result.items() if k not in ('trace', 'output')},
+                     'positions': len(result['trace'])})
+    return rows
@@ -0,0 +1,121 @@
+"""
+Step persistence throughput from concurrent attempts: background COPY writer vs a commit per step
+"""
+import json
+import os
+import threading
+import time
+from typing import Any, Callable, Dict, List
+
+from ctf_solver.config import STEP_WRITER_BATCH, STEP_WRITER_INTERVAL_MS
+from ctf_solver.database.db import get_db_connection
+from ctf_solver.database.writer import StepWriter
+
+
+def _create_attempts(count: int) -> List[int]:
+    conn = get_db_connection()
+    try:
+        with conn.cursor() as cursor:
+            ids = []
+            for _ in range(count):
+                cursor.execute("INSERT INTO attempts (status, started_at) VALUES ('running', NOW()) RETURNING id")
+                ids.append(cursor.fetchone()[0])
+        conn.commit()
+        return ids
+    finally:
+        conn.close()
+
+
+def _delete_attempts(ids: List[int]) -> int:
+    conn = get_db_connection()
+    try:
+        with conn.cursor() as cursor:
+            cursor.execute("SELECT count(*) FROM steps WHERE attempt_id = ANY(%s)", (ids,))
+            stored = cursor.fetchone()[0]
+            cursor.execute("DELETE FROM steps WHERE attempt_id = ANY(%s)", (ids,))
+            cursor.execute("DELETE FROM attempts WHERE id = ANY(%s)", (ids,))
+        conn.commit()
+        return stored
+    finally:
+        conn.close()
+
+
+def _run_attempts(ids: List[int], steps: int, output: bytes,
+                  log_step: Callable[[Any, int, int, str, bytes], None], setup=None) -> List[float]:
+    """One thread per attempt logging its steps back to back; returns per-step latencies in seconds"""
+    latencies: List[float] = []
+    lock = threading.Lock()
+
+    def attempt(attempt_id: int):
+        handle = setup() if setup else None
+        mine = []
+        try:
+            for step_num in range(steps):
+                action = json.dumps({'tool': 'bash', 'cmd': f'echo step {step_num}'})
+                start = time.perf_counter()
+                log_step(handle, attempt_id, step_num, action, output)
+                mine.append(time.perf_counter() - start)
+        finally:
+            if handle is not None:
+                handle.close()
+        with lock:
+            latencies.extend(mine)
+
+    threads = [threading.Thread(target=attempt, args=(attempt_id,)) for attempt_id in ids]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return latencies
+
+
+def _legacy_log_step(conn, attempt_id: int, step_num: int, action: str, output: bytes) -> None:
+    """The runner's previous _log_step: INSERT, UPDATE total_steps and commit"""
+    with conn.cursor() as cursor:
+        cursor.execute("""
+            INSERT INTO steps (attempt_id, step_num, action, output, exit_code, tool, execution_time_ms)
+            VALUES (%s, %s, %s, %s, %s, %s, %s)
+        """, (attempt_id, step_num, action, output, 0, 'bash', 5))
+        cursor.execute("UPDATE attempts SET total_steps = %s WHERE id = %s", (step_num + 1, attempt_id))
+    conn.commit()
+
+
+def _row(mode: str, ids: List[int], steps: int, elapsed: float, latencies: List[float]) -> Dict[str, Any]:
+    latencies.sort()
+    total = len(ids) * steps
+    return {
+        'mode': mode, 'attempts': len(ids), 'steps': total,
+        'steps_per_s': round(total / elapsed, 1) if elapsed > 0 else None,
+        'step_latency_ms_p50': round(latencies[len(latencies) // 2] * 1000, 3),
+        'step_latency_ms_p99': round(latencies[int(len(latencies) * 0.99)] * 1000, 3),
+        'stored': _delete_attempts(ids),
+    }
+
+
+def run_step_writer_bench(attempts: int = 16, steps: int = 50, output_kb: int = 4,
+                          batch_size: int = STEP_WRITER_BATCH,
+                          interval_ms: int = STEP_WRITER_INTERVAL_MS) -> List[Dict[str, Any]]:
+    """Persist attempts x steps rows both ways against CTF_DSN; elapsed time includes the final flush"""
+    output = os.urandom(output_kb * 512).hex().encode()  # printable, like command output
+    rows: List[Dict[str, Any]] = []
+
+    ids = _create_attempts(attempts)
+    start = time.perf_counter()
+    latencies = _run_attempts(ids, steps, output, _legacy_log_step, setup=get_db_connection)
+    rows.append(_row('commit_per_step', ids, steps, time.perf_counter() - start, latencies))
+
+    ids = _create_attempts(attempts)
+    writer = StepWriter(batch_size=batch_size, interval_ms=interval_ms)
+    try:
+        start = time.perf_counter()
+        latencies = _run_attempts(ids, steps, output, lambda _, attempt_id, step_num, action, data:
+                                  writer.submit_step(attempt_id, step_num, action, data, 0, 'bash', 5))
+        writer.flush()
+        elapsed = time.perf_counter() - start
+        stats = writer.stats()
+    finally:
+        writer.close()
+    row = _row('step_writer', ids, steps, elapsed, latencies)
+    row.update(batches=stats['batches'], avg_batch=stats['avg_batch'], fallback_batches=stats['fallback_batches'])
+    rows.append(row)
+    return rows
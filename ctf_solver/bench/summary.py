@@ -0,0 +1,120 @@
+"""
+TUI list queries on a large synthetic history: trigger-maintained summary tables vs aggregating steps
+"""
+import statistics
+import time
+from pathlib import Path
+from typing import Any, Callable, Dict, List
+
+from ctf_solver.database.db import get_db_connection
+from ctf_solver.database.migrate import apply_migrations
+from ctf_solver.database.writer import STEP_COLUMNS
+from ctf_solver.ui.textual.data import repo
+
+BENCH_SCHEMA = 'flaggy_bench_summary'
+SCHEMA_SQL = Path(__file__).resolve().parents[1] / 'database' / 'schema.sql'
+LOAD_CHUNK = 1_000_000
+STEPS_PER_ATTEMPT = 50
+WRITE_BATCH = 200
+
+
+def _timed(fn: Callable[[], Any], repeat: int) -> float:
+    timings = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        timings.append(time.perf_counter() - start)
+    return statistics.median(timings) * 1000
+
+
+def _load(cursor, steps: int, challenges: int) -> Dict[str, Any]:
+    """challenges, steps / STEPS_PER_ATTEMPT attempts over them, and their steps, oldest first"""
+    attempts = max(1, steps // STEPS_PER_ATTEMPT)
+    cursor.execute("""
+        INSERT INTO challenges (name, binary_path, category)
+        SELECT 'bench_' || i, '/dev/null', 'pwn' FROM generate_series(1, %s) i
+    """, (challenges,))
+    cursor.execute("SELECT min(id) FROM challenges")
+    first_challenge = cursor.fetchone()[0]
+    cursor.execute("""
+        INSERT INTO attempts (challenge_id, status, total_steps, started_at)
+        SELECT %s + i %% %s, CASE WHEN i %% 7 = 0 THEN 'completed' ELSE 'failed' END, %s,
+               NOW() - make_interval(secs => (%s - i) * 60)
+        FROM generate_series(1, %s) i
+    """, (first_challenge, challenges, STEPS_PER_ATTEMPT, attempts, attempts))
+    cursor.execute("SELECT min(id) FROM attempts")
+    first_attempt = cursor.fetchone()[0]
+    start = time.perf_counter()
+    for offset in range(0, steps, LOAD_CHUNK):
+        cursor.execute("""
+            INSERT INTO steps (attempt_id, step_num, action, output, exit_code, tool, created_at)
+            SELECT %s + i / %s, i %% %s, jsonb_build_object('tool', 'bash', 'cmd', 'ls -la /tmp/' || i),
+                   convert_to(repeat('output line ' || i || E'\\n', 8), 'UTF8'), 0, 'bash',
+                   NOW() - make_interval(secs => (%s - i) * 1.2)
+            FROM generate_series(%s, %s) i
+        """, (first_attempt, STEPS_PER_ATTEMPT, STEPS_PER_ATTEMPT, steps, offset, min(offset + LOAD_CHUNK, steps) - 1))
+    load_s = time.perf_counter() - start
+    cursor.execute("ANALYZE")
+    return {'attempts': attempts, 'load_steps_per_s': round(steps / load_s), 'first_challenge': first_challenge,
+            'first_attempt': first_attempt}
+
+
+def _write_batches(conn, cursor, attempt_id: int, batches: int) -> float:
+    """ms per COPY of WRITE_BATCH step rows (the step writer's flush) into one attempt"""
+    action = '{"tool": "bash", "cmd": "id"}'
+    start = time.perf_counter()
+    for batch in range(batches):
+        with conn.transaction():
+            with cursor.copy(f"COPY steps ({', '.join(STEP_COLUMNS)}) FROM STDIN") as copy:
+                for i in range(WRITE_BATCH):
+                    copy.write_row((attempt_id, 1_000_000 + batch * WRITE_BATCH + i, action, b'uid=0(root)', 0, 'bash', 1))
+    return (time.perf_counter() - start) * 1000 / batches
+
+
+def run_summary_bench(steps: int = 10_000_000, challenges: int = 200, repeat: int = 5,
+                      keep: bool = False) -> List[Dict[str, Any]]:
+    """Load a synthetic history into a scratch schema and time each list query both ways"""
+    conn = get_db_connection()
+    conn.autocommit = True
+    cursor = conn.cursor()
+    rows: List[Dict[str, Any]] = []
+    try:
+        cursor.execute(f"DROP SCHEMA IF EXISTS {BENCH_SCHEMA} CASCADE")
+        cursor.execute(f"CREATE SCHEMA {BENCH_SCHEMA}")
+        cursor.execute(f"SET search_path TO {BENCH_SCHEMA}")
+        cursor.execute(SCHEMA_SQL.read_text())
+        apply_migrations(conn)
+        loaded = _load(cursor, steps, challenges)
+        rows.append({'query': 'load', 'steps': steps, 'attempts': loaded['attempts'], 'challenges': challenges,
+                     'load_steps_per_s': loaded['load_steps_per_s']})
+
+        queries = [
+            ('fetch_challenges', repo.CHALLENGES_SQL, repo.CHALLENGES_SQL_LEGACY, None),
+            ('fetch_challenge_runs', repo.CHALLENGE_RUNS_SQL, repo.CHALLENGE_RUNS_SQL_LEGACY,
+             (loaded['first_challenge'],)),
+            ('fetch_jobs', repo.JOBS_SQL, repo.JOBS_SQL_LEGACY, None),
+        ]
+        for name, summary_sql, legacy_sql, params in queries:
+            def run(sql):
+                cursor.execute(sql, params)
+                return cursor.fetchall()
+
+            same = run(summary_sql) == run(legacy_sql)
+            legacy_ms = _timed(lambda: run(legacy_sql), repeat)
+            summary_ms = _timed(lambda: run(summary_sql), repeat)
+            rows.append({'query': name, 'legacy_ms': round(legacy_ms, 2), 'summary_ms': round(summary_ms, 2),
+                         'speedup': round(legacy_ms / summary_ms, 1) if summary_ms else None, 'same_rows': same})
+
+        # Cost of the triggers on the write path
+        with_triggers = _write_batches(conn, cursor, loaded['first_attempt'], 20)
+        cursor.execute("ALTER TABLE steps DISABLE TRIGGER steps_summary_insert")
+        without = _write_batches(conn, cursor, loaded['first_attempt'] + 1, 20)
+        cursor.execute("ALTER TABLE steps ENABLE TRIGGER steps_summary_insert")
+        rows.append({'query': f'copy_{WRITE_BATCH}_steps', 'with_triggers_ms': round(with_triggers, 2),
+                     'without_triggers_ms': round(without, 2)})
+    finally:
+        if not keep:
+            cursor.execute(f"DROP SCHEMA IF EXISTS {BENCH_SCHEMA} CASCADE")
+        cursor.execute("RESET search_path")
+        conn.close()
+    return rows
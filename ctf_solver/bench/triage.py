@@ -0,0 +1,56 @@
+"""
+Latency of in-process binary triage (mmap + header parsing) over a challenge tree
+"""
+import os
+import shutil
+import subprocess
+import time
+from typing import Any, Dict, List
+
+from ctf_solver.analysis.binfmt import ArFile, detect_format, mapped, parse_binary
+from ctf_solver.analysis.facts import binary_facts
+
+
+def _best_us(fn, repeat: int) -> float:
+    timings = []
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        timings.append(time.perf_counter() - start)
+    return round(min(timings) * 1e6, 1)
+
+
+def _full_parse(path: str):
+    with mapped(path) as data:
+        return parse_binary(data).summary()
+
+
+def run_triage_bench(root: str, repeat: int = 5, legacy: bool = True) -> List[Dict[str, Any]]:
+    """Time discovered_info facts and full parses for every ELF/PE/ar file under root"""
+    rows: List[Dict[str, Any]] = []
+    file_tool = shutil.which('file') if legacy else None
+    for dirpath, _, filenames in sorted(os.walk(root)):
+        for filename in sorted(filenames):
+            path = os.path.join(dirpath, filename)
+            with mapped(path) as data:
+                kind = detect_format(data)
+            if kind is None:
+                continue
+            row: Dict[str, Any] = {'file': os.path.relpath(path, root), 'format': kind,
+                                   'size': os.path.getsize(path)}
+            if kind == 'ar':
+                summary = _full_parse(path)
+                row['members'] = summary['members']
+                row['defined_functions'] = summary['defined_functions']
+                row['full_parse_us'] = _best_us(lambda: _full_parse(path), repeat)
+                with mapped(path) as data:
+                    row['member_scan_us'] = _best_us(lambda: sum(1 for _ in ArFile(data).members()), repeat)
+            else:
+                row['facts_us'] = _best_us(lambda: binary_facts(path), repeat)
+                row['full_parse_us'] = _best_us(lambda: _full_parse(path), repeat)
+            if file_tool:
+                # What the old regex heuristics depended on: a `file` run whose output mentions the arch
+                row['legacy_file_us'] = _best_us(
+                    lambda: subprocess.run([file_tool, path], capture_output=True), repeat)
+            rows.append(row)
+    return rows
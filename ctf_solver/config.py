@@ -13,6 +13,11 @@ if env_file.exists():
                 os.environ.setdefault(key.strip(), value.strip().strip('"\''))
 
 DB_DSN = os.environ.get('CTF_DSN', 'host=localhost port=5432 dbname=ctf user=flaggy password=flaggy123 sslmode=disable')
+# Process-wide connection pool (runners hold one connection per running attempt)
+DB_POOL_MIN = int(os.environ.get('FLAGGY_DB_POOL_MIN', '1'))
+DB_POOL_MAX = int(os.environ.get('FLAGGY_DB_POOL_MAX', '20'))
+DB_POOL_TIMEOUT = float(os.environ.get('FLAGGY_DB_POOL_TIMEOUT', '30'))  # seconds to wait for a free connection
+DB_POOL_CHECK_SECONDS = float(os.environ.get('FLAGGY_DB_POOL_CHECK_SECONDS', '30'))  # ping connections idle longer
 
 # OpenRouter configuration
 OPENROUTER_API_KEY = os.environ.get('OPENROUTER_API_KEY')
@@ -26,6 +31,8 @@ CTF_MODEL = os.environ.get('CTF_MODEL', 'anthropic/claude-3.5-sonnet')
 # Output size limits to prevent context window overflow
 MAX_OUTPUT_TOKENS = int(os.environ.get('FLAGGY_MAX_OUTPUT_TOKENS', '50000'))
 MAX_OUTPUT_CHARS = MAX_OUTPUT_TOKENS * 4  # Rough estimate: 1 token ≈ 4 chars
+# Commands are stopped once they have produced this many bytes (only head + tail are kept)
+MAX_STREAM_BYTES = int(os.environ.get('FLAGGY_MAX_STREAM_BYTES', str(64 * 1024 * 1024)))
 
 # ReAct/Runner controls
 CTF_REACT_MAX_ITERS = int(os.environ.get('CTF_REACT_MAX_ITERS', '40'))
@@ -33,6 +40,56 @@ CTF_OUTER_MAX_STEPS = int(os.environ.get('CTF_OUTER_MAX_STEPS', '20'))
 # Inner ReAct segment length per outer step (hybrid CoT+ReAct)
 CTF_REACT_SEGMENT_ITERS = int(os.environ.get('CTF_REACT_SEGMENT_ITERS', '10'))
 
+# Run bash actions in one long-lived shell per attempt instead of one docker exec per command
+SHELL_SESSION_ENABLED = os.environ.get('FLAGGY_SHELL_SESSION', '1') != '0'
+
+# Warm container pool: number of idle Exegol containers kept running (0 disables pooling)
+CONTAINER_POOL_SIZE = int(os.environ.get('FLAGGY_CONTAINER_POOL_SIZE', '0'))
+# Pooled containers are destroyed and replaced after this many attempts
+CONTAINER_POOL_MAX_USES = int(os.environ.get('FLAGGY_CONTAINER_POOL_MAX_USES', '10'))
+
+# Execution backend for attempts: 'exegol' (Docker container) or 'local' (host sandbox).
+# A challenge can override it with a "backend" key in its challenge.json/metadata.json
+EXECUTION_BACKEND = os.environ.get('FLAGGY_BACKEND', 'exegol')
+# Isolation used by the local backend: auto, bwrap, unshare or none
+LOCAL_SANDBOX = os.environ.get('FLAGGY_LOCAL_SANDBOX', 'auto')
+# Extra host paths (colon-separated) bound read-only into the bwrap sandbox, e.g. tools under /root
+LOCAL_SANDBOX_BINDS = [p for p in os.environ.get('FLAGGY_LOCAL_SANDBOX_BINDS', '').split(':') if p]
+
+# Shared on-disk cache for deterministic triage commands (file, strings, readelf, ...)
+TRIAGE_CACHE_ENABLED = os.environ.get('FLAGGY_TRIAGE_CACHE', '1') != '0'
+TRIAGE_CACHE_DIR = os.environ.get('FLAGGY_CACHE_DIR', os.path.expanduser('~/.cache/flaggy/triage'))
+
+# Static-analysis bundle computed at challenge sync/import time and shown to the agent up front
+ANALYSIS_ON_SYNC = os.environ.get('FLAGGY_ANALYSIS_ON_SYNC', '1') != '0'
+ANALYSIS_DIR = os.environ.get('FLAGGY_ANALYSIS_DIR', os.path.expanduser('~/.cache/flaggy/analysis'))
+ANALYSIS_WORKERS = int(os.environ.get('FLAGGY_ANALYSIS_WORKERS', str(min(8, os.cpu_count() or 1))))
+# Name functions of stripped static binaries from the .a archives shipped with them
+SIGNATURES_ENABLED = os.environ.get('FLAGGY_SIGNATURES', '1') != '0'
+# Scan challenge files for the flag prefix under XOR/ADD/ROT encodings at attempt start
+XOR_SCAN_ENABLED = os.environ.get('FLAGGY_XOR_SCAN', '1') != '0'
+# Fuzz the main binary of pwn challenges in the background while the agent thinks
+FUZZ_ENABLED = os.environ.get('FLAGGY_FUZZ', '1') != '0'
+FUZZ_WORKERS = int(os.environ.get('FLAGGY_FUZZ_WORKERS', '0'))  # 0: the container's CPUs minus one
+# Detached jobs (start_job): wall-clock cap, address-space cap and how many may run at once
+JOB_MAX_SECONDS = int(os.environ.get('FLAGGY_JOB_MAX_SECONDS', '3600'))
+JOB_MEMORY_MB = int(os.environ.get('FLAGGY_JOB_MEMORY_MB', '4096'))
+JOB_MAX_CONCURRENT = int(os.environ.get('FLAGGY_JOB_MAX_CONCURRENT', '4'))
+# Batch steps: independent actions the agent emits together, run concurrently inside the backend
+BATCH_MAX_ACTIONS = int(os.environ.get('FLAGGY_BATCH_MAX_ACTIONS', '8'))
+BATCH_PARALLELISM = int(os.environ.get('FLAGGY_BATCH_PARALLELISM', '4'))
+# Speculatively run likely next triage commands while the LLM call is in flight
+PREFETCH_ENABLED = os.environ.get('FLAGGY_PREFETCH', '1') != '0'
+PREFETCH_MAX_COMMANDS = int(os.environ.get('FLAGGY_PREFETCH_MAX', '3'))  # new guesses per step
+# Write steps from a background thread in COPY batches instead of one commit per step
+STEP_WRITER_ENABLED = os.environ.get('FLAGGY_STEP_WRITER', '1') != '0'
+STEP_WRITER_BATCH = int(os.environ.get('FLAGGY_STEP_WRITER_BATCH', '200'))
+STEP_WRITER_INTERVAL_MS = int(os.environ.get('FLAGGY_STEP_WRITER_INTERVAL_MS', '200'))
+# Store long step output once per content, deflated with a preset dictionary (needs `flaggy db migrate`)
+OUTPUT_BLOBS_ENABLED = os.environ.get('FLAGGY_OUTPUT_BLOBS', '1') != '0'
+# Step output streamed to service subscribers is split into events of at most this many characters
+EVENT_OUTPUT_CHUNK = int(os.environ.get('FLAGGY_EVENT_OUTPUT_CHUNK', '16384'))
+
 # Exegol tools categorized for CTF challenges
 EXEGOL_TOOLS = {
     'binary_analysis': [
@@ -0,0 +1,119 @@
+"""
+Tar helpers for moving files in and out of containers via the Docker archive API
+"""
+import io
+import os
+import tarfile
+import time
+import logging
+from pathlib import Path
+from typing import Iterable, Iterator, Optional, Tuple
+
+
+logger = logging.getLogger(__name__)
+
+
+class ChunkStream(io.RawIOBase):
+    """Expose an iterator of byte chunks (e.g. from get_archive) as a readable file"""
+
+    def __init__(self, chunks: Iterable[bytes]):
+        self._chunks: Iterator[bytes] = iter(chunks)
+        self._buffer = b''
+
+    def readable(self) -> bool:
+        return True
+
+    def readinto(self, b) -> int:
+        while not self._buffer:
+            try:
+                self._buffer = next(self._chunks)
+            except StopIteration:
+                return 0
+        n = min(len(b), len(self._buffer))
+        b[:n] = self._buffer[:n]
+        self._buffer = self._buffer[n:]
+        return n
+
+
+def tar_directory(path: str) -> bytes:
+    """Pack the contents of a host directory (not the directory itself) into a tar archive"""
+    buf = io.BytesIO()
+    with tarfile.open(fileobj=buf, mode='w') as tar:
+        for entry in sorted(Path(path).iterdir()):
+            tar.add(str(entry), arcname=entry.name)
+    return buf.getvalue()
+
+
+def extract_archive(chunks: Iterable[bytes], dest: str, strip_components: int = 0) -> int:
+    """Stream-extract a tar archive into dest, refusing entries that escape it.
+
+    Returns the number of extracted members.
+    """
+    dest_root = os.path.realpath(dest)
+    extracted = 0
+    with tarfile.open(fileobj=ChunkStream(chunks), mode='r|') as tar:
+        for member in tar:
+            parts = Path(member.name).parts[strip_components:]
+            if not parts:
+                continue
+            target = os.path.realpath(os.path.join(dest_root, *parts))
+            if target != dest_root and not target.startswith(dest_root + os.sep):
+                logger.warning(f"Skipping archive entry outside destination: {member.name}")
+                continue
+            if member.islnk() or member.isdev():
+                continue
+            if member.issym():
+                link_target = os.path.realpath(os.path.join(os.path.dirname(target), member.linkname))
+                if not link_target.startswith(dest_root + os.sep):
+                    logger.warning(f"Skipping link pointing outside destination: {member.name}")
+                    continue
+            member.name = os.path.relpath(target, dest_root)
+            tar.extract(member, dest_root, set_attrs=not member.isdir())
+            extracted += 1
+    return extracted
+
+
+class ArchivedSymlink(Exception):
+    """The archived path is a symlink; linkname holds its target"""
+
+    def __init__(self, linkname: str):
+        super().__init__(linkname)
+        self.linkname = linkname
+
+
+def pack_file(name: str, data: bytes, mode: int = 0o644) -> bytes:
+    """Build a tar archive holding a single regular file"""
+    buf = io.BytesIO()
+    with tarfile.open(fileobj=buf, mode='w') as tar:
+        info = tarfile.TarInfo(name=name)
+        info.size = len(data)
+        info.mode = mode
+        info.mtime = int(time.time())
+        tar.addfile(info, io.BytesIO(data))
+    return buf.getvalue()
+
+
+def read_archived_file(chunks: Iterable[bytes], offset: int = 0,
+                       length: Optional[int] = None) -> Tuple[bytes, int]:
+    """Read a byte range of the single regular file in a streamed tar archive.
+
+    Returns (data, file size). The stream is consumed only as far as needed, so
+    reading the head of a large file does not transfer all of it.
+    """
+    with tarfile.open(fileobj=ChunkStream(chunks), mode='r|') as tar:
+        for member in tar:
+            if member.issym():
+                raise ArchivedSymlink(member.linkname)
+            if not member.isfile():
+                raise IsADirectoryError(member.name) if member.isdir() else ValueError(
+                    f"{member.name} is not a regular file")
+            f = tar.extractfile(member)
+            remaining = offset
+            while remaining > 0:
+                skipped = f.read(min(remaining, 1 << 20))
+                if not skipped:
+                    break
+                remaining -= len(skipped)
+            data = f.read() if length is None else f.read(length)
+            return data, member.size
+    raise FileNotFoundError("empty archive")
@@ -0,0 +1,24 @@
+"""
+Execution backend selection
+"""
+from typing import Dict, Optional
+
+from ctf_solver.config import EXECUTION_BACKEND
+from ctf_solver.containers.base import ExecutionBackend
+
+BACKENDS = ('exegol', 'local')
+
+
+def create_backend(container_name: str, mounts: Optional[Dict[str, str]] = None,
+                   kind: Optional[str] = None, flag_format: Optional[str] = None) -> ExecutionBackend:
+    """Build the backend for one attempt; the Exegol backend draws from the warm pool if enabled"""
+    kind = (kind or EXECUTION_BACKEND).lower()
+    if kind == 'local':
+        from ctf_solver.containers.local import LocalSandbox
+        return LocalSandbox(container_name, mounts=mounts, flag_format=flag_format)
+    if kind == 'exegol':
+        from ctf_solver.containers.exegol import ExegolContainer
+        from ctf_solver.containers.pool import get_container_pool
+        return ExegolContainer(container_name, mounts=mounts, pool=get_container_pool(),
+                               flag_format=flag_format)
+    raise ValueError(f"Unknown execution backend '{kind}' (expected one of: {', '.join(BACKENDS)})")
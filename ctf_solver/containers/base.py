@@ -0,0 +1,773 @@
+"""
+Execution backends: where an attempt's commands actually run
+
+ExecutionBackend holds everything that is independent of the isolation mechanism
+(action dispatch, the persistent shell/gdb/python sessions, file views); concrete
+backends provide process spawning, file transfer and lifecycle.
+"""
+import base64
+import binascii
+import json
+import logging
+import os
+import shlex
+from abc import ABC, abstractmethod
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Tuple
+
+from ctf_solver.config import BATCH_PARALLELISM, EXEGOL_TOOLS, MAX_OUTPUT_CHARS, SHELL_SESSION_ENABLED
+from ctf_solver.containers.cache import get_triage_cache
+from ctf_solver.containers.fuzz import BackgroundFuzzer
+from ctf_solver.containers.gdb import GdbMISession
+from ctf_solver.containers.jobs import JobManager
+from ctf_solver.containers.output import BoundedOutput
+from ctf_solver.containers.repl import PythonReplSession
+from ctf_solver.containers.session import SessionClosed, ShellSession
+
+
+logger = logging.getLogger(__name__)
+
+# Set up pyenv PATH and TERM to make all Exegol tools available seamlessly
+ENV_SETUP = 'export PATH="/root/.pyenv/versions/3.11.11/bin:$PATH" && export TERM=xterm'
+
+# In-backend half of the sidechannel tool (stdlib only), copied in on first use
+SIDECHANNEL_SOURCE = (Path(__file__).parent / 'sidechannel_engine.py').read_bytes()
+SIDECHANNEL_NAME = 'flaggy_sidechannel.py'  # staged in the backend's tmp_dir
+SIDECHANNEL_TIMEOUT = 900
+
+# Stdlib-only helpers copied into <tmp_dir>/HELPERS_SUBDIR: the fork server is importable as
+# `flaggy_forkserver` from the python tool; pwntriage and the background fuzzer run on top of it
+HELPERS_SUBDIR = 'flaggy'
+HELPERS = {
+    'flaggy_forkserver.py': (Path(__file__).parent / 'forkserver_engine.py').read_bytes(),
+    'flaggy_pwntriage.py': (Path(__file__).parent / 'pwntriage_engine.py').read_bytes(),
+    'flaggy_fuzz.py': (Path(__file__).parent / 'fuzz_engine.py').read_bytes(),
+}
+PWNTRIAGE_TIMEOUT = 300
+
+# Batch actions that touch no per-attempt session state and may run side by side
+PARALLEL_TOOLS = ('bash', 'read_file')
+
+
+def decode_content(content: str, encoding: str) -> bytes:
+    """Turn write_file content into bytes: text (UTF-8), base64 or hex"""
+    if encoding in ('text', 'utf-8', 'utf8'):
+        return content.encode('utf-8')
+    if encoding == 'base64':
+        try:
+            return base64.b64decode(''.join(content.split()), validate=True)
+        except binascii.Error as e:
+            raise ValueError(str(e))
+    if encoding == 'hex':
+        cleaned = ''.join(content.split())
+        if cleaned.lower().startswith('0x'):
+            cleaned = cleaned[2:]
+        return bytes.fromhex(cleaned.replace('\\x', ''))
+    raise ValueError(f"unknown encoding {encoding!r} (use text, base64 or hex)")
+
+
+def hexdump(data: bytes, start: int = 0) -> str:
+    """xxd-style dump: offset, 16 hex bytes, printable ASCII"""
+    lines = []
+    for i in range(0, len(data), 16):
+        chunk = data[i:i + 16]
+        hex_part = ' '.join(chunk[j:j + 2].hex() for j in range(0, len(chunk), 2))
+        text = ''.join(chr(b) if 32 <= b < 127 else '.' for b in chunk)
+        lines.append(f"{start + i:08x}: {hex_part:<39}  {text}")
+    return '\n'.join(lines) + ('\n' if lines else '')
+
+
+def render_bytes(data: bytes, encoding: Optional[str], start: int = 0) -> tuple:
+    """Render file bytes for the agent; returns (text, view used).
+
+    'auto' shows UTF-8 text as-is and anything else as a hex dump.
+    """
+    encoding = (encoding or 'auto').lower()
+    if encoding == 'base64':
+        return base64.b64encode(data).decode('ascii'), 'base64'
+    if encoding == 'hex':
+        return hexdump(data, start), 'hex'
+    if encoding == 'auto':
+        try:
+            return data.decode('utf-8'), 'text'
+        except UnicodeDecodeError as e:
+            # A multi-byte character cut off by the read range is still text
+            if e.start < len(data) - 3 or b'\x00' in data:
+                return hexdump(data, start), 'hex'
+    return data.decode('utf-8', errors='replace'), 'text'
+
+
+class ExecutionBackend(ABC):
+    """Runs agent actions for one attempt.
+
+    Subclasses implement start/stop/is_running, open_channel (a long-lived process
+    with stdin/stdout, used by the shell, gdb and python sessions), run_command
+    (short helper commands), _execute_oneshot (bash fallback when no session can be
+    used) and put_file/get_file.
+    """
+
+    def __init__(self, container_name: str, cwd: str = '/challenge', flag_format: Optional[str] = None):
+        self.container_name = container_name
+        self.cwd = cwd
+        self.flag_format = flag_format  # Used to keep flag matches from truncated output
+        self.tmp_dir = '/tmp'  # Scratch directory as commands see it; helpers are staged here
+        # Default timeout for bash commands (seconds); can be overridden per action
+        try:
+            self.default_timeout_seconds = int(os.environ.get('FLAGGY_BASH_TIMEOUT', '60'))
+        except Exception:
+            self.default_timeout_seconds = 60
+        
+        # Persistent session processes
+        self._shell_session: Optional[ShellSession] = None
+        self._shell_session_failed = False
+        self._gdb_session: Optional[GdbMISession] = None
+        self._python_session: Optional[PythonReplSession] = None
+        self._fuzzer: Optional[BackgroundFuzzer] = None
+        self._jobs: Optional[JobManager] = None
+
+    # ===== Backend primitives =====
+
+    @abstractmethod
+    def start(self) -> bool:
+        """Bring the backend up; False on failure"""
+
+    @abstractmethod
+    def stop(self) -> bool:
+        """Tear the backend down (closing any sessions)"""
+
+    @abstractmethod
+    def is_running(self) -> bool:
+        pass
+
+    @abstractmethod
+    def open_channel(self, cmd: List[str], environment: Optional[Dict[str, str]] = None,
+                     workdir: Optional[str] = None):
+        """Start a long-lived process; returns an ExecChannel-like object
+        (send, read_frame, exit_code, close, closed)"""
+
+    @abstractmethod
+    def run_command(self, cmd: List[str]) -> Tuple[int, bytes]:
+        """Run a short command to completion; returns (exit code, combined output)"""
+
+    @abstractmethod
+    def _execute_oneshot(self, cmd: str, timeout_seconds: int, track_cwd: bool = True) -> Dict[str, Any]:
+        """Run a bash command without the shell session; a `cd` in it moves self.cwd only
+        when track_cwd is set (concurrent runs leave the attempt's cwd alone)"""
+
+    @abstractmethod
+    def put_file(self, path: str, data: bytes, mode: int = 0o644) -> None:
+        """Write raw bytes to a path (relative paths are resolved against cwd)"""
+
+    @abstractmethod
+    def get_file(self, path: str, offset: int = 0, length: Optional[int] = None) -> tuple:
+        """Read raw bytes (optionally a range); returns (data, file size)"""
+
+    def hash_files(self, paths: List[str]) -> Dict[str, str]:
+        """SHA-256 of each path that is a regular file, computed where the files live"""
+        exit_code, output = self.run_command(['sha256sum', '--'] + paths)
+        digests = {}
+        for line in output.decode('utf-8', errors='replace').splitlines():
+            digest, sep, path = line.partition('  ')
+            if sep and len(digest) == 64 and path in paths:
+                digests[path] = digest
+        return digests
+
+    def list_files(self, directory: str) -> Dict[str, Tuple[int, int]]:
+        """Regular files directly in a directory as name -> (size, mtime in ns), listed where the files live"""
+        exit_code, output = self.run_command(
+            ['find', directory, '-mindepth', '1', '-maxdepth', '1', '-type', 'f', '-printf', '%s %T@ %f\\0'])
+        files = {}
+        for record in output.split(b'\0'):
+            size, _, rest = record.partition(b' ')
+            mtime, _, name = rest.partition(b' ')
+            if not name or not size.isdigit():
+                continue
+            seconds, _, fraction = mtime.decode('ascii', errors='replace').partition('.')
+            try:
+                mtime_ns = int(seconds) * 10**9 + int((fraction + '0' * 9)[:9])
+            except ValueError:
+                continue
+            files[name.decode('utf-8', errors='surrogateescape')] = (int(size), mtime_ns)
+        return files
+
+    def environment_id(self) -> str:
+        """Identifies the toolchain commands run against (part of triage cache keys)"""
+        return type(self).__name__
+
+    def workspace_path(self) -> Optional[str]:
+        """Host directory backing the workspace, if any"""
+        return None
+
+    def _close_sessions(self) -> None:
+        self._close_shell_session()
+        self._close_gdb_session()
+        self._close_python_session()
+        self.close_fuzzer()
+        if self._jobs is not None:
+            self._jobs.cleanup()
+            self._jobs = None
+
+    # ===== Actions =====
+
+    def ensure_running(self) -> bool:
+        """Ensure container is running, start if needed"""
+        if not self.is_running():
+            return self.start()
+        return True
+        
+    def execute(self, action: Dict[str, Any]) -> Dict[str, Any]:
+        """Execute an agent action in the backend.
+        Special cases: gdb and python (persistent per-attempt sessions), write_file for safe file creation,
+        sidechannel (instruction-count brute force of a password check), pwntriage (offset discovery),
+        start_job/job_status/job_output/kill_job (detached long-running commands polled across steps).
+        """
+        if not self.ensure_running():
+            return {"error": "Execution backend not running"}
+            
+        tool = action.get('tool', 'bash')
+        
+        if tool == 'gdb':
+            return self._gdb_persistent(action)
+        if tool == 'python':
+            return self._python_persistent(action)
+        if tool == 'write_file':
+            return self._write_file(action.get('filename', ''), action.get('content', ''), action.get('encoding'))
+        if tool == 'read_file':
+            return self._read_file(action.get('filename', ''), action.get('max_bytes'),
+                                   action.get('offset', 0), action.get('encoding'))
+        if tool == 'sidechannel':
+            return self._sidechannel(action)
+        if tool == 'pwntriage':
+            return self._pwntriage(action)
+        if tool in ('start_job', 'job_status', 'job_output', 'kill_job'):
+            return self._job_action(tool, action)
+
+        # Default path: run bash command in current working directory with direct Docker execution
+        cmd = action.get('cmd') or action.get('args', {}).get('cmd', '')
+        if not cmd.strip():
+            return {"stdout": "", "stderr": "", "cwd": self.cwd}
+        
+        timeout_seconds = action.get('timeout_seconds')
+        if not isinstance(timeout_seconds, int) or timeout_seconds <= 0:
+            timeout_seconds = self.default_timeout_seconds
+        return self._cached_bash(cmd, timeout_seconds, self._run_bash)
+
+    def execute_batch(self, actions: List[Dict[str, Any]], parallelism: int = BATCH_PARALLELISM) -> List[Dict[str, Any]]:
+        """Execute independent actions of one agent step; results come back in action order.
+
+        bash commands and file reads run concurrently, each bash command as its own process
+        (the shell session runs one command at a time, so a `cd` or export inside a batch does
+        not carry over). Tools with per-attempt state (gdb, python, jobs, write_file, ...) run
+        one after another on the calling thread while the pool works.
+        """
+        if not self.ensure_running():
+            return [{"error": "Execution backend not running"} for _ in actions]
+        results: List[Dict[str, Any]] = [{} for _ in actions]
+        with ThreadPoolExecutor(max_workers=max(1, parallelism)) as pool:
+            futures = {i: pool.submit(self._execute_guarded, self.execute_concurrent, action)
+                       for i, action in enumerate(actions) if action.get('tool', 'bash') in PARALLEL_TOOLS}
+            for i, action in enumerate(actions):
+                if i not in futures:
+                    results[i] = self._execute_guarded(self.execute, action)
+            for i, future in futures.items():
+                results[i] = future.result()
+        return results
+
+    def execute_concurrent(self, action: Dict[str, Any]) -> Dict[str, Any]:
+        """Execute a bash or read_file action without the shell session, so it can run next to
+        other actions (batch steps, speculative prefetch)"""
+        if action.get('tool', 'bash') != 'bash':
+            return self.execute(action)
+        cmd = action.get('cmd') or ''
+        if not cmd.strip():
+            return {"stdout": "", "stderr": "", "cwd": self.cwd, "tool": "bash"}
+        timeout_seconds = action.get('timeout_seconds')
+        if not isinstance(timeout_seconds, int) or timeout_seconds <= 0:
+            timeout_seconds = self.default_timeout_seconds
+        return self._cached_bash(cmd, timeout_seconds, self._execute_detached)
+
+    def _execute_detached(self, cmd: str, timeout_seconds: int) -> Dict[str, Any]:
+        # Runs next to other commands, so it must not race them on self.cwd
+        return self._execute_oneshot(cmd, timeout_seconds, track_cwd=False)
+
+    def _execute_guarded(self, run, action: Dict[str, Any]) -> Dict[str, Any]:
+        try:
+            return run(action)
+        except Exception as e:
+            logger.error(f"Batch action {action.get('tool', 'bash')} failed: {e}")
+            return {"error": str(e), "cwd": self.cwd, "tool": action.get('tool', 'bash')}
+
+    def _cached_bash(self, cmd: str, timeout_seconds: int, run) -> Dict[str, Any]:
+        # Deterministic triage commands on unchanged files are answered from the shared cache
+        cache = get_triage_cache()
+        cache_key = None
+        if cache is not None:
+            try:
+                cache_key = cache.key_for(self, cmd)
+            except Exception as e:
+                logger.debug(f"Triage cache key failed for {cmd!r}: {e}")
+            if cache_key:
+                cached = cache.get(cache_key)
+                if cached is not None:
+                    return {**cached, "cwd": self.cwd, "cached": True}
+
+        result = run(cmd, timeout_seconds)
+        if cache_key:
+            cache.put(cache_key, result)
+        return result
+
+    def _run_bash(self, cmd: str, timeout_seconds: int) -> Dict[str, Any]:
+        # Preferred path: the attempt's long-lived shell session (cwd/env persist natively)
+        session = self._get_shell_session()
+        if session is not None:
+            sink = BoundedOutput(flag_format=self.flag_format)
+            try:
+                run = session.run(cmd, timeout=timeout_seconds, sink=sink)
+            except SessionClosed as e:
+                logger.warning(f"Shell session lost before running command, falling back to exec: {e}")
+                self._close_shell_session()
+            else:
+                self.cwd = run['cwd']
+                return {
+                    "stdout": run['output'],
+                    "stderr": self._stream_note(sink, timeout_seconds, run['timed_out']),
+                    "cwd": self.cwd,
+                    "exit_code": run['exit_code'],
+                    "tool": "bash",
+                    "timed_out": run['timed_out'],
+                    "output_meta": sink.meta()
+                }
+        
+        return self._execute_oneshot(cmd, timeout_seconds)
+
+    @staticmethod
+    def _stream_note(sink: BoundedOutput, timeout_seconds: int, timed_out: bool) -> str:
+        if timed_out:
+            return f"Command timed out after {timeout_seconds}s"
+        if sink.aborted:
+            return f"Command stopped: output exceeded {sink.abort_after:,} bytes"
+        return ""
+    
+    def _get_shell_session(self) -> Optional[ShellSession]:
+        """Return the attempt's shell session, (re)starting it if needed"""
+        if not SHELL_SESSION_ENABLED or self._shell_session_failed:
+            return None
+        if self._shell_session is not None and self._shell_session.alive:
+            return self._shell_session
+        try:
+            self._shell_session = ShellSession(self, self.cwd, ENV_SETUP)
+            logger.info(f"Started shell session in {self.container_name}")
+            return self._shell_session
+        except Exception as e:
+            logger.warning(f"Could not start shell session, using one exec per command: {e}")
+            self._shell_session = None
+            self._shell_session_failed = True
+            return None
+
+    def _close_shell_session(self) -> None:
+        if self._shell_session is not None:
+            self._shell_session.close()
+            self._shell_session = None
+
+    def _validate_directory(self, path: str) -> bool:
+        """Validate that a directory exists in the backend"""
+        try:
+            return self.run_command(['test', '-d', path])[0] == 0
+        except Exception:
+            return False
+    
+    def _extract_new_dir(self, cmd: str) -> Optional[str]:
+        """Extract new directory from cd command"""
+        cmd = (cmd or '').strip()
+        if cmd.startswith('cd '):
+            # Handle cd command at start of pipeline
+            parts = cmd.split('&&')[0].strip().split()
+            if len(parts) >= 2:
+                path = parts[1].strip('\'"')  # Remove quotes
+                if path == '~':
+                    return '/root'
+                elif path.startswith('/'):
+                    return path
+                elif path == '..':
+                    # Go up one directory
+                    parent = '/'.join(self.cwd.split('/')[:-1])
+                    return parent if parent else '/'
+                else:
+                    # Relative path
+                    new_path = f"{self.cwd}/{path}".replace('//', '/')
+                    # Normalize path (remove ./ and ../)
+                    parts = new_path.split('/')
+                    normalized = []
+                    for part in parts:
+                        if part == '..':
+                            if normalized:
+                                normalized.pop()
+                        elif part and part != '.':
+                            normalized.append(part)
+                    return '/' + '/'.join(normalized)
+        return None
+
+    def _gdb_persistent(self, action: Dict[str, Any]) -> Dict[str, Any]:
+        """Run gdb console commands in the attempt's persistent GDB/MI session"""
+        cmd = action.get('cmd') or ''
+        timeout_seconds = action.get('timeout_seconds')
+        if not isinstance(timeout_seconds, int) or timeout_seconds <= 0:
+            timeout_seconds = self.default_timeout_seconds
+        try:
+            binary = action.get('binary')
+            if self._gdb_session is not None and (not self._gdb_session.alive
+                                                  or (binary and binary != self._gdb_session.binary)):
+                self._close_gdb_session()
+            if self._gdb_session is None:
+                if not binary:
+                    # Find binary to debug (first executable file in the working directory)
+                    exit_code, output = self.run_command(
+                        ['bash', '-c', f'cd {self.cwd} && find . -maxdepth 1 -type f -executable | sort | head -1']
+                    )
+                    if exit_code == 0 and output:
+                        binary = output.decode().strip() or None
+                logger.info(f"Starting persistent GDB session (binary={binary})")
+                self._gdb_session = GdbMISession(self, self.cwd, ENV_SETUP, binary=binary)
+
+            memory = action.get('memory')
+            if isinstance(memory, str):
+                memory = {'address': memory}
+            run = self._gdb_session.run(cmd, timeout=timeout_seconds,
+                                        memory=memory if isinstance(memory, dict) else None)
+            structured = run['gdb']
+            stdout = run['console']
+            if run['program_output']:
+                stdout += f"\n[program output]\n{run['program_output']}"
+            stdout += f"\n[gdb] {json.dumps(structured)}\n"
+            stderr = run['errors']
+            if run['timed_out']:
+                stderr += f"GDB command timed out after {timeout_seconds}s (inferior interrupted)\n"
+            if not self._gdb_session.alive:
+                stderr += "GDB session ended; the next gdb action starts a new one\n"
+                self._gdb_session = None
+
+            return {
+                "stdout": stdout,
+                "stderr": stderr,
+                "cwd": self.cwd,
+                "exit_code": 124 if run['timed_out'] else (1 if run['error'] else 0),
+                "tool": "gdb",
+                "timed_out": run['timed_out'],
+                "gdb": structured
+            }
+
+        except Exception as e:
+            logger.error(f"GDB execution failed: {e}")
+            self._close_gdb_session()
+            return {"error": str(e), "cwd": self.cwd, "tool": "gdb"}
+
+    def _close_gdb_session(self) -> None:
+        if self._gdb_session is not None:
+            try:
+                self._gdb_session.close()
+            except Exception:
+                pass
+            self._gdb_session = None
+
+    def _python_persistent(self, action: Dict[str, Any]) -> Dict[str, Any]:
+        """Execute Python code in the attempt's persistent REPL (state survives between steps)"""
+        code = action.get('code') or action.get('cmd') or ''
+        timeout_seconds = action.get('timeout_seconds')
+        if not isinstance(timeout_seconds, int) or timeout_seconds <= 0:
+            timeout_seconds = self.default_timeout_seconds
+        try:
+            if self._python_session is not None and not self._python_session.alive:
+                self._close_python_session()
+            if self._python_session is None:
+                logger.info("Starting persistent Python session")
+                self.install_helpers()
+                self._python_session = PythonReplSession(self, self.cwd, ENV_SETUP,
+                                                         environment={'PYTHONPATH': self.helpers_dir})
+            if action.get('reset'):
+                self._python_session.reset()
+
+            response = self._python_session.execute(code, timeout=timeout_seconds, max_output=MAX_OUTPUT_CHARS)
+            stderr = response.get('stderr') or ''
+            if response.get('error'):
+                stderr += response['error'] if stderr.endswith('\n') or not stderr else '\n' + response['error']
+            if not self._python_session.alive:
+                self._python_session = None
+
+            return {
+                "stdout": response.get('stdout') or '',
+                "stderr": stderr,
+                "cwd": self.cwd,
+                "exit_code": 124 if response.get('timed_out') else (0 if response.get('ok') else 1),
+                "tool": "python",
+                "timed_out": bool(response.get('timed_out')),
+                "python": {k: response[k] for k in ('wall_ms', 'cpu_ms', 'children_cpu_ms', 'maxrss_kb')
+                           if k in response}
+            }
+
+        except Exception as e:
+            logger.error(f"Python execution failed: {e}")
+            self._close_python_session()
+            return {"error": str(e), "cwd": self.cwd, "tool": "python"}
+
+    @property
+    def helpers_dir(self) -> str:
+        return f'{self.tmp_dir}/{HELPERS_SUBDIR}'
+
+    def install_helpers(self) -> None:
+        """Copy the helper modules (fork server, pwn triage, fuzzer) next to each other"""
+        try:
+            self.run_command(['mkdir', '-p', self.helpers_dir])
+            for name, source in HELPERS.items():
+                self.put_file(f'{self.helpers_dir}/{name}', source, mode=0o755)
+        except Exception as e:
+            logger.warning(f"Failed to install python helpers: {e}")
+
+    def start_fuzzer(self, binary: str, workers: int = 0, options: str = '') -> BackgroundFuzzer:
+        """Fuzz a binary in the background for the rest of the attempt (closed by cleanup())"""
+        self.close_fuzzer()
+        self.install_helpers()
+        self._fuzzer = BackgroundFuzzer(self, binary, self.cwd, ENV_SETUP, f'{self.helpers_dir}/flaggy_fuzz.py',
+                                        workers=workers, options=options)
+        return self._fuzzer
+
+    def close_fuzzer(self) -> None:
+        if self._fuzzer is not None:
+            try:
+                self._fuzzer.close()
+            except Exception:
+                pass
+            self._fuzzer = None
+
+    def _close_python_session(self) -> None:
+        if self._python_session is not None:
+            try:
+                self._python_session.close()
+            except Exception:
+                pass
+            self._python_session = None
+
+    def _sidechannel(self, action: Dict[str, Any]) -> Dict[str, Any]:
+        """Recover a password-check input character by character from instruction counts"""
+        binary = action.get('binary') or ''
+        if not binary:
+            return {"error": "No binary provided", "cwd": self.cwd, "tool": "sidechannel"}
+        timeout_seconds = action.get('timeout_seconds')
+        if not isinstance(timeout_seconds, int) or timeout_seconds <= 0:
+            timeout_seconds = SIDECHANNEL_TIMEOUT
+        try:
+            script = f'{self.tmp_dir}/{SIDECHANNEL_NAME}'
+            self.put_file(script, SIDECHANNEL_SOURCE, mode=0o755)
+            cmd = f"python3 {script} {shlex.quote(binary)} {action.get('options') or ''}"
+            cmd += f" --time-limit {max(timeout_seconds - 10, 10)}"
+            if self.flag_format:
+                cmd += f" --flag-format {shlex.quote(self.flag_format)}"
+            result = self._run_bash(cmd, timeout_seconds)
+        except Exception as e:
+            logger.error(f"Side-channel solver failed: {e}")
+            return {"error": str(e), "cwd": self.cwd, "tool": "sidechannel"}
+        return self._with_engine_result(result, 'sidechannel')
+
+    def _pwntriage(self, action: Dict[str, Any]) -> Dict[str, Any]:
+        """Overflow offset, format-string offset and write targets for one binary in a single call"""
+        binary = action.get('binary') or ''
+        if not binary:
+            return {"error": "No binary provided", "cwd": self.cwd, "tool": "pwntriage"}
+        timeout_seconds = action.get('timeout_seconds')
+        if not isinstance(timeout_seconds, int) or timeout_seconds <= 0:
+            timeout_seconds = PWNTRIAGE_TIMEOUT
+        try:
+            self.install_helpers()
+            cmd = f"python3 {self.helpers_dir}/flaggy_pwntriage.py {shlex.quote(binary)} {action.get('options') or ''}"
+            result = self._run_bash(cmd, timeout_seconds)
+        except Exception as e:
+            logger.error(f"Pwn triage failed: {e}")
+            return {"error": str(e), "cwd": self.cwd, "tool": "pwntriage"}
+        return self._with_engine_result(result, 'pwntriage')
+
+    def _job_action(self, tool: str, action: Dict[str, Any]) -> Dict[str, Any]:
+        if self._jobs is None:
+            self._jobs = JobManager(self, ENV_SETUP)
+        job_id = action.get('job_id') or None
+        try:
+            if tool == 'start_job':
+                timeout_seconds = action.get('timeout_seconds')
+                return self._jobs.start(action.get('cmd') or '', self.cwd,
+                                        timeout_seconds if isinstance(timeout_seconds, int) and timeout_seconds > 0 else None,
+                                        action.get('memory_mb'), action.get('name'))
+            if tool == 'job_status':
+                return self._jobs.status(job_id)
+            if tool == 'job_output':
+                return self._jobs.output(job_id, action.get('offset'), action.get('max_bytes'), action.get('tail'))
+            return self._jobs.kill(job_id)
+        except Exception as e:
+            logger.error(f"Job action {tool} failed: {e}")
+            return {"error": str(e), "cwd": self.cwd, "tool": tool}
+
+    @staticmethod
+    def _with_engine_result(result: Dict[str, Any], tool: str) -> Dict[str, Any]:
+        """Tag a helper-engine run and lift its final "[tool] {json}" line into result[tool]"""
+        result['tool'] = tool
+        marker = f'[{tool}] '
+        for line in reversed((result.get('stdout') or '').splitlines()):
+            if line.startswith(marker):
+                try:
+                    result[tool] = json.loads(line[len(marker):])
+                except ValueError:
+                    pass
+                break
+        return result
+
+    def _resolve_path(self, filename: str) -> str:
+        target_path = filename if filename.startswith('/') else os.path.join(self.cwd, filename)
+        return os.path.normpath(target_path)
+
+    def _write_file(self, filename: str, content: str, encoding: Optional[str] = None) -> Dict[str, Any]:
+        """Write a file through the archive API; content may be text, base64 or hex (binary-safe)"""
+        try:
+            if not filename:
+                return {"error": "No filename provided", "cwd": self.cwd, "tool": "write_file"}
+            
+            encoding = (encoding or 'text').lower()
+            try:
+                data = decode_content(content, encoding)
+            except ValueError as e:
+                return {
+                    "stdout": "",
+                    "stderr": f"Could not decode content as {encoding}: {e}",
+                    "cwd": self.cwd,
+                    "exit_code": 1,
+                    "tool": "write_file"
+                }
+            
+            self.put_file(filename, data)
+            logger.info(f"Successfully wrote file: {filename} ({len(data)} bytes)")
+            return {
+                "stdout": f"File '{filename}' written successfully ({len(data)} bytes)",
+                "stderr": "",
+                "cwd": self.cwd,
+                "exit_code": 0,
+                "tool": "write_file"
+            }
+                
+        except Exception as e:
+            logger.error(f"File write failed: {e}")
+            return {
+                "stdout": "",
+                "stderr": f"Failed to write file: {e}",
+                "cwd": self.cwd,
+                "exit_code": 1,
+                "tool": "write_file"
+            }
+
+    def _read_file(self, filename: str, max_bytes: int = None, offset: int = 0,
+                   encoding: Optional[str] = None) -> Dict[str, Any]:
+        """Read a file (or a byte range of it) as text, hex dump or base64"""
+        try:
+            if not filename:
+                return {"error": "No filename provided", "cwd": self.cwd, "tool": "read_file"}
+            offset = offset if isinstance(offset, int) and offset > 0 else 0
+            length = max_bytes if isinstance(max_bytes, int) and max_bytes > 0 else None
+            try:
+                raw_bytes, file_size = self.get_file(filename, offset, length)
+            except (FileNotFoundError, IsADirectoryError, ValueError) as e:
+                kind = {FileNotFoundError: "No such file", IsADirectoryError: "Is a directory"}.get(type(e), str(e))
+                return {
+                    "stdout": "",
+                    "stderr": f"read_file: {filename}: {kind}",
+                    "cwd": self.cwd,
+                    "exit_code": 1,
+                    "tool": "read_file"
+                }
+
+            stdout, view = render_bytes(raw_bytes, encoding, offset)
+            end = offset + len(raw_bytes)
+            truncated = end < file_size
+
+            # Hint to read the rest if the range stopped short of the end of the file
+            stderr_note = ""
+            if truncated:
+                stderr_note = (
+                    f"NOTE: Only read bytes {offset}-{end} of {file_size}. "
+                    f"To read the full file, call read_file {filename} {file_size} or omit max_bytes."
+                )
+            if view == 'hex' and (encoding or 'auto') == 'auto':
+                stderr_note = (stderr_note + "\n" if stderr_note else "") + \
+                    "NOTE: Binary content shown as hex dump (request encoding text/base64 for other views)."
+
+            return {
+                "stdout": stdout,
+                "stderr": stderr_note,
+                "cwd": self.cwd,
+                "exit_code": 0,
+                "tool": "read_file",
+                "meta": {
+                    "filename": filename,
+                    "file_size": file_size,
+                    "max_bytes": max_bytes,
+                    "offset": offset,
+                    "encoding": view,
+                    "bytes_returned": len(raw_bytes),
+                    "truncated": truncated
+                }
+            }
+        except Exception as e:
+            logger.error(f"File read failed: {e}")
+            return {"error": str(e), "cwd": self.cwd, "tool": "read_file"}
+    
+            
+    def get_available_tools(self) -> Dict[str, List[str]]:
+        """Return full EXEGOL_TOOLS list - trust that tools exist in the backend"""
+        if not self.ensure_running():
+            logger.error("Backend not running - cannot provide tools")
+            return {}
+        
+        logger.info("Providing full EXEGOL_TOOLS list to LLM")
+        
+        # Just return the full tools list from config - much faster and more comprehensive
+        total_tools = sum(len(tools) for tools in EXEGOL_TOOLS.values())
+        logger.info(f"Providing {total_tools} tools across {len(EXEGOL_TOOLS)} categories")
+        
+        return EXEGOL_TOOLS.copy()  # Return a copy to avoid modification
+    
+    def get_tool_info(self, tool: str) -> Optional[Dict[str, str]]:
+        """Get information about a specific tool"""
+        if not self.ensure_running():
+            return None
+            
+        try:
+            # Get tool path and version
+            exit_code, output = self.run_command(['which', tool])
+            if exit_code != 0:
+                return None
+                
+            tool_path = output.decode().strip()
+            
+            # Try to get version
+            version_commands = [f'{tool} --version', f'{tool} -V', f'{tool} -v']
+            version_info = None
+            
+            for cmd in version_commands:
+                try:
+                    exit_code, output = self.run_command(['bash', '-c', f'{cmd} 2>&1'])
+                    if exit_code == 0 and output:
+                        version_info = output.decode().strip().split('\n')[0]
+                        break
+                except Exception:
+                    continue
+                    
+            return {
+                'path': tool_path,
+                'version': version_info or 'unknown'
+            }
+            
+        except Exception as e:
+            logger.debug(f"Failed to get info for tool {tool}: {e}")
+            return None
+
+    def cleanup(self):
+        """Clean up persistent sessions and stop the backend"""
+        self._close_gdb_session()
+        self._close_python_session()
+            
+        self.stop()
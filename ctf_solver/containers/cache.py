@@ -0,0 +1,166 @@
+"""
+Content-addressed cache for deterministic triage commands
+
+Attempts on the same challenge keep re-running `file`, `checksec`, `strings`,
+`readelf -a`, `objdump -d` ... on byte-identical binaries. For a whitelist of
+pure tools the result is keyed by the normalized command, the SHA-256 of every
+file it references and the execution environment (image digest), and stored on
+disk so it is shared across attempts, workers and service restarts.
+"""
+import hashlib
+import json
+import logging
+import os
+import re
+import shlex
+import tempfile
+import threading
+from pathlib import Path
+from typing import Any, Dict, List, Optional
+
+from ctf_solver.config import TRIAGE_CACHE_DIR, TRIAGE_CACHE_ENABLED
+
+
+logger = logging.getLogger(__name__)
+
+# Tools whose output depends only on their arguments and the bytes of the files they read
+PURE_TOOLS = {
+    'file', 'checksec', 'strings', 'readelf', 'objdump', 'nm', 'xxd', 'hexdump', 'od',
+    'sha256sum', 'sha1sum', 'md5sum', 'binwalk', 'rabin2', 'size',
+}
+
+# Options that make an otherwise pure tool write to disk
+WRITING_OPTIONS = {
+    'binwalk': {'-e', '--extract', '-D', '--dd', '-M', '--matryoshka', '-C', '--directory'},
+    'xxd': {'-r', '-revert'},
+}
+
+# Anything that could make the command depend on more than its arguments
+_SHELL_META = re.compile(r'[|&;<>`$(){}*?\[\]~\n]')
+
+_CACHE_VERSION = 1
+
+
+def parse_triage_command(cmd: str) -> Optional[List[str]]:
+    """Split a cacheable command into argv, or return None if it is not a plain pure-tool call"""
+    if _SHELL_META.search(cmd):
+        return None
+    try:
+        argv = shlex.split(cmd)
+    except ValueError:
+        return None
+    tool = os.path.basename(argv[0]) if argv else None
+    if tool not in PURE_TOOLS:
+        return None
+    if any(arg.split('=')[0] in WRITING_OPTIONS.get(tool, ()) for arg in argv[1:]):
+        return None
+    return argv
+
+
+def command_operands(argv: List[str]) -> List[str]:
+    """Arguments that may name files: positionals (including the value in `-o value`) and the value of `--opt=value`"""
+    operands = []
+    for arg in argv[1:]:
+        if not arg.startswith('-'):
+            operands.append(arg)
+        elif arg.startswith('--') and '=' in arg:
+            operands.append(arg.split('=', 1)[1])
+    return operands
+
+
+class TriageCache:
+    def __init__(self, cache_dir: str = TRIAGE_CACHE_DIR):
+        self.cache_dir = Path(cache_dir).expanduser()
+        self._lock = threading.Lock()
+        self._hits = 0
+        self._misses = 0
+        self._stores = 0
+        self._uncacheable = 0
+        self._bytes_served = 0
+
+    def key_for(self, backend, cmd: str) -> Optional[str]:
+        """Cache key for cmd run in backend's cwd, or None if the command cannot be cached"""
+        argv = parse_triage_command(cmd)
+        if argv is None:
+            return None
+        operands = command_operands(argv)
+        paths = [backend._resolve_path(arg) for arg in operands]
+        digests = backend.hash_files(paths) if paths else {}
+        # Operands are keyed as typed so attempts with different workspace paths share entries
+        files = sorted((arg, digests[path]) for arg, path in zip(operands, paths) if path in digests)
+        if not files:
+            # Nothing on disk is referenced (e.g. `file --version`); not worth caching
+            with self._lock:
+                self._uncacheable += 1
+            return None
+        key_material = {
+            'v': _CACHE_VERSION,
+            'argv': [os.path.basename(argv[0])] + argv[1:],
+            'files': files,
+            'env': backend.environment_id(),
+            'flag_format': backend.flag_format,
+        }
+        return hashlib.sha256(json.dumps(key_material, sort_keys=True).encode('utf-8')).hexdigest()
+
+    def _path(self, key: str) -> Path:
+        return self.cache_dir / key[:2] / f'{key}.json'
+
+    def get(self, key: str) -> Optional[Dict[str, Any]]:
+        try:
+            with open(self._path(key)) as f:
+                result = json.load(f)
+        except (OSError, ValueError):
+            with self._lock:
+                self._misses += 1
+            return None
+        with self._lock:
+            self._hits += 1
+            self._bytes_served += len(result.get('stdout') or '')
+        return result
+
+    def put(self, key: str, result: Dict[str, Any]) -> None:
+        """Store a finished command result (failures, timeouts and errors are not cached)"""
+        if result.get('error') or result.get('timed_out') or result.get('exit_code') != 0:
+            return
+        entry = {k: v for k, v in result.items() if k != 'cwd'}
+        path = self._path(key)
+        try:
+            path.parent.mkdir(parents=True, exist_ok=True)
+            # Write-then-rename so concurrent workers never read a partial entry
+            fd, tmp = tempfile.mkstemp(dir=path.parent, suffix='.tmp')
+            with os.fdopen(fd, 'w') as f:
+                json.dump(entry, f)
+            os.replace(tmp, path)
+        except OSError as e:
+            logger.warning(f"Failed to store triage cache entry: {e}")
+            return
+        with self._lock:
+            self._stores += 1
+
+    def stats(self) -> Dict[str, Any]:
+        with self._lock:
+            lookups = self._hits + self._misses
+            return {
+                'dir': str(self.cache_dir),
+                'hits': self._hits,
+                'misses': self._misses,
+                'hit_rate': round(self._hits / lookups, 3) if lookups else None,
+                'stores': self._stores,
+                'uncacheable': self._uncacheable,
+                'bytes_served': self._bytes_served,
+            }
+
+
+_cache: Optional[TriageCache] = None
+_cache_lock = threading.Lock()
+
+
+def get_triage_cache() -> Optional[TriageCache]:
+    """Return the process-wide triage cache, or None when disabled"""
+    global _cache
+    if not TRIAGE_CACHE_ENABLED:
+        return None
+    with _cache_lock:
+        if _cache is None:
+            _cache = TriageCache()
+        return _cache
@@ -0,0 +1,465 @@
+"""
+Fork server for fast repeated runs of a challenge binary inside the container
+
+Shipped into the container as source (stdlib only) and importable from the python
+tool as `flaggy_forkserver`. An LD_PRELOAD shim wraps __libc_start_main so the
+target is loaded, relocated and libc-initialised once; every run then forks that
+pre-initialised process at main, with stdin/stdout/stderr redirected to files.
+Each run reports exit status, terminating signal and, for crashes, the faulting
+PC and address plus the stack pointer and the word it points at (taken from the
+signal context inside the child; on x86 a smashed return address faults on `ret`
+and shows up as crash_stack_word), and a stack hash for deduplicating crashes: the
+faulting frame and up to two callers that resolve to a loaded module, taken
+relative to that module's base so it is stable across ASLR and restarts (jumps
+to wild or non-executable addresses of one signal share a hash).
+
+    from flaggy_forkserver import ForkServer
+    with ForkServer(['./vuln']) as fs:
+        r = fs.run(b'A' * 200)
+        r['signal'], hex(r['crash_pc'] or 0), r['stdout']
+
+Static binaries, other architectures or hosts without a C compiler fall back to
+one exec per run with the same result layout (crash_pc is then None).
+"""
+import argparse
+import hashlib
+import json
+import os
+import select
+import shlex
+import shutil
+import signal
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+CTL_FD, ST_FD = 198, 199
+HELLO = 0x31534b46  # "FKS1"
+RESPONSE = struct.Struct('<iIQQQQQQ')  # wait status, flags, crash pc, fault addr, sp, [sp], stack hash, microseconds
+FLAG_TIMED_OUT, FLAG_CRASH_INFO = 1, 2
+CRASH_FIELDS = ('crash_pc', 'fault_addr', 'crash_sp', 'crash_stack_word', 'stack_hash')
+MAX_OUTPUT = 1 << 16
+BUILD_DIR = os.environ.get('FLAGGY_FORKSERVER_DIR', '/tmp/flaggy')
+
+SHIM_SOURCE = r'''
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#define CTL_FD 198
+#define ST_FD 199
+#define MAX_FRAMES 16
+#define HASH_FRAMES 3
+
+typedef int (*main_fn)(int, char **, char **);
+static main_fn real_main;
+static int report_fd = -1;
+static volatile sig_atomic_t expired;
+
+struct response { int32_t status; uint32_t flags; uint64_t pc, addr, sp, stack_word, stack_hash, usec; };
+
+static void on_crash(int sig, siginfo_t *si, void *ctx) {
+    ucontext_t *uc = ctx;
+    uint64_t rec[5] = { (uint64_t)sig, 0, (uint64_t)(uintptr_t)si->si_addr, 0, 0 };
+#if defined(__x86_64__)
+    rec[1] = uc->uc_mcontext.gregs[REG_RIP];
+    rec[3] = uc->uc_mcontext.gregs[REG_RSP];
+#elif defined(__i386__)
+    rec[1] = uc->uc_mcontext.gregs[REG_EIP];
+    rec[3] = uc->uc_mcontext.gregs[REG_ESP];
+#elif defined(__aarch64__)
+    rec[1] = uc->uc_mcontext.pc;
+    rec[3] = uc->uc_mcontext.sp;
+#endif
+    if (rec[3] && !(rec[3] & (sizeof(void *) - 1)))
+        rec[4] = *(uintptr_t *)(uintptr_t)rec[3];
+    if (write(report_fd, rec, sizeof rec) < 0) {}
+    /* Second record: the unwound frames (sent separately so a failed unwind still leaves the first) */
+    void *frames[MAX_FRAMES + 1] = {0};
+    frames[0] = (void *)(uintptr_t)backtrace(frames + 1, MAX_FRAMES);
+    if (write(report_fd, frames, sizeof frames) < 0) {}
+    /* SA_RESETHAND: returning re-executes the fault (or abort() re-raises) under SIG_DFL */
+}
+
+static uint64_t fnv_mix(uint64_t h, uint64_t value) {
+    for (int b = 0; b < 8; b++) { h ^= (value >> (8 * b)) & 0xff; h *= 0x100000001b3ULL; }
+    return h;
+}
+
+/* FNV-1a over the module-relative faulting PC and up to two resolvable callers. A fetch
+   fault or a PC outside every module (wild jump through a smashed pointer) is one bucket
+   per signal. */
+static uint64_t stack_hash(uint64_t sig, uint64_t pc, uint64_t addr, void **frames, int n) {
+    uint64_t h = fnv_mix(0xcbf29ce484222325ULL, sig);
+    Dl_info info;
+    if (addr == pc || !dladdr((void *)(uintptr_t)pc, &info) || !info.dli_fbase)
+        return fnv_mix(h, 0x646c6977);  /* "wild" */
+    h = fnv_mix(h, pc - (uint64_t)(uintptr_t)info.dli_fbase);
+    int start = -1, used = 0;
+    for (int i = 0; i < n && start < 0; i++)
+        if ((uint64_t)(uintptr_t)frames[i] == pc) start = i;
+    for (int i = start + 1; start >= 0 && i < n && used < HASH_FRAMES - 1; i++) {
+        if (!dladdr(frames[i], &info) || !info.dli_fbase) continue;
+        h = fnv_mix(h, (uint64_t)((uintptr_t)frames[i] - (uintptr_t)info.dli_fbase));
+        used++;
+    }
+    return h;
+}
+
+static void on_alarm(int sig) { (void)sig; expired = 1; }
+
+static void redirect(const char *path, int target, int flags) {
+    int fd = open(path, flags, 0600);
+    if (fd >= 0 && fd != target) { dup2(fd, target); close(fd); }
+}
+
+static int fork_server(int argc, char **argv, char **envp) {
+    const char *in = getenv("FLAGGY_FS_IN"), *out = getenv("FLAGGY_FS_OUT"), *err = getenv("FLAGGY_FS_ERR");
+    uint32_t hello = 0x31534b46, timeout_ms;
+    int report[2];
+    if (!in || !out || !err || fcntl(CTL_FD, F_GETFD) < 0 || fcntl(ST_FD, F_GETFD) < 0
+            || pipe(report) < 0 || write(ST_FD, &hello, 4) != 4)
+        return real_main(argc, argv, envp);
+    unsetenv("LD_PRELOAD");
+    fcntl(report[0], F_SETFL, O_NONBLOCK);
+    fcntl(report[0], F_SETFD, FD_CLOEXEC);
+    fcntl(report[1], F_SETFD, FD_CLOEXEC);
+    void *warm[1];
+    backtrace(warm, 1);  /* loads the unwinder now rather than inside a crashing child */
+    struct sigaction alarm_action;
+    memset(&alarm_action, 0, sizeof alarm_action);
+    alarm_action.sa_handler = on_alarm;  /* no SA_RESTART: waitpid returns EINTR on expiry */
+    sigaction(SIGALRM, &alarm_action, NULL);
+
+    while (read(CTL_FD, &timeout_ms, 4) == 4) {
+        struct response r = {0};
+        struct timeval t0, t1;
+        uint64_t rec[5];
+        void *frames[MAX_FRAMES + 1];
+        gettimeofday(&t0, NULL);
+        pid_t pid = fork();
+        if (pid == 0) {
+            static const int crash_signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT, SIGTRAP, SIGSYS };
+            struct sigaction crash_action;
+            close(CTL_FD);
+            close(ST_FD);
+            close(report[0]);
+            report_fd = report[1];
+            signal(SIGALRM, SIG_DFL);
+            redirect(in, 0, O_RDONLY);
+            redirect(out, 1, O_WRONLY | O_TRUNC);
+            redirect(err, 2, O_WRONLY | O_TRUNC);
+            setvbuf(stdout, NULL, _IONBF, 0);  /* keep output written before a crash */
+            memset(&crash_action, 0, sizeof crash_action);
+            crash_action.sa_sigaction = on_crash;
+            crash_action.sa_flags = SA_SIGINFO | SA_RESETHAND | SA_ONSTACK;
+            for (size_t i = 0; i < sizeof crash_signals / sizeof *crash_signals; i++)
+                sigaction(crash_signals[i], &crash_action, NULL);
+            return real_main(argc, argv, envp);
+        }
+        if (pid < 0) {
+            r.status = -1;
+        } else {
+            struct itimerval timer = { {0, 0}, { timeout_ms / 1000, (timeout_ms % 1000) * 1000 } };
+            int status = 0;
+            expired = 0;
+            setitimer(ITIMER_REAL, &timer, NULL);
+            while (waitpid(pid, &status, 0) < 0) {
+                if (errno != EINTR) break;
+                if (expired) { kill(pid, SIGKILL); r.flags |= 1; }
+            }
+            memset(&timer, 0, sizeof timer);
+            setitimer(ITIMER_REAL, &timer, NULL);
+            r.status = status;
+            if (read(report[0], rec, sizeof rec) == sizeof rec) {
+                int n = 0;
+                r.flags |= 2;
+                r.pc = rec[1];
+                r.addr = rec[2];
+                r.sp = rec[3];
+                r.stack_word = rec[4];
+                if (read(report[0], frames, sizeof frames) == sizeof frames)
+                    n = (int)(uintptr_t)frames[0];
+                r.stack_hash = stack_hash(rec[0], rec[1], rec[2], frames + 1, n < 0 || n > MAX_FRAMES ? 0 : n);
+            }
+            while (read(report[0], frames, sizeof frames) > 0) {}
+        }
+        gettimeofday(&t1, NULL);
+        r.usec = (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000 + (t1.tv_usec - t0.tv_usec);
+        if (write(ST_FD, &r, sizeof r) != sizeof r) break;
+    }
+    _exit(0);
+}
+
+int __libc_start_main(main_fn main, int argc, char **argv, void (*init)(void), void (*fini)(void),
+                      void (*rtld_fini)(void), void *stack_end) {
+    int (*next)(main_fn, int, char **, void (*)(void), void (*)(void), void (*)(void), void *)
+        = dlsym(RTLD_NEXT, "__libc_start_main");
+    real_main = main;
+    return next(fork_server, argc, argv, init, fini, rtld_fini, stack_end);
+}
+'''
+
+
+def build_shim(build_dir: str = BUILD_DIR):
+    """Compile the preload shim once per source version; None when no compiler works"""
+    digest = hashlib.sha256(SHIM_SOURCE.encode()).hexdigest()[:12]
+    target = os.path.join(build_dir, f'forkserver-{digest}.so')
+    if os.path.exists(target):
+        return target
+    cc = shutil.which('cc') or shutil.which('gcc') or shutil.which('clang')
+    if not cc:
+        return None
+    os.makedirs(build_dir, exist_ok=True)
+    fd, source = tempfile.mkstemp(suffix='.c', dir=build_dir)
+    with os.fdopen(fd, 'w') as f:
+        f.write(SHIM_SOURCE)
+    partial = source[:-2] + '.so'
+    try:
+        result = subprocess.run([cc, '-shared', '-fPIC', '-O2', '-o', partial, source, '-ldl'],
+                                capture_output=True, timeout=60)
+        if result.returncode != 0:
+            return None
+        os.replace(partial, target)
+        return target
+    except (OSError, subprocess.TimeoutExpired):
+        return None
+    finally:
+        for path in (source, partial):
+            if os.path.exists(path):
+                os.unlink(path)
+
+
+def _scratch_dir() -> str:
+    base = '/dev/shm' if os.access('/dev/shm', os.W_OK) else None
+    return tempfile.mkdtemp(prefix='flaggy-fs-', dir=base)
+
+
+class ForkServer:
+    """Run a binary many times with different stdin, forking from a pre-initialised process"""
+
+    def __init__(self, argv, timeout: float = 2.0, env=None, cwd=None, max_output: int = MAX_OUTPUT,
+                 mode: str = 'auto'):
+        self.argv = shlex.split(argv) if isinstance(argv, str) else [str(a) for a in argv]
+        self.timeout = timeout
+        self.cwd = cwd
+        self.max_output = max_output
+        self.env = dict(os.environ if env is None else env)
+        self.runs = 0
+        self.mode = 'exec'
+        self._proc = None
+        self._dir = _scratch_dir()
+        self._in, self._out, self._err = (os.path.join(self._dir, n) for n in ('in', 'out', 'err'))
+        for path in (self._in, self._out, self._err):
+            open(path, 'wb').close()
+        if mode != 'exec':
+            self._start()
+            if self.mode != 'forkserver' and mode == 'forkserver':
+                self.close()
+                raise RuntimeError('fork server did not start (static binary, foreign arch or no compiler?)')
+
+    # ===== Lifecycle =====
+
+    def _start(self) -> None:
+        shim = build_shim()
+        if not shim:
+            return
+        env = dict(self.env, LD_PRELOAD=shim, FLAGGY_FS_IN=self._in, FLAGGY_FS_OUT=self._out,
+                   FLAGGY_FS_ERR=self._err)
+        ctl_r, ctl_w = os.pipe()
+        st_r, st_w = os.pipe()
+        saved = [os.dup(fd) if _fd_open(fd) else None for fd in (CTL_FD, ST_FD)]
+        try:
+            os.dup2(ctl_r, CTL_FD)
+            os.dup2(st_w, ST_FD)
+            self._proc = subprocess.Popen(self.argv, env=env, cwd=self.cwd, pass_fds=(CTL_FD, ST_FD),
+                                          stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL,
+                                          stderr=subprocess.DEVNULL)
+        except OSError:
+            self._proc = None
+        finally:
+            for fd, old in zip((CTL_FD, ST_FD), saved):
+                if old is None:
+                    os.close(fd)
+                else:
+                    os.dup2(old, fd)
+                    os.close(old)
+            os.close(ctl_r)
+            os.close(st_w)
+        self._ctl, self._st = ctl_w, st_r
+        if self._proc is not None and self._recv(4, 10.0) == struct.pack('<I', HELLO):
+            self.mode = 'forkserver'
+        else:
+            self._stop()
+
+    def _stop(self) -> None:
+        if self._proc is not None:
+            for fd in (self._ctl, self._st):
+                try:
+                    os.close(fd)
+                except OSError:
+                    pass
+            try:
+                self._proc.kill()
+                self._proc.wait(timeout=5)
+            except (OSError, subprocess.TimeoutExpired):
+                pass
+            self._proc = None
+        self.mode = 'exec'
+
+    def close(self) -> None:
+        self._stop()
+        shutil.rmtree(self._dir, ignore_errors=True)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        try:
+            self.close()
+        except Exception:
+            pass
+
+    # ===== Runs =====
+
+    def run(self, data: bytes = b'', timeout=None) -> dict:
+        """Feed data on stdin; returns stdout/stderr, exit_code or signal, crash_* registers, ms"""
+        if isinstance(data, str):
+            data = data.encode('latin-1')
+        timeout = self.timeout if timeout is None else timeout
+        self.runs += 1
+        if self.mode == 'forkserver':
+            result = self._run_forked(data, timeout)
+            if result is not None:
+                return result
+            # The server itself died (e.g. the target exits before main returns): restart once
+            self._stop()
+            self._start()
+            if self.mode == 'forkserver':
+                result = self._run_forked(data, timeout)
+                if result is not None:
+                    return result
+                self._stop()
+        return self._run_exec(data, timeout)
+
+    def _run_forked(self, data: bytes, timeout: float):
+        with open(self._in, 'wb') as f:
+            f.write(data)
+        try:
+            os.write(self._ctl, struct.pack('<I', max(1, int(timeout * 1000))))
+        except OSError:
+            return None
+        raw = self._recv(RESPONSE.size, timeout + 5.0)
+        if raw is None:
+            return None
+        status, flags, pc, addr, sp, stack_word, stack_hash, usec = RESPONSE.unpack(raw)
+        crash = (pc, addr, sp, stack_word, f'{stack_hash:016x}') if flags & FLAG_CRASH_INFO else (None,) * 5
+        return self._result(
+            exit_code=os.WEXITSTATUS(status) if os.WIFEXITED(status) else None,
+            signum=os.WTERMSIG(status) if os.WIFSIGNALED(status) else None,
+            timed_out=bool(flags & FLAG_TIMED_OUT), crash=crash, ms=usec / 1000.0,
+            stdout=_read_head(self._out, self.max_output), stderr=_read_head(self._err, self.max_output))
+
+    def _run_exec(self, data: bytes, timeout: float) -> dict:
+        start = time.perf_counter()
+        try:
+            proc = subprocess.run(self.argv, input=data, capture_output=True, timeout=timeout, env=self.env,
+                                  cwd=self.cwd)
+            code, stdout, stderr, timed_out = proc.returncode, proc.stdout, proc.stderr, False
+        except subprocess.TimeoutExpired as e:
+            code, stdout, stderr, timed_out = -signal.SIGKILL, e.stdout or b'', e.stderr or b'', True
+        return self._result(exit_code=code if code >= 0 else None, signum=-code if code < 0 else None,
+                            timed_out=timed_out, crash=(None,) * 5,
+                            ms=(time.perf_counter() - start) * 1000,
+                            stdout=stdout[:self.max_output], stderr=stderr[:self.max_output])
+
+    @staticmethod
+    def _result(exit_code, signum, timed_out, crash, ms, stdout, stderr) -> dict:
+        result = {'stdout': stdout, 'stderr': stderr, 'exit_code': exit_code, 'signal': signum,
+                  'crashed': signum is not None and not timed_out, 'timed_out': timed_out, 'ms': round(ms, 3)}
+        result.update(zip(CRASH_FIELDS, crash))
+        return result
+
+    def _recv(self, size: int, timeout: float):
+        buf = b''
+        deadline = time.time() + timeout
+        while len(buf) < size:
+            remaining = deadline - time.time()
+            if remaining <= 0 or not select.select([self._st], [], [], remaining)[0]:
+                return None
+            chunk = os.read(self._st, size - len(buf))
+            if not chunk:
+                return None
+            buf += chunk
+        return buf
+
+
+def _fd_open(fd: int) -> bool:
+    try:
+        os.fstat(fd)
+        return True
+    except OSError:
+        return False
+
+
+def _read_head(path: str, limit: int) -> bytes:
+    with open(path, 'rb') as f:
+        return f.read(limit)
+
+
+def _printable(result: dict) -> dict:
+    shown = dict(result)
+    for key in ('stdout', 'stderr'):
+        shown[key] = shown[key].decode('utf-8', errors='replace')
+    for key in CRASH_FIELDS[:4]:
+        if shown[key] is not None:
+            shown[key] = hex(shown[key])
+    return shown
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('target', nargs=argparse.REMAINDER, help='binary and its arguments')
+    parser.add_argument('--input', action='append', default=[], help='file whose bytes are one run\'s stdin')
+    parser.add_argument('--bench', type=int, default=0, help='time N runs (stdin: the first --input, else empty)')
+    parser.add_argument('--timeout', type=float, default=2.0, help='seconds per run')
+    parser.add_argument('--mode', choices=('auto', 'forkserver', 'exec'), default='auto')
+    opts = parser.parse_args(argv)
+    if not opts.target:
+        parser.error('missing target binary')
+    with ForkServer(opts.target, timeout=opts.timeout, mode=opts.mode) as fs:
+        for path in opts.input:
+            with open(path, 'rb') as f:
+                print(json.dumps({'input': path, 'mode': fs.mode, **_printable(fs.run(f.read()))}), flush=True)
+        if opts.bench:
+            data = b''
+            if opts.input:
+                with open(opts.input[0], 'rb') as f:
+                    data = f.read()
+            start = time.perf_counter()
+            for _ in range(opts.bench):
+                fs.run(data)
+            elapsed = time.perf_counter() - start
+            print(json.dumps({'mode': fs.mode, 'runs': opts.bench, 'seconds': round(elapsed, 3),
+                              'execs_per_sec': round(opts.bench / elapsed, 1)}), flush=True)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,74 @@
+"""
+Host side of the background fuzzer (see fuzz_engine.py for the in-container half)
+"""
+import json
+import logging
+import shlex
+from typing import Any, Dict, List
+
+from ctf_solver.containers.session import SessionClosed, STDOUT
+
+
+logger = logging.getLogger(__name__)
+
+EVENT_PREFIX = b'[fuzz] '
+
+
+class BackgroundFuzzer:
+    """Fuzzes one binary for the whole attempt; crashes are collected between steps without blocking"""
+
+    def __init__(self, backend, binary: str, cwd: str, env_setup: str, engine: str,
+                 workers: int = 0, options: str = ''):
+        self.backend = backend
+        self.binary = binary
+        self.crashes: List[Dict[str, Any]] = []
+        self.stats: Dict[str, Any] = {}
+        self._buf = bytearray()
+        cmd = f"python3 -u {engine} {shlex.quote(binary)} --workers {int(workers)} {options}".rstrip()
+        self.channel = backend.open_channel(['bash', '-lc', f"{env_setup} && cd {cwd} && exec {cmd}"],
+                                            environment={'PYTHONUNBUFFERED': '1'}, workdir=cwd)
+
+    @property
+    def alive(self) -> bool:
+        return not self.channel.closed
+
+    def poll(self) -> List[Dict[str, Any]]:
+        """Drain whatever the fuzzer printed since the last call; returns the new crash buckets"""
+        new: List[Dict[str, Any]] = []
+        try:
+            while True:
+                frame = self.channel.read_frame(timeout=0.01)
+                if frame is None:
+                    break
+                stream, data = frame
+                if stream == STDOUT:
+                    self._buf.extend(data)
+        except SessionClosed:
+            pass
+        *lines, rest = bytes(self._buf).split(b'\n')
+        self._buf = bytearray(rest)
+        for line in lines:
+            if not line.startswith(EVENT_PREFIX):
+                continue
+            try:
+                event = json.loads(line[len(EVENT_PREFIX):])
+            except ValueError:
+                continue
+            kind = event.pop('event', None)
+            if kind == 'crash':
+                self.crashes.append(event)
+                new.append(event)
+            elif kind == 'stats':
+                self.stats = event
+            elif kind == 'start':
+                logger.info(f"Background fuzzer started on {self.binary} ({event.get('workers')} workers)")
+        return new
+
+    def close(self) -> None:
+        """SIGTERM lets the engine stop its workers (and their fork servers) before the channel goes"""
+        if self.alive:
+            try:
+                self.backend.run_command(['pkill', '-TERM', '-f', f'flaggy_fuzz.py {self.binary}'])
+            except Exception as e:
+                logger.debug(f"Failed to signal background fuzzer: {e}")
+        self.channel.close()
@@ -0,0 +1,216 @@
+"""
+Mutational stdin fuzzer on top of the fork server, run in the background of an attempt
+
+Shipped into the container next to flaggy_forkserver (stdlib only). Each worker
+process owns a fork server and mutates inputs from a shared seed set (havoc-style
+stacks of byte flips, interesting values, format specifiers, long runs and
+splices). Without coverage instrumentation, an input joins the worker's corpus
+when it produces a new outcome: exit status or signal plus the shape of the
+program's output with numbers masked out.
+
+Crashes are bucketed by the fork server's stack hash (faulting frame plus two
+resolvable callers, module-relative; wild jumps share one bucket per signal); the first input of each bucket is saved as
+<out>/crashes/<hash>.bin, claimed with O_EXCL so workers never report a bucket twice.
+
+Events go to stdout as "[fuzz] {json}" lines: one per new crash bucket and a
+stats line every --stats-interval seconds.
+"""
+import argparse
+import json
+import multiprocessing
+import os
+import queue
+import random
+import re
+import signal
+import sys
+import tempfile
+import time
+import zlib
+
+from flaggy_forkserver import ForkServer
+
+SEEDS = (b'\n', b'A\n', b'1\n', b'0\n', b'AAAAAAAA\n', b'%p %p %p %p\n', b'-1\n', b'y\n', b'1\n1\n1\n')
+TOKENS = (b'\x00', b'\xff', b'\x7f', b'\x80', b'\n', b'0', b'-1', b'65535', b'4294967295', b'2147483648',
+          b'%n', b'%s%s%s%s', b'%p', b'%x' * 8, b'../' * 4, b'A' * 64, b'A' * 512)
+MAX_CORPUS = 512
+MAX_HAVOC = 8
+_NUMBERS = re.compile(rb'(0x)?[0-9a-fA-F]{2,}|\d+')
+
+
+def outcome(result: dict) -> int:
+    """Novelty key: how the run ended and what its output looked like, ignoring numbers"""
+    shape = _NUMBERS.sub(b'#', result['stdout'][-512:])
+    return zlib.crc32(shape, hash((result['exit_code'], result['signal'], result['timed_out'])) & 0xffffffff)
+
+
+class Mutator:
+    def __init__(self, rng: random.Random, max_len: int):
+        self.rng = rng
+        self.max_len = max_len
+
+    def mutate(self, data: bytes, corpus) -> bytes:
+        rng = self.rng
+        buf = bytearray(data or b'\n')
+        for _ in range(rng.randint(1, MAX_HAVOC)):
+            op = rng.randrange(9)
+            pos = rng.randrange(len(buf) + 1)
+            if op == 0 and buf:
+                buf[pos % len(buf)] ^= 1 << rng.randrange(8)
+            elif op == 1 and buf:
+                buf[pos % len(buf)] = rng.randrange(256)
+            elif op == 2:
+                buf[pos:pos] = rng.choice(TOKENS)
+            elif op == 3 and len(buf) > 1:
+                end = min(len(buf), pos + rng.randint(1, 32))
+                del buf[pos:end]
+            elif op == 4 and buf:
+                start = rng.randrange(len(buf))
+                chunk = buf[start:start + rng.randint(1, 64)]
+                buf[pos:pos] = chunk * rng.randint(1, 8)
+            elif op == 5:
+                # Long runs find fixed-size buffers quickly
+                buf[pos:pos] = bytes([rng.choice(b'A\xff\x00%')]) * rng.choice((32, 64, 128, 256, 1024, 4096))
+            elif op == 6 and corpus:
+                other = rng.choice(corpus)
+                cut = rng.randrange(len(other) + 1)
+                buf = buf[:pos] + other[cut:]
+            elif op == 7:
+                buf[pos:pos] = str(rng.choice((0, -1, 1, 255, 256, 65536, 2 ** 31 - 1, 2 ** 31, 2 ** 32 - 1,
+                                               2 ** 63, rng.randrange(1 << 16)))).encode()
+            else:
+                buf[pos:pos] = rng.choice(corpus or SEEDS)[:64]
+        return bytes(buf[:self.max_len])
+
+
+def worker(index: int, argv, out_dir: str, seeds, opts, events) -> None:
+    """One fork server plus mutation loop; crash buckets and periodic counters go to the parent"""
+    signal.signal(signal.SIGINT, signal.SIG_IGN)
+    signal.signal(signal.SIGTERM, lambda signum, frame: sys.exit(0))  # lets the fork server clean up
+    rng = random.Random(opts['seed'] + index)
+    mutator = Mutator(rng, opts['max_len'])
+    crash_dir = os.path.join(out_dir, 'crashes')
+    corpus = list(seeds)
+    seen = set()
+    execs = timeouts = crash_hits = 0
+    last = time.time()
+    with ForkServer(argv, timeout=opts['timeout'], max_output=4096) as fs:
+        while True:
+            data = corpus[execs % len(corpus)] if execs < len(seeds) else mutator.mutate(rng.choice(corpus), corpus)
+            result = fs.run(data)
+            execs += 1
+            timeouts += result['timed_out']
+            key = outcome(result)
+            if key not in seen:
+                seen.add(key)
+                if len(corpus) < MAX_CORPUS:
+                    corpus.append(data)
+            if result['crashed']:
+                crash_hits += 1
+                bucket = result.get('stack_hash') or f"{result['signal']}-{result.get('crash_pc') or 0:x}"
+                path = os.path.join(crash_dir, f'{bucket}.bin')
+                try:
+                    fd = os.open(path, os.O_WRONLY | os.O_CREAT | os.O_EXCL, 0o644)
+                except FileExistsError:
+                    fd = None
+                if fd is not None:
+                    with os.fdopen(fd, 'wb') as f:
+                        f.write(data)
+                    events.put(('crash', {
+                        'bucket': bucket, 'signal': result['signal'],
+                        **{k: _hex(result.get(k)) for k in ('crash_pc', 'fault_addr', 'crash_stack_word')},
+                        'input': path, 'input_len': len(data), 'input_preview': repr(data[:80])[2:-1],
+                        'stdout_tail': result['stdout'][-200:].decode('utf-8', errors='replace'),
+                        'worker': index, 'mode': fs.mode,
+                    }))
+            now = time.time()
+            if now - last >= 1.0:
+                events.put(('stats', {'worker': index, 'execs': execs, 'timeouts': timeouts,
+                                      'crash_hits': crash_hits, 'corpus': len(corpus), 'mode': fs.mode}))
+                last = now
+
+
+def _hex(value):
+    return hex(value) if isinstance(value, int) else value
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('binary')
+    parser.add_argument('args', nargs='*', help='extra arguments for the target')
+    parser.add_argument('--out', help='output directory (default: a fresh /tmp/flaggy/fuzz-<binary>-*)')
+    parser.add_argument('--seed-file', action='append', default=[], help='initial input (repeatable)')
+    parser.add_argument('--workers', type=int, default=0, help='worker processes (default: CPUs - 1, at least 1)')
+    parser.add_argument('--timeout', type=float, default=0.2,
+                        help='seconds per run (menu loops that spin on EOF end here)')
+    parser.add_argument('--max-len', type=int, default=8192)
+    parser.add_argument('--time-limit', type=float, default=0, help='stop after this many seconds (0: until killed)')
+    parser.add_argument('--stats-interval', type=float, default=10)
+    parser.add_argument('--seed', type=int, default=0, help='RNG seed')
+    opts = parser.parse_args(argv)
+
+    binary = os.path.abspath(opts.binary)
+    if opts.out:
+        out_dir = opts.out
+    else:
+        os.makedirs('/tmp/flaggy', exist_ok=True)
+        out_dir = tempfile.mkdtemp(prefix=f'fuzz-{os.path.basename(binary)}-', dir='/tmp/flaggy')
+    os.makedirs(os.path.join(out_dir, 'crashes'), exist_ok=True)
+    seeds = list(SEEDS)
+    for path in opts.seed_file:
+        with open(path, 'rb') as f:
+            seeds.insert(0, f.read())
+    workers = opts.workers or max(1, (os.cpu_count() or 2) - 1)
+    settings = {'timeout': opts.timeout, 'max_len': opts.max_len, 'seed': opts.seed or int(time.time())}
+    mp = multiprocessing.get_context('fork')
+    events = mp.Queue()
+    procs = [mp.Process(target=worker, args=(i, [binary] + opts.args, out_dir, seeds, settings, events), daemon=True)
+             for i in range(workers)]
+    for proc in procs:
+        proc.start()
+
+    def stop(signum, frame):
+        raise KeyboardInterrupt
+
+    signal.signal(signal.SIGTERM, stop)
+    start = time.time()
+    latest = {}
+    buckets = 0
+    next_stats = start + opts.stats_interval
+    emit = lambda event, body: print(f"[fuzz] {json.dumps({'event': event, **body})}", flush=True)
+    emit('start', {'binary': opts.binary, 'workers': workers, 'out': out_dir})
+    try:
+        while any(proc.is_alive() for proc in procs):
+            now = time.time()
+            if opts.time_limit and now - start > opts.time_limit:
+                break
+            try:
+                kind, body = events.get(timeout=max(0.05, min(next_stats - now, 1.0)))
+            except queue.Empty:
+                kind = None
+            if kind == 'crash':
+                buckets += 1
+                body['elapsed'] = round(time.time() - start, 1)
+                body['execs'] = sum(s['execs'] for s in latest.values())
+                emit('crash', body)
+            elif kind == 'stats':
+                latest[body['worker']] = body
+            if time.time() >= next_stats:
+                next_stats += opts.stats_interval
+                totals = {k: sum(s[k] for s in latest.values()) for k in ('execs', 'timeouts', 'crash_hits', 'corpus')}
+                elapsed = time.time() - start
+                emit('stats', {**totals, 'buckets': buckets, 'elapsed': round(elapsed, 1),
+                               'execs_per_sec': round(totals['execs'] / elapsed, 1),
+                               'mode': next((s['mode'] for s in latest.values()), None)})
+    except (KeyboardInterrupt, BrokenPipeError):
+        pass
+    finally:
+        for proc in procs:
+            proc.terminate()
+        for proc in procs:
+            proc.join(timeout=5)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
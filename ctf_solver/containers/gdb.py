@@ -0,0 +1,448 @@
+"""
+Persistent GDB session driven through the GDB/MI machine interface
+
+One gdb process is kept per attempt: the binary's symbols are loaded once and the
+inferior survives between agent steps, so `break`/`run`/`continue`/`x` sequences
+can be spread over several actions. Console commands are forwarded with
+`-interpreter-exec console`, and stops, breakpoints, registers and memory reads
+are reported as structured data parsed from MI records.
+"""
+import logging
+import re
+import time
+from typing import Any, Dict, List, Optional, Tuple
+
+from ctf_solver.containers.output import BoundedOutput
+from ctf_solver.containers.session import SessionClosed
+
+
+logger = logging.getLogger(__name__)
+
+# Start of an MI output record: optional numeric token, then the record-type character
+_RECORD_RE = re.compile(r'^(\d*)([\^*+=~@&])')
+# Async/result records that inferior output without a trailing newline may have been glued to
+_EMBEDDED_RECORD_RE = re.compile(
+    r'(\d*[\^*=](?:done|running|connected|error|exit|stopped|thread-|library-|breakpoint-|cmd-param-|memory-changed)'
+    r'|[~@&]")'
+)
+_PROMPT = '(gdb)'
+
+# Console commands that start the inferior; it must not inherit gdb's stdin (the MI channel)
+_RUN_RE = re.compile(r'^\s*(r|run|start|starti)(\s+.*)?$')
+
+# Registers worth reporting on every stop (others are available on request)
+DEFAULT_REGISTERS = (
+    'rax', 'rbx', 'rcx', 'rdx', 'rsi', 'rdi', 'rbp', 'rsp', 'r8', 'r9', 'r10', 'r11',
+    'r12', 'r13', 'r14', 'r15', 'rip', 'eflags',
+    'eax', 'ebx', 'ecx', 'edx', 'esi', 'edi', 'ebp', 'esp', 'eip',
+    'pc', 'sp', 'lr', 'x0', 'x1', 'x2', 'x3', 'r0', 'r1', 'r2', 'r3',
+)
+
+
+class MIParseError(ValueError):
+    pass
+
+
+def _parse_cstring(text: str, pos: int) -> Tuple[str, int]:
+    """Parse a C string starting at the opening quote; return (value, index after closing quote)"""
+    assert text[pos] == '"'
+    out: List[str] = []
+    i = pos + 1
+    escapes = {'n': '\n', 't': '\t', 'r': '\r', '"': '"', '\\': '\\', 'a': '\a', 'b': '\b',
+               'f': '\f', 'v': '\v', 'e': '\x1b'}
+    while i < len(text):
+        ch = text[i]
+        if ch == '"':
+            return ''.join(out), i + 1
+        if ch == '\\' and i + 1 < len(text):
+            nxt = text[i + 1]
+            if nxt in escapes:
+                out.append(escapes[nxt])
+                i += 2
+                continue
+            if nxt in '01234567':
+                digits = re.match(r'[0-7]{1,3}', text[i + 1:]).group(0)
+                out.append(chr(int(digits, 8)))
+                i += 1 + len(digits)
+                continue
+            out.append(nxt)
+            i += 2
+            continue
+        out.append(ch)
+        i += 1
+    raise MIParseError("unterminated string")
+
+
+def _parse_value(text: str, pos: int) -> Tuple[Any, int]:
+    ch = text[pos]
+    if ch == '"':
+        return _parse_cstring(text, pos)
+    if ch == '{':
+        if text[pos + 1] == '}':
+            return {}, pos + 2
+        result, pos = _parse_results(text, pos + 1, '}')
+        return result, pos + 1
+    if ch == '[':
+        items: List[Any] = []
+        pos += 1
+        if text[pos] == ']':
+            return items, pos + 1
+        while True:
+            # A list holds either bare values or name=value results
+            if text[pos] in '"{[':
+                value, pos = _parse_value(text, pos)
+                items.append(value)
+            else:
+                name, value, pos = _parse_result(text, pos)
+                items.append({name: value})
+            if text[pos] == ',':
+                pos += 1
+                continue
+            if text[pos] == ']':
+                return items, pos + 1
+            raise MIParseError(f"unexpected {text[pos]!r} in list")
+    raise MIParseError(f"unexpected {ch!r} at {pos}")
+
+
+def _parse_result(text: str, pos: int) -> Tuple[str, Any, int]:
+    eq = text.index('=', pos)
+    name = text[pos:eq]
+    value, pos = _parse_value(text, eq + 1)
+    return name, value, pos
+
+
+def _parse_results(text: str, pos: int, end: Optional[str]) -> Tuple[Dict[str, Any], int]:
+    results: Dict[str, Any] = {}
+    repeated = set()
+    while pos < len(text) and (end is None or text[pos] != end):
+        name, value, pos = _parse_result(text, pos)
+        if name in results:
+            # Repeated keys (e.g. bkpt=...,bkpt=...) collapse into a list
+            if name not in repeated:
+                results[name] = [results[name]]
+                repeated.add(name)
+            results[name].append(value)
+        else:
+            results[name] = value
+        if pos < len(text) and text[pos] == ',':
+            pos += 1
+    return results, pos
+
+
+def parse_mi_line(line: str) -> Optional[Dict[str, Any]]:
+    """Parse one line of MI output.
+
+    Returns {'type': 'result'|'exec'|'status'|'notify'|'console'|'target'|'log'|'prompt',
+    'token', 'class', 'results'|'text'}, or None when the line is not an MI record
+    (e.g. output written by the debugged program).
+    """
+    line = line.rstrip('\r')
+    if line.strip() == _PROMPT:
+        return {'type': 'prompt'}
+    m = _RECORD_RE.match(line)
+    if not m:
+        return None
+    token = int(m.group(1)) if m.group(1) else None
+    kind = m.group(2)
+    rest = line[m.end():]
+    try:
+        if kind in '~@&':
+            if not rest.startswith('"'):
+                return None
+            text, _ = _parse_cstring(rest, 0)
+            return {'type': {'~': 'console', '@': 'target', '&': 'log'}[kind], 'token': token, 'text': text}
+        cls, _, tail = rest.partition(',')
+        if not re.fullmatch(r'[a-z-]+', cls):
+            return None
+        results, _ = _parse_results(tail, 0, None) if tail else ({}, 0)
+    except (MIParseError, ValueError, IndexError, AssertionError):
+        return None
+    kind_name = {'^': 'result', '*': 'exec', '+': 'status', '=': 'notify'}[kind]
+    return {'type': kind_name, 'token': token, 'class': cls, 'results': results}
+
+
+def mi_quote(text: str) -> str:
+    """Quote a string as an MI c-string argument"""
+    return '"' + text.replace('\\', '\\\\').replace('"', '\\"').replace('\n', '\\n') + '"'
+
+
+class GdbMISession:
+    """A gdb process speaking MI over a backend channel (an attached exec for containers).
+
+    The inferior inherits gdb's stdout, so program output arrives interleaved with MI
+    records; anything that does not parse as a record is reported as program output.
+    Its stdin is /dev/null unless the run command redirects it, because gdb's own stdin
+    is the command channel.
+    """
+
+    def __init__(self, backend, cwd: str, env_setup: str, binary: Optional[str] = None,
+                 startup_timeout: float = 30.0):
+        self.backend = backend
+        self.cwd = cwd
+        self.binary = binary
+        self._token = 0
+        self._pending = ''  # partial line carried between reads
+        self._register_names: Optional[List[str]] = None
+        self.state = 'not started'  # inferior state: not started | running | stopped | exited
+        self.last_stop: Optional[Dict[str, Any]] = None
+        self.breakpoints: Dict[str, Dict[str, Any]] = {}
+
+        # -nx: skip ~/.gdbinit so pwndbg/gef banners and prompts cannot corrupt the MI stream
+        self.channel = backend.open_channel(
+            ['bash', '-lc', f'{env_setup} && cd {cwd} && exec gdb --interpreter=mi2 -q -nx'],
+            environment={'TERM': 'dumb'}, workdir=cwd,
+        )
+        # Wait for the first prompt
+        self._read_until(lambda rec: rec['type'] == 'prompt', startup_timeout)
+        for setup in ('-gdb-set mi-async on', '-gdb-set pagination off', '-gdb-set confirm off',
+                      '-gdb-set width 0', '-gdb-set height 0', '-gdb-set print pretty off'):
+            self.command(setup, timeout=10)
+        if binary:
+            loaded = self.command(f'-file-exec-and-symbols {mi_quote(binary)}', timeout=60)
+            if loaded['class'] == 'error':
+                self.close()
+                raise SessionClosed(f"gdb could not load {binary}: {loaded['results'].get('msg')}")
+
+    @property
+    def alive(self) -> bool:
+        return not self.channel.closed
+
+    # ===== Low-level MI plumbing =====
+
+    def _read_records(self, timeout: float) -> List[Tuple[Optional[Dict[str, Any]], str]]:
+        """Read one frame and return its complete lines as (record or None, raw line)"""
+        frame = self.channel.read_frame(timeout=timeout)
+        if frame is None:
+            return []
+        self._pending += frame[1].decode('utf-8', errors='replace')
+        lines = self._pending.split('\n')
+        self._pending = lines.pop()
+        out: List[Tuple[Optional[Dict[str, Any]], str]] = []
+        for line in lines:
+            record = parse_mi_line(line)
+            if record is None:
+                # Program output without a trailing newline glues onto the next record
+                m = _EMBEDDED_RECORD_RE.search(line)
+                if m and m.start() > 0:
+                    embedded = parse_mi_line(line[m.start():])
+                    if embedded is not None:
+                        out.append((None, line[:m.start()]))
+                        out.append((embedded, line[m.start():]))
+                        continue
+                if line.endswith(_PROMPT):
+                    out.append((None, line[:-len(_PROMPT)]))
+                    out.append(({'type': 'prompt'}, _PROMPT))
+                    continue
+            out.append((record, line))
+        # A bare prompt never ends in newline in some gdb builds
+        if self._pending.strip() == _PROMPT:
+            self._pending = ''
+            out.append(({'type': 'prompt'}, _PROMPT))
+        return out
+
+    def _read_until(self, predicate, timeout: float, sink: Optional[Dict[str, Any]] = None) -> bool:
+        """Consume records until predicate(record) is true; collect everything into sink"""
+        deadline = time.time() + timeout
+        while True:
+            remaining = deadline - time.time()
+            if remaining <= 0:
+                return False
+            for record, raw in self._read_records(min(0.5, remaining)):
+                if record is None:
+                    if sink is not None:
+                        sink['program'].write((raw + '\n').encode('utf-8', errors='replace'))
+                    continue
+                if sink is not None:
+                    self._absorb(record, sink)
+                if predicate(record):
+                    return True
+
+    def _absorb(self, record: Dict[str, Any], sink: Dict[str, Any]) -> None:
+        """Fold one record into the per-command output and the session state"""
+        kind = record['type']
+        if kind == 'console':
+            sink['console'].append(record['text'])
+        elif kind == 'target':
+            sink['program'].write(record['text'].encode('utf-8', errors='replace'))
+        elif kind == 'log':
+            # The echoed command is logged too; keep only gdb's own diagnostics
+            if not record['text'].startswith(sink.get('echo', '\0')):
+                sink['errors'].append(record['text'])
+        elif kind == 'exec':
+            if record['class'] == 'running':
+                self.state = 'running'
+            elif record['class'] == 'stopped':
+                self._on_stopped(record['results'])
+                sink['stops'].append(self.last_stop)
+        elif kind == 'notify':
+            cls, results = record['class'], record['results']
+            if cls in ('breakpoint-created', 'breakpoint-modified') and isinstance(results.get('bkpt'), dict):
+                bkpt = results['bkpt']
+                self.breakpoints[str(bkpt.get('number'))] = self._summarize_breakpoint(bkpt)
+            elif cls == 'breakpoint-deleted':
+                self.breakpoints.pop(str(results.get('id')), None)
+            elif cls == 'thread-group-exited' and self.state != 'exited':
+                self.state = 'exited'
+
+    def _on_stopped(self, results: Dict[str, Any]) -> None:
+        reason = results.get('reason', '')
+        frame = results.get('frame') or {}
+        stop: Dict[str, Any] = {'reason': reason or 'unknown'}
+        if reason.startswith('exited'):
+            self.state = 'exited'
+            if 'exit-code' in results:
+                stop['exit_code'] = int(results['exit-code'], 8)
+        else:
+            self.state = 'stopped'
+        for key in ('signal-name', 'signal-meaning', 'bkptno'):
+            if key in results:
+                stop[key.replace('-', '_')] = results[key]
+        if frame:
+            stop['frame'] = {k: frame[k] for k in ('addr', 'func', 'file', 'line') if k in frame}
+        self.last_stop = stop
+
+    @staticmethod
+    def _summarize_breakpoint(bkpt: Dict[str, Any]) -> Dict[str, Any]:
+        keys = ('number', 'type', 'enabled', 'addr', 'func', 'file', 'line', 'times', 'cond', 'original-location')
+        return {k.replace('-', '_'): bkpt[k] for k in keys if k in bkpt}
+
+    def command(self, mi_command: str, timeout: float, sink: Optional[Dict[str, Any]] = None) -> Dict[str, Any]:
+        """Send one MI command and wait for its result record (and the inferior stopping, if it ran)"""
+        self._token += 1
+        token = self._token
+        sink = sink if sink is not None else self._new_sink()
+        result: Dict[str, Any] = {'class': None, 'results': {}, 'timed_out': False}
+
+        def is_result(record):
+            if record['type'] == 'result' and record.get('token') == token:
+                result['class'] = record['class']
+                result['results'] = record['results']
+                return True
+            return False
+
+        self.channel.send(f'{token}{mi_command}\n'.encode('utf-8'))
+        deadline = time.time() + timeout
+        if not self._read_until(is_result, timeout, sink):
+            result['timed_out'] = True
+            return result
+        if result['class'] == 'running' or self.state == 'running':
+            if not self._wait_stopped(deadline, sink):
+                result['timed_out'] = True
+        if result['class'] == 'error':
+            sink['errors'].append(result['results'].get('msg', 'error') + '\n')
+        return result
+
+    def _wait_stopped(self, deadline: float, sink: Dict[str, Any]) -> bool:
+        """Wait for the inferior to stop; interrupt it (then give up) when the deadline passes"""
+        stopped = lambda rec: rec['type'] == 'exec' and rec['class'] == 'stopped'
+        if self._read_until(stopped, max(0.0, deadline - time.time()), sink):
+            return True
+        logger.info("GDB inferior still running at timeout, interrupting")
+        self._token += 1
+        self.channel.send(f'{self._token}-exec-interrupt --all\n'.encode('utf-8'))
+        if self._read_until(stopped, 5.0, sink):
+            return False
+        # Neither the program nor gdb is responding; the caller restarts the session
+        self.close()
+        return False
+
+    @staticmethod
+    def _new_sink() -> Dict[str, Any]:
+        # Program output can be unbounded (a looping printf); keep only head and tail of it
+        return {'console': [], 'program': BoundedOutput(abort_after=None), 'errors': [], 'stops': []}
+
+    # ===== High-level API =====
+
+    def run(self, commands: str, timeout: float, registers: bool = True,
+            memory: Optional[Dict[str, Any]] = None) -> Dict[str, Any]:
+        """Run newline-separated gdb console commands and return text plus structured state"""
+        sink = self._new_sink()
+        deadline = time.time() + timeout
+        timed_out = False
+        errored = False
+        for line in [c.strip() for c in commands.splitlines()]:
+            if not line or line.startswith('#'):
+                continue
+            if self.channel.closed:
+                break
+            m = _RUN_RE.match(line)
+            if m and '<' not in (m.group(2) or ''):
+                line = f'{line} < /dev/null'
+            sink['echo'] = line
+            remaining = deadline - time.time()
+            if remaining <= 0:
+                timed_out = True
+                break
+            outcome = self.command(f'-interpreter-exec console {mi_quote(line)}', remaining, sink)
+            if outcome['timed_out']:
+                timed_out = True
+                break
+            if outcome['class'] == 'error':
+                errored = True
+                break
+
+        structured: Dict[str, Any] = {
+            'state': self.state,
+            'breakpoints': list(self.breakpoints.values()),
+        }
+        if sink['stops']:
+            structured['stopped'] = sink['stops'][-1]
+        elif self.state == 'stopped' and self.last_stop:
+            structured['stopped'] = self.last_stop
+        if self.alive and self.state == 'stopped' and not timed_out:
+            if registers:
+                regs = self.read_registers()
+                if regs:
+                    structured['registers'] = regs
+            if memory:
+                structured['memory'] = self.read_memory(str(memory.get('address', '')),
+                                                        int(memory.get('length') or 64))
+        return {
+            'console': ''.join(sink['console']),
+            'program_output': sink['program'].getvalue(),
+            'errors': ''.join(sink['errors']),
+            'timed_out': timed_out,
+            'error': errored,
+            'gdb': structured,
+        }
+
+    def read_registers(self, names: Optional[List[str]] = None) -> Dict[str, str]:
+        """Return {register: hex value} for the selected frame"""
+        if self._register_names is None:
+            listed = self.command('-data-list-register-names', timeout=10)
+            self._register_names = listed['results'].get('register-names', []) if listed['class'] == 'done' else []
+        wanted = set(names or DEFAULT_REGISTERS)
+        numbers = [str(i) for i, name in enumerate(self._register_names) if name in wanted]
+        if not numbers:
+            return {}
+        values = self.command(f'-data-list-register-values --skip-unavailable x {" ".join(numbers)}', timeout=10)
+        regs: Dict[str, str] = {}
+        for entry in values['results'].get('register-values', []) if values['class'] == 'done' else []:
+            try:
+                regs[self._register_names[int(entry['number'])]] = entry['value']
+            except (KeyError, IndexError, ValueError, TypeError):
+                continue
+        return regs
+
+    def read_memory(self, address: str, length: int) -> Dict[str, Any]:
+        """Read raw bytes from the inferior: {address, length, hex} or {error}"""
+        length = max(1, min(length, 65536))
+        reply = self.command(f'-data-read-memory-bytes {mi_quote(address)} {length}', timeout=10)
+        if reply['class'] != 'done':
+            return {'address': address, 'error': reply['results'].get('msg', 'read failed')}
+        blocks = reply['results'].get('memory') or []
+        if not blocks:
+            return {'address': address, 'error': 'no memory returned'}
+        return {
+            'address': blocks[0].get('begin'),
+            'length': sum(len(b.get('contents', '')) // 2 for b in blocks),
+            'hex': ''.join(b.get('contents', '') for b in blocks),
+        }
+
+    def close(self) -> None:
+        if not self.channel.closed:
+            try:
+                self.channel.send(b'-gdb-exit\n')
+            except SessionClosed:
+                pass
+        self.channel.close()
@@ -0,0 +1,182 @@
+"""
+Detached long-running jobs (cracking, angr exploration, brute force) inside the backend
+
+A job is a bash command started in its own session under `timeout`, `nice` and a
+virtual-memory cap, with stdout+stderr going to a file under JOBS_DIR; its exit code is
+written next to it when it ends. Killing signals the whole session (`timeout` moves the
+command into a process group of its own, so the launcher's group is not enough). Starting returns immediately, and the agent polls
+status and output on later steps, so a step never blocks on a job. All state
+lives in files inside the backend, so polling is a couple of short commands.
+"""
+import logging
+import shlex
+import time
+from typing import Any, Dict, List, Optional
+
+from ctf_solver.config import JOB_MAX_CONCURRENT, JOB_MAX_SECONDS, JOB_MEMORY_MB
+
+
+logger = logging.getLogger(__name__)
+
+JOBS_DIR = '/tmp/flaggy/jobs'
+DEFAULT_TAIL = 4000
+
+
+class JobManager:
+    """Jobs of one attempt; every public method returns a step result dict (tool = the job action)"""
+
+    def __init__(self, backend, env_setup: str):
+        self.backend = backend
+        self.env_setup = env_setup
+        self.jobs: Dict[str, Dict[str, Any]] = {}
+        # Local sandboxes share the host's /tmp, so each backend gets its own directory
+        self.dir = f"{JOBS_DIR}/{backend.container_name}"
+        self._next_id = 0
+
+    # ===== Actions =====
+
+    def start(self, cmd: str, cwd: str, timeout_seconds: Optional[int] = None,
+              memory_mb: Optional[int] = None, name: Optional[str] = None) -> Dict[str, Any]:
+        if not cmd.strip():
+            return self._error('start_job', "No command provided")
+        running = [job_id for job_id, job in self.jobs.items() if job['status'] == 'running']
+        if running:
+            self._refresh(running)
+            running = [job_id for job_id in running if self.jobs[job_id]['status'] == 'running']
+        if len(running) >= JOB_MAX_CONCURRENT:
+            return self._error('start_job', f"{len(running)} jobs already running ({', '.join(running)}); "
+                                            f"wait for one or kill_job it first")
+        wall = min(timeout_seconds or JOB_MAX_SECONDS, JOB_MAX_SECONDS)
+        memory_kb = (memory_mb or JOB_MEMORY_MB) * 1024
+        self._next_id += 1
+        job_id = f"job{self._next_id}"
+        base = f"{self.dir}/{job_id}"
+        inner = (f"echo $$ > {base}.pid; ulimit -v {memory_kb} 2>/dev/null; "
+                 f"timeout -k 5 {wall} nice -n 10 bash -c {shlex.quote(f'{self.env_setup} && {cmd}')} "
+                 f"> {base}.out 2>&1 < /dev/null; echo $? > {base}.rc")
+        launcher = (f"mkdir -p {self.dir} && rm -f {base}.* && cd {shlex.quote(cwd)} && "
+                    f"{{ setsid bash -c {shlex.quote(inner)} > /dev/null 2>&1 < /dev/null & }}")
+        exit_code, output = self.backend.run_command(['bash', '-c', launcher])
+        if exit_code != 0:
+            return self._error('start_job', f"Failed to start job: {output.decode('utf-8', errors='replace')}")
+        self.jobs[job_id] = {'id': job_id, 'name': name or cmd[:80], 'cmd': cmd, 'cwd': cwd,
+                             'status': 'running', 'exit_code': None, 'started': time.time(),
+                             'finished': None, 'limit_seconds': wall, 'output_bytes': 0, 'read_offset': 0}
+        logger.info(f"Started {job_id}: {cmd[:120]}")
+        return self._result('start_job', f"Started {job_id} (limit {wall}s, {memory_kb // 1024} MB); "
+                                         f"poll it with job_status / job_output.", job_id)
+
+    def status(self, job_id: Optional[str] = None) -> Dict[str, Any]:
+        ids = [job_id] if job_id else list(self.jobs)
+        unknown = [i for i in ids if i not in self.jobs]
+        if unknown:
+            return self._error('job_status', f"Unknown job {unknown[0]} (known: {', '.join(self.jobs) or 'none'})")
+        if not ids:
+            return self._result('job_status', "No jobs started in this attempt.")
+        self._refresh(ids)
+        lines = [self._describe(self.jobs[i]) for i in ids]
+        return self._result('job_status', '\n'.join(lines), job_id)
+
+    def output(self, job_id: str, offset: Optional[int] = None, max_bytes: Optional[int] = None,
+               tail: Optional[int] = None) -> Dict[str, Any]:
+        """Incremental by default (continues where the last call stopped); `offset` re-reads, `tail` shows the end"""
+        job = self.jobs.get(job_id or '')
+        if job is None:
+            return self._error('job_output', f"Unknown job {job_id} (known: {', '.join(self.jobs) or 'none'})")
+        self._refresh([job_id])
+        size = job['output_bytes']
+        max_bytes = max_bytes or DEFAULT_TAIL * 4
+        if tail:
+            start = max(0, size - tail)
+        elif offset is not None:
+            start = max(0, min(offset, size))
+        else:
+            start = job['read_offset']
+        data = self._read(f"{self.dir}/{job_id}.out", start, max_bytes)
+        end = start + len(data)
+        job['read_offset'] = max(job['read_offset'], end)
+        header = f"[{job_id} {job['status']}; bytes {start}-{end} of {size}"
+        header += f"; {size - end} more, call job_output again]" if end < size else "]"
+        return self._result('job_output', f"{header}\n{data.decode('utf-8', errors='replace')}", job_id)
+
+    def kill(self, job_id: str) -> Dict[str, Any]:
+        job = self.jobs.get(job_id or '')
+        if job is None:
+            return self._error('kill_job', f"Unknown job {job_id}")
+        self._signal([job_id])
+        self._refresh([job_id])
+        return self._result('kill_job', f"Sent SIGTERM/SIGKILL to {job_id}.\n{self._describe(job)}", job_id)
+
+    def cleanup(self) -> None:
+        """Kill whatever is still running (end of attempt)"""
+        running = [job_id for job_id, job in self.jobs.items() if job['status'] == 'running']
+        if running:
+            try:
+                self._signal(running)
+            except Exception as e:
+                logger.debug(f"Failed to kill jobs {running}: {e}")
+
+    def summary(self) -> List[Dict[str, Any]]:
+        return [{k: job[k] for k in ('id', 'name', 'status', 'exit_code', 'output_bytes')} for job in self.jobs.values()]
+
+    # ===== Backend state =====
+
+    def _refresh(self, ids: List[str]) -> None:
+        """One command reports state, exit code and output size for each job"""
+        probe = '; '.join(
+            f'echo {i} $(cat {self.dir}/{i}.rc 2>/dev/null || echo -) $(stat -c %s {self.dir}/{i}.out 2>/dev/null || echo 0)'
+            f' $(p=$(cat {self.dir}/{i}.pid 2>/dev/null); [ -n "$p" ] && pgrep -s $p > /dev/null && echo alive || echo gone)'
+            for i in ids)
+        _, output = self.backend.run_command(['bash', '-c', probe])
+        for line in output.decode('utf-8', errors='replace').splitlines():
+            parts = line.split()
+            if len(parts) != 4 or parts[0] not in self.jobs:
+                continue
+            job = self.jobs[parts[0]]
+            job['output_bytes'] = int(parts[2]) if parts[2].isdigit() else job['output_bytes']
+            if job['status'] != 'running':
+                continue
+            if parts[1] != '-':
+                code = int(parts[1])
+                job['exit_code'] = code
+                job['status'] = 'timed_out' if code in (124, 137) else ('done' if code == 0 else 'failed')
+                job['finished'] = time.time()
+            elif parts[3] == 'gone' and time.time() - job['started'] > 5:
+                job['status'] = 'killed'
+                job['finished'] = time.time()
+
+    def _signal(self, ids: List[str]) -> None:
+        # Only sessions with a pid file: an empty `pkill -s` list would mean pkill's own session
+        pids = ' '.join(f'{self.dir}/{i}.pid' for i in ids)
+        self.backend.run_command(['bash', '-c', f's=$(cat {pids} 2>/dev/null | paste -sd,); '
+                                                f'[ -n "$s" ] && {{ pkill -TERM -s $s; sleep 1; pkill -KILL -s $s; }}; true'])
+        for i in ids:
+            if self.jobs[i]['status'] == 'running':
+                self.jobs[i].update(status='killed', finished=time.time())
+
+    def _read(self, path: str, start: int, length: int) -> bytes:
+        _, output = self.backend.run_command(['bash', '-c', f'tail -c +{start + 1} {path} 2>/dev/null | head -c {length}'])
+        return output
+
+    # ===== Results =====
+
+    @staticmethod
+    def _describe(job: Dict[str, Any]) -> str:
+        elapsed = (job['finished'] or time.time()) - job['started']
+        code = '' if job['exit_code'] is None else f", exit {job['exit_code']}"
+        unread = job['output_bytes'] - job['read_offset']
+        return (f"{job['id']} [{job['status']}{code}] {elapsed:.0f}s, output {job['output_bytes']} bytes"
+                f" ({unread} unread): {job['name']}")
+
+    def _result(self, tool: str, text: str, job_id: Optional[str] = None) -> Dict[str, Any]:
+        result: Dict[str, Any] = {"stdout": text + '\n', "stderr": "", "exit_code": 0, "tool": tool,
+                                  "cwd": self.backend.cwd}
+        if job_id in self.jobs:
+            job = self.jobs[job_id]
+            result['job'] = {k: job[k] for k in ('id', 'status', 'exit_code', 'output_bytes', 'limit_seconds')}
+            result['job']['elapsed_s'] = round((job['finished'] or time.time()) - job['started'], 1)
+        return result
+
+    def _error(self, tool: str, message: str) -> Dict[str, Any]:
+        return {"error": message, "stdout": "", "stderr": message, "exit_code": 1, "tool": tool,
+                "cwd": self.backend.cwd}
@@ -0,0 +1,432 @@
+"""
+Lightweight local sandbox backend
+
+Runs an attempt's processes directly on the host under process isolation instead of
+in an Exegol container, so cheap challenges (file/strings/objdump-level work) and test
+runs start in milliseconds. FLAGGY_LOCAL_SANDBOX picks the isolation:
+
+- bwrap (what 'auto' resolves to): read-only view of the host's tool directories
+  (/usr, /etc, /opt, ... and FLAGGY_LOCAL_SANDBOX_BINDS), the attempt workspace bound
+  read-write at /challenge and a private per-attempt /tmp, and its own PID, IPC and UTS
+  namespaces and session. One PID namespace is shared by all of an attempt's commands
+  (held open by a sleeping bwrap), so detached jobs and interrupts can still find their
+  processes while host processes stay invisible. 'auto' refuses to start without bwrap.
+- unshare: separate IPC/UTS namespaces only; the workspace is used at its host path.
+  Opt-in only: commands can still read and write the rest of the host.
+- none: plain subprocesses (for test suites); opt-in only.
+
+In every mode read_file/write_file (get_file/put_file) are confined to the workspace
+and the attempt's private tmp directory, and commands start from a fresh environment
+(PATH and locale from the host, HOME/TMPDIR in the private tmp) so secrets loaded into
+flaggy's own environment never reach them.
+
+Only tools installed on the host are available; use the Exegol backend for anything
+that needs the full pentest toolbox.
+"""
+import hashlib
+import json
+import logging
+import os
+import platform
+import select
+import selectors
+import shutil
+import signal
+import subprocess
+import tempfile
+import time
+from typing import Any, Dict, List, Optional, Tuple
+
+from ctf_solver.config import LOCAL_SANDBOX, LOCAL_SANDBOX_BINDS
+from ctf_solver.containers.base import ENV_SETUP, ExecutionBackend
+from ctf_solver.containers.output import BoundedOutput
+from ctf_solver.containers.session import STDERR, STDOUT, SessionClosed
+
+
+logger = logging.getLogger(__name__)
+
+WORKSPACE_DIR = '/challenge'
+
+
+SANDBOX_MODES = ('bwrap', 'unshare', 'none')
+
+# Host variables agent commands may see; the rest (API keys and DSNs that config.py loads
+# from .env into os.environ) never reaches them
+PASSTHROUGH_ENV = ('PATH', 'LANG', 'LC_ALL', 'TZ')
+
+# Host paths bwrap binds read-only: tools, their libraries and system configuration
+SANDBOX_RO_PATHS = ('/usr', '/bin', '/sbin', '/lib', '/lib32', '/lib64', '/libx32', '/etc', '/opt')
+HOLDER_START_TIMEOUT = 10
+
+
+def detect_sandbox(preferred: str = LOCAL_SANDBOX) -> str:
+    """Resolve 'auto' to bwrap; weaker isolation is only used when asked for by name"""
+    if preferred == 'auto':
+        if shutil.which('bwrap'):
+            return 'bwrap'
+        raise RuntimeError("The local backend needs bubblewrap (bwrap) to isolate commands; install it, "
+                           "or set FLAGGY_LOCAL_SANDBOX=unshare or none to run them unisolated on the host")
+    if preferred not in SANDBOX_MODES:
+        raise ValueError(f"Unknown FLAGGY_LOCAL_SANDBOX '{preferred}' (expected auto, {', '.join(SANDBOX_MODES)})")
+    if preferred != 'bwrap':
+        logger.warning(f"Local sandbox '{preferred}': agent commands run with full access to the host filesystem")
+    return preferred
+
+
+class LocalChannel:
+    """ExecChannel equivalent for a host subprocess: stdin pipe in, (stream, bytes) frames out"""
+
+    def __init__(self, argv: List[str], environment: Optional[Dict[str, str]] = None,
+                 workdir: Optional[str] = None, pass_fds: Tuple[int, ...] = ()):
+        # environment is the process's whole environment, nothing is inherited from ours
+        self.proc = subprocess.Popen(
+            argv, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+            cwd=workdir, env=dict(environment or {}), start_new_session=True, pass_fds=pass_fds,
+        )
+        self._selector = selectors.DefaultSelector()
+        self._selector.register(self.proc.stdout, selectors.EVENT_READ, STDOUT)
+        self._selector.register(self.proc.stderr, selectors.EVENT_READ, STDERR)
+        self._open_streams = 2
+        self.closed = False
+
+    def send(self, data: bytes) -> None:
+        if self.closed:
+            raise SessionClosed("channel is closed")
+        try:
+            self.proc.stdin.write(data)
+            self.proc.stdin.flush()
+        except (BrokenPipeError, OSError) as e:
+            self.closed = True
+            raise SessionClosed(str(e))
+
+    def read_frame(self, timeout: Optional[float]) -> Optional[Tuple[int, bytes]]:
+        if self.closed:
+            raise SessionClosed("channel is closed")
+        for key, _ in self._selector.select(timeout):
+            data = os.read(key.fileobj.fileno(), 65536)
+            if data:
+                return key.data, data
+            self._selector.unregister(key.fileobj)
+            self._open_streams -= 1
+            if self._open_streams == 0:
+                self.closed = True
+                raise SessionClosed("process exited")
+        return None
+
+    def pid(self) -> Optional[int]:
+        return self.proc.pid
+
+    def exit_code(self) -> Optional[int]:
+        try:
+            return self.proc.wait(timeout=1)
+        except subprocess.TimeoutExpired:
+            return None
+
+    def close(self) -> None:
+        self.closed = True
+        try:
+            os.killpg(self.proc.pid, signal.SIGKILL)
+        except (ProcessLookupError, PermissionError):
+            pass
+        for stream in (self.proc.stdin, self.proc.stdout, self.proc.stderr):
+            try:
+                stream.close()
+            except Exception:
+                pass
+        try:
+            self.proc.wait(timeout=5)
+        except subprocess.TimeoutExpired:
+            pass
+        self._selector.close()
+
+
+class LocalSandbox(ExecutionBackend):
+    def __init__(self, container_name: str, mounts: Optional[Dict[str, str]] = None,
+                 flag_format: Optional[str] = None, sandbox: str = LOCAL_SANDBOX):
+        super().__init__(container_name, cwd=WORKSPACE_DIR, flag_format=flag_format)
+        self.mounts = mounts or {}  # host_path -> sandbox path, same shape as ExegolContainer
+        self.sandbox = detect_sandbox(sandbox)
+        self._workspace: Optional[str] = None
+        self._owns_workspace = False
+        self._tmp: Optional[str] = None
+        self._channels: List[LocalChannel] = []
+        self._running = False
+        # bwrap only: process keeping the attempt's PID namespace alive, and namespace fds to join
+        self._holder: Optional[subprocess.Popen] = None
+        self._ns_fds: Dict[str, int] = {}
+
+    def start(self) -> bool:
+        """Prepare the workspace and private /tmp (and, under bwrap, the attempt's PID namespace)"""
+        try:
+            if self.sandbox == 'bwrap' and not shutil.which('bwrap'):
+                raise RuntimeError("bwrap not found")
+            self._workspace = self.workspace_path()
+            if self._workspace is None:
+                self._workspace = tempfile.mkdtemp(prefix=f'{self.container_name}_ws_')
+                self._owns_workspace = True
+            self._tmp = tempfile.mkdtemp(prefix=f'{self.container_name}_tmp_')
+            # Without a mount namespace the workspace and tmp keep their host paths
+            self.cwd = WORKSPACE_DIR if self.sandbox == 'bwrap' else self._workspace
+            self.tmp_dir = '/tmp' if self.sandbox == 'bwrap' else self._tmp
+            if self.sandbox == 'bwrap':
+                self._start_holder()
+            self._running = True
+            logger.info(f"Local sandbox {self.container_name} ready ({self.sandbox}, workspace {self._workspace})")
+            return True
+        except Exception as e:
+            logger.error(f"Failed to start local sandbox {self.container_name}: {e}")
+            return False
+
+    def stop(self) -> bool:
+        self._close_sessions()
+        for channel in self._channels:
+            channel.close()
+        self._channels.clear()
+        self._stop_holder()
+        if self._tmp:
+            shutil.rmtree(self._tmp, ignore_errors=True)
+            self._tmp = None
+        if self._owns_workspace and self._workspace:
+            shutil.rmtree(self._workspace, ignore_errors=True)
+        self._running = False
+        return True
+
+    def is_running(self) -> bool:
+        return self._running
+
+    def workspace_path(self) -> Optional[str]:
+        for host_path, sandbox_path in self.mounts.items():
+            if sandbox_path == WORKSPACE_DIR:
+                return host_path
+        return self._workspace
+
+    def environment_id(self) -> str:
+        # Host tools are what runs, so the host identifies the toolchain
+        return f'local:{platform.node()}:{platform.release()}'
+
+    def list_files(self, directory: str) -> Dict[str, Tuple[int, int]]:
+        try:
+            entries = list(os.scandir(self._confined_path(directory)))
+        except OSError:
+            return {}
+        files = {}
+        for entry in entries:
+            try:
+                if entry.is_file():
+                    st = entry.stat()
+                    files[entry.name] = (st.st_size, st.st_mtime_ns)
+            except OSError:
+                continue
+        return files
+
+    def hash_files(self, paths: List[str]) -> Dict[str, str]:
+        digests = {}
+        for path in paths:
+            try:
+                host_path = self._confined_path(path)
+            except PermissionError:
+                continue
+            if not os.path.isfile(host_path):
+                continue
+            h = hashlib.sha256()
+            with open(host_path, 'rb') as f:
+                for chunk in iter(lambda: f.read(1 << 20), b''):
+                    h.update(chunk)
+            digests[path] = h.hexdigest()
+        return digests
+
+    # ===== Process plumbing =====
+
+    @staticmethod
+    def _system_binds() -> List[str]:
+        args = []
+        for path in SANDBOX_RO_PATHS + tuple(LOCAL_SANDBOX_BINDS):
+            if os.path.islink(path):
+                # Merged-/usr hosts: /bin -> usr/bin and friends
+                args += ['--symlink', os.readlink(path), path]
+            elif os.path.exists(path):
+                args += ['--ro-bind', path, path]
+        return args
+
+    def _start_holder(self) -> None:
+        """Start a sleeping bwrap that owns the attempt's PID namespace; commands join it"""
+        info_r, info_w = os.pipe()
+        try:
+            self._holder = subprocess.Popen(
+                ['bwrap', '--die-with-parent', '--unshare-pid', '--new-session', '--clearenv',
+                 '--info-fd', str(info_w), *self._system_binds(), '--proc', '/proc', '--dev', '/dev',
+                 '--', 'sleep', 'infinity'],
+                stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE,
+                env={'PATH': os.environ.get('PATH', os.defpath)}, pass_fds=(info_w,),
+            )
+            os.close(info_w)
+            info_w = -1
+            # Read up to the end of the JSON object: the sandboxed child may keep the fd open
+            info = b''
+            deadline = time.time() + HOLDER_START_TIMEOUT
+            while b'}' not in info:
+                ready, _, _ = select.select([info_r], [], [], max(0.0, deadline - time.time()))
+                chunk = os.read(info_r, 4096) if ready else b''
+                if not chunk:
+                    break
+                info += chunk
+        finally:
+            for fd in (info_r, info_w):
+                if fd >= 0:
+                    os.close(fd)
+        try:
+            pid = json.loads(info)['child-pid']
+        except (ValueError, KeyError):
+            error = self._holder.stderr.read().decode(errors='replace').strip() if self._holder.poll() is not None else ''
+            self._stop_holder()
+            raise RuntimeError(f"bwrap could not create the sandbox: {error or 'no child pid reported'}")
+        self._ns_fds['pid'] = os.open(f'/proc/{pid}/ns/pid', os.O_RDONLY)
+        # Unprivileged bwrap also made a user namespace; the PID namespace can only be joined from inside it
+        if os.stat(f'/proc/{pid}/ns/user').st_ino != os.stat('/proc/self/ns/user').st_ino:
+            self._ns_fds['user'] = os.open(f'/proc/{pid}/ns/user', os.O_RDONLY)
+
+    def _stop_holder(self) -> None:
+        for fd in self._ns_fds.values():
+            os.close(fd)
+        self._ns_fds.clear()
+        if self._holder is not None:
+            # The namespace's init dies with the holder, taking every process left in it along
+            self._holder.kill()
+            self._holder.wait()
+            self._holder = None
+
+    def _pass_fds(self) -> Tuple[int, ...]:
+        return tuple(self._ns_fds.values())
+
+    def _wrap(self, argv: List[str], workdir: Optional[str] = None,
+              env: Optional[Dict[str, str]] = None) -> List[str]:
+        workdir = workdir or self.cwd
+        if self.sandbox == 'bwrap':
+            setenv = [arg for key, value in (env or {}).items() for arg in ('--setenv', key, value)]
+            namespaces = []
+            if 'user' in self._ns_fds:
+                namespaces += ['--userns', str(self._ns_fds['user'])]
+            if 'pid' in self._ns_fds:
+                namespaces += ['--pidns', str(self._ns_fds['pid'])]
+            return [
+                'bwrap', '--die-with-parent', '--new-session', '--clearenv', *setenv, *namespaces,
+                *self._system_binds(),
+                '--proc', '/proc', '--dev', '/dev',
+                '--bind', self._workspace, WORKSPACE_DIR,
+                '--bind', self._tmp, '/tmp',
+                '--unshare-ipc', '--unshare-uts', '--chdir', workdir, '--',
+            ] + argv
+        if self.sandbox == 'unshare':
+            return ['unshare', '--ipc', '--uts', '--kill-child', '--'] + argv
+        return argv
+
+    def _env(self, environment: Optional[Dict[str, str]] = None) -> Dict[str, str]:
+        """Complete environment for a sandboxed process, built from scratch"""
+        env = {key: os.environ[key] for key in PASSTHROUGH_ENV if key in os.environ}
+        env.setdefault('PATH', os.defpath)
+        env['TMPDIR'] = env['HOME'] = self.tmp_dir
+        env.update(environment or {})
+        return env
+
+    def open_channel(self, cmd: List[str], environment: Optional[Dict[str, str]] = None,
+                     workdir: Optional[str] = None) -> LocalChannel:
+        env = self._env(environment)
+        channel = LocalChannel(self._wrap(cmd, workdir, env), env,
+                               workdir=None if self.sandbox == 'bwrap' else (workdir or self.cwd),
+                               pass_fds=self._pass_fds())
+        self._channels = [c for c in self._channels if not c.closed] + [channel]
+        return channel
+
+    def run_command(self, cmd: List[str]) -> Tuple[int, bytes]:
+        env = self._env()
+        result = subprocess.run(
+            self._wrap(cmd, env=env), stdout=subprocess.PIPE, stderr=subprocess.STDOUT, env=env,
+            pass_fds=self._pass_fds(),
+            cwd=None if self.sandbox == 'bwrap' else self.cwd, timeout=60,
+        )
+        return result.returncode, result.stdout
+
+    def _execute_oneshot(self, cmd: str, timeout_seconds: int, track_cwd: bool = True) -> Dict[str, Any]:
+        """Run a bash command as a fresh sandboxed process, streaming into a bounded buffer"""
+        cwd = self.cwd
+        try:
+            env = self._env()
+            channel = LocalChannel(
+                self._wrap(['bash', '-c', f'{ENV_SETUP} && cd {cwd} && {cmd}'], env=env), env,
+                workdir=None if self.sandbox == 'bwrap' else cwd, pass_fds=self._pass_fds(),
+            )
+            channel.proc.stdin.close()
+            sink = BoundedOutput(flag_format=self.flag_format)
+            deadline = time.time() + timeout_seconds
+            timed_out = False
+            try:
+                while True:
+                    remaining = deadline - time.time()
+                    if remaining <= 0:
+                        timed_out = True
+                        break
+                    frame = channel.read_frame(timeout=min(0.5, remaining))
+                    if frame is not None and not sink.write(frame[1]):
+                        break
+            except SessionClosed:
+                pass
+            exit_code = channel.exit_code()
+            channel.close()
+            if timed_out or exit_code is None:
+                exit_code = 124 if timed_out else -signal.SIGKILL
+
+            if track_cwd:
+                new_cwd = self._extract_new_dir(cmd)
+                if new_cwd and self._validate_directory(new_cwd):
+                    self.cwd = cwd = new_cwd
+            return {
+                "stdout": sink.getvalue(),
+                "stderr": self._stream_note(sink, timeout_seconds, timed_out),
+                "cwd": cwd,
+                "exit_code": exit_code,
+                "tool": "bash",
+                "timed_out": timed_out,
+                "output_meta": sink.meta()
+            }
+        except Exception as e:
+            logger.error(f"Command execution failed: {e}")
+            return {"error": str(e), "cwd": self.cwd}
+
+    # ===== Files =====
+
+    def _host_path(self, path: str) -> str:
+        """Map a path as seen inside the sandbox to the host filesystem"""
+        target = self._resolve_path(path)
+        # Paths under /challenge are accepted in every mode so prompts can stay backend-agnostic
+        mapping = [(WORKSPACE_DIR, self._workspace)]
+        if self.sandbox == 'bwrap':
+            mapping.append(('/tmp', self._tmp))
+        for inside, outside in mapping:
+            if target == inside or target.startswith(inside + '/'):
+                return outside + target[len(inside):]
+        return target
+
+    def _confined_path(self, path: str) -> str:
+        """Host path for file IO, refused (symlinks resolved) unless under the workspace or private tmp"""
+        target = os.path.realpath(self._host_path(path))
+        for root in (self._workspace, self._tmp):
+            root = os.path.realpath(root) if root else None
+            if root and (target == root or target.startswith(root + '/')):
+                return target
+        raise PermissionError(f"{path} is outside the workspace and tmp of the local sandbox")
+
+    def put_file(self, path: str, data: bytes, mode: int = 0o644) -> None:
+        target = self._confined_path(path)
+        with open(target, 'wb') as f:
+            f.write(data)
+        os.chmod(target, mode)
+
+    def get_file(self, path: str, offset: int = 0, length: Optional[int] = None) -> tuple:
+        target = self._confined_path(path)
+        if os.path.isdir(target):
+            raise IsADirectoryError(path)
+        with open(target, 'rb') as f:
+            size = os.fstat(f.fileno()).st_size
+            f.seek(offset)
+            data = f.read() if length is None else f.read(length)
+        return data, size
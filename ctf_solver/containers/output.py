@@ -0,0 +1,112 @@
+"""
+Bounded capture of command output
+
+Commands like `strings` over a static archive can print hundreds of megabytes. Output
+is consumed as it streams from the exec socket and only a fixed-size head and tail
+are retained, together with any flags seen in between (as printed or base64/hex/
+reversed/URL-encoded), so memory stays bounded and the step still returns something useful.
+"""
+from collections import deque
+from typing import Deque, List, Optional
+
+from ctf_solver.analysis.flags import FlagMatcher
+from ctf_solver.config import MAX_OUTPUT_CHARS, MAX_STREAM_BYTES
+
+
+class BoundedOutput:
+    """Keeps the first head_bytes and last tail_bytes of a byte stream.
+
+    feed() returns False once more than abort_after bytes have been produced, which
+    tells the producer to stop the command; later data is only counted.
+    """
+
+    def __init__(self, head_bytes: Optional[int] = None, tail_bytes: Optional[int] = None,
+                 flag_format: Optional[str] = None, abort_after: Optional[int] = MAX_STREAM_BYTES):
+        if head_bytes is None:
+            head_bytes = MAX_OUTPUT_CHARS * 2 // 3
+        if tail_bytes is None:
+            tail_bytes = MAX_OUTPUT_CHARS - head_bytes
+        self.head_bytes = head_bytes
+        self.tail_bytes = tail_bytes
+        self.abort_after = abort_after if abort_after and abort_after > 0 else None
+        self.total_bytes = 0
+        self.aborted = False
+        self._head = bytearray()
+        self._tail: Deque[bytes] = deque()
+        self._tail_len = 0
+        self._flags = FlagMatcher.for_format(flag_format).stream() if flag_format else None
+
+    @property
+    def truncated(self) -> bool:
+        return self.total_bytes > len(self._head) + self._tail_len
+
+    def feed(self, data: bytes) -> bool:
+        if not data:
+            return not self.aborted
+        self.total_bytes += len(data)
+        if self.aborted:
+            return False
+
+        if len(self._head) < self.head_bytes:
+            take = self.head_bytes - len(self._head)
+            self._head.extend(data[:take])
+            data = data[take:]
+        if data and self.tail_bytes > 0:
+            self._tail.append(data)
+            self._tail_len += len(data)
+            # Drop whole chunks that fell out of the tail window, then trim the oldest one
+            while self._tail and self._tail_len - len(self._tail[0]) >= self.tail_bytes:
+                self._tail_len -= len(self._tail.popleft())
+            excess = self._tail_len - self.tail_bytes
+            if excess > 0:
+                self._tail[0] = self._tail[0][excess:]
+                self._tail_len -= excess
+
+        if self.abort_after is not None and self.total_bytes > self.abort_after:
+            self.aborted = True
+            return False
+        return True
+
+    def scan_flags(self, data: bytes) -> None:
+        """Look for flags in data (the whole stream must pass through here)"""
+        if self._flags is not None:
+            self._flags.feed(data)
+
+    @property
+    def flag_matches(self) -> List[str]:
+        """Flags seen so far; decoded ones say how they were encoded"""
+        if self._flags is None:
+            return []
+        return [flag if kind in ('plain', 'indicator') else f"{flag} (decoded from {kind})"
+                for flag, kind in self._flags.results()]
+
+    def write(self, data: bytes) -> bool:
+        """feed() plus flag scanning; the usual entry point for producers"""
+        self.scan_flags(data)
+        return self.feed(data)
+
+    def getvalue(self) -> str:
+        """Head and tail joined by an omission marker (plus flag matches from the omitted part)"""
+        head = bytes(self._head)
+        tail = b''.join(self._tail)
+        if not self.truncated:
+            return (head + tail).decode('utf-8', errors='replace')
+        omitted = self.total_bytes - len(head) - len(tail)
+        note = f"\n\n[... {omitted:,} bytes omitted; {self.total_bytes:,} bytes produced in total"
+        if self.aborted:
+            note += f", command stopped after {self.abort_after:,} bytes"
+        note += " ...]\n"
+        kept = head.decode('utf-8', errors='replace') + tail.decode('utf-8', errors='replace')
+        hidden = [f for f in self.flag_matches if f not in kept]
+        if hidden:
+            note += "[flags in omitted output: " + ", ".join(hidden) + "]\n"
+        note += "\n"
+        return head.decode('utf-8', errors='replace') + note + tail.decode('utf-8', errors='replace')
+
+    def meta(self) -> dict:
+        return {
+            'total_bytes': self.total_bytes,
+            'truncated': self.truncated,
+            'aborted': self.aborted,
+            'flag_matches': list(self.flag_matches),
+        }
@@ -0,0 +1,254 @@
+"""
+Warm pool of pre-started Exegol containers
+
+Starting an Exegol container (image check, create, readiness wait) takes seconds,
+which dominates short solves when many attempts are queued. The pool keeps a few
+idle containers running; an attempt takes one, gets its workspace copied in, and
+hands it back afterwards to be reset (or replaced once it has served too many
+attempts).
+"""
+import itertools
+import logging
+import threading
+import time
+from collections import deque
+from typing import Any, Deque, Dict, List, Optional
+
+import docker
+
+from ctf_solver.config import CONTAINER_POOL_MAX_USES, CONTAINER_POOL_SIZE
+from ctf_solver.containers.archive import extract_archive, tar_directory
+from ctf_solver.containers.exegol import DEFAULT_IMAGE, remove_named_containers, run_exegol_container
+
+
+logger = logging.getLogger(__name__)
+
+WORKSPACE_DIR = '/challenge'
+
+# Kill everything except PID 1 (the idle loop) and this shell, then wipe scratch areas
+RESET_SCRIPT = (
+    'for p in /proc/[0-9]*; do pid=${p#/proc/}; '
+    '[ "$pid" -ne 1 ] && [ "$pid" -ne $$ ] && kill -9 "$pid" 2>/dev/null; done; '
+    f'rm -rf {WORKSPACE_DIR}/* {WORKSPACE_DIR}/.[!.]* {WORKSPACE_DIR}/..?* /tmp/* /tmp/.[!.]* 2>/dev/null; '
+    f'test -d {WORKSPACE_DIR}'
+)
+
+
+class ContainerPool:
+    def __init__(self, size: int = CONTAINER_POOL_SIZE, image: str = DEFAULT_IMAGE,
+                 max_uses: int = CONTAINER_POOL_MAX_USES, name_prefix: str = 'flaggy_pool'):
+        self.size = max(0, size)
+        self.image = image
+        self.max_uses = max(1, max_uses)
+        self.name_prefix = name_prefix
+        self.client = docker.from_env()
+
+        self._cond = threading.Condition()
+        self._idle: Deque[Any] = deque()
+        self._uses: Dict[str, int] = {}  # container id -> attempts served
+        self._in_use = 0
+        self._starting = 0
+        self._names = itertools.count()
+        self._shutdown = False
+        self._replenisher: Optional[threading.Thread] = None
+
+        # Metrics
+        self._hits = 0
+        self._misses = 0
+        self._recycled = 0
+        self._acquire_latencies: Deque[float] = deque(maxlen=500)
+
+    def start(self) -> None:
+        """Start the background thread that keeps `size` idle containers warm"""
+        with self._cond:
+            if self._replenisher is not None:
+                return
+            self._replenisher = threading.Thread(target=self._replenish_loop, name='container-pool', daemon=True)
+            self._replenisher.start()
+        logger.info(f"Container pool started (size={self.size}, image={self.image})")
+
+    def acquire(self, name: str, workspace: Optional[str] = None):
+        """Take a warm container, rename it for the attempt and copy the workspace in"""
+        start = time.time()
+        container = None
+        while container is None:
+            with self._cond:
+                candidate = self._idle.popleft() if self._idle else None
+            if candidate is None:
+                break
+            if self._is_alive(candidate):
+                container = candidate
+            else:
+                self._discard(candidate)
+        with self._cond:
+            if container is not None:
+                self._hits += 1
+            else:
+                self._misses += 1
+            self._in_use += 1
+            self._cond.notify_all()  # Wake the replenisher to refill the slot
+
+        try:
+            if container is None:
+                logger.info(f"Container pool empty, cold-starting container for {name}")
+                container = self._create_container()
+            remove_named_containers(self.client, name)
+            container.rename(name)
+            if workspace:
+                if not container.put_archive(WORKSPACE_DIR, tar_directory(workspace)):
+                    raise RuntimeError(f"Failed to copy workspace {workspace} into {name}")
+        except Exception:
+            with self._cond:
+                self._in_use -= 1
+            if container is not None:
+                self._discard(container)
+            raise
+
+        latency = time.time() - start
+        with self._cond:
+            self._acquire_latencies.append(latency)
+        logger.info(f"Acquired pooled container for {name} in {latency * 1000:.0f}ms")
+        return container
+
+    def release(self, container, workspace: Optional[str] = None) -> None:
+        """Sync the workspace back to the host, then reset the container or retire it"""
+        try:
+            if workspace:
+                stream, _ = container.get_archive(WORKSPACE_DIR)
+                extract_archive(stream, workspace, strip_components=1)
+        except Exception as e:
+            logger.warning(f"Failed to copy workspace back from {container.name}: {e}")
+
+        with self._cond:
+            self._in_use -= 1
+            uses = self._uses.get(container.id, 0) + 1
+            self._uses[container.id] = uses
+            keep = not self._shutdown and uses < self.max_uses and len(self._idle) + self._starting < self.size
+
+        if keep and self._reset(container):
+            with self._cond:
+                self._idle.append(container)
+                self._recycled += 1
+                self._cond.notify_all()
+            return
+        self._discard(container)
+
+    def stats(self) -> Dict[str, Any]:
+        """Pool size, hit/miss counters and acquire latency"""
+        with self._cond:
+            latencies: List[float] = sorted(self._acquire_latencies)
+            total = self._hits + self._misses
+
+            def percentile(p: float) -> Optional[float]:
+                if not latencies:
+                    return None
+                return round(latencies[min(len(latencies) - 1, int(p * len(latencies)))] * 1000, 1)
+
+            return {
+                'size': self.size,
+                'idle': len(self._idle),
+                'starting': self._starting,
+                'in_use': self._in_use,
+                'hits': self._hits,
+                'misses': self._misses,
+                'hit_rate': round(self._hits / total, 3) if total else None,
+                'recycled': self._recycled,
+                'acquire_ms_avg': round(sum(latencies) / len(latencies) * 1000, 1) if latencies else None,
+                'acquire_ms_p50': percentile(0.5),
+                'acquire_ms_p95': percentile(0.95),
+            }
+
+    def shutdown(self) -> None:
+        """Stop replenishing and remove all idle containers"""
+        with self._cond:
+            self._shutdown = True
+            idle = list(self._idle)
+            self._idle.clear()
+            self._cond.notify_all()
+        for container in idle:
+            self._discard(container)
+
+    # ===== Internals =====
+
+    def _replenish_loop(self) -> None:
+        while True:
+            with self._cond:
+                while not self._shutdown and len(self._idle) + self._starting >= self.size:
+                    self._cond.wait()
+                if self._shutdown:
+                    return
+                self._starting += 1
+            container = None
+            try:
+                container = self._create_container()
+            except Exception as e:
+                logger.error(f"Failed to start pooled container: {e}")
+                time.sleep(5)
+            with self._cond:
+                self._starting -= 1
+                if container is not None and not self._shutdown:
+                    self._idle.append(container)
+                    self._cond.notify_all()
+                    container = None
+            if container is not None:
+                self._discard(container)
+
+    def _create_container(self):
+        name = f"{self.name_prefix}_{next(self._names)}_{int(time.time())}"
+        remove_named_containers(self.client, name)
+        return run_exegol_container(self.client, self.image, name, working_dir=WORKSPACE_DIR)
+
+    def _reset(self, container) -> bool:
+        try:
+            result = container.exec_run(['bash', '-c', RESET_SCRIPT], stdout=True, stderr=True)
+            if result.exit_code != 0:
+                logger.warning(f"Reset of {container.name} failed with exit code {result.exit_code}")
+                return False
+            container.rename(f"{self.name_prefix}_{next(self._names)}_{int(time.time())}")
+            return True
+        except Exception as e:
+            logger.warning(f"Failed to reset pooled container {container.name}: {e}")
+            return False
+
+    def _is_alive(self, container) -> bool:
+        try:
+            container.reload()
+            return container.status == 'running'
+        except Exception:
+            return False
+
+    def _discard(self, container) -> None:
+        with self._cond:
+            self._uses.pop(container.id, None)
+        try:
+            container.remove(force=True)
+        except Exception as e:
+            logger.warning(f"Failed to remove pooled container {getattr(container, 'name', '?')}: {e}")
+
+
+_pool: Optional[ContainerPool] = None
+_pool_lock = threading.Lock()
+
+
+def get_container_pool(size: Optional[int] = None) -> Optional[ContainerPool]:
+    """Return the process-wide container pool, creating it on first use.
+
+    Returns None when pooling is disabled (size 0).
+    """
+    global _pool
+    with _pool_lock:
+        if _pool is None:
+            pool_size = CONTAINER_POOL_SIZE if size is None else size
+            if pool_size <= 0:
+                return None
+            _pool = ContainerPool(size=pool_size)
+            _pool.start()
+        return _pool
+
+
+def shutdown_container_pool() -> None:
+    global _pool
+    with _pool_lock:
+        if _pool is not None:
+            _pool.shutdown()
+            _pool = None
@@ -0,0 +1,389 @@
+"""
+Pwn triage: overflow offset, format-string offset and write targets in one call
+
+Shipped into the container next to flaggy_forkserver (stdlib only) and run by the
+`pwntriage` tool. Probes are batched so the agent gets structured primitives from
+a single step:
+  overflow  de Bruijn patterns of growing length until the target crashes, then the
+            faulting PC / saved return word ([SP] at the faulting `ret`) is looked
+            up in the pattern and the offset is confirmed with a marker word;
+            `stack smashing detected` switches to locating the canary instead
+  format    `%N$p` probes packed behind a marker word, as many per run as the
+            input budget allows, to find the argument index of the buffer and
+            classify every leaked value (stack / libc / binary / heap guess)
+  targets   writable symbols in .data/.bss, GOT slots unless full RELRO, and any
+            addresses the program prints about itself
+Runs go through the fork server (crash registers from the child's signal context);
+when it cannot start (static binaries) crashes are inspected with ptrace.
+
+Progress lines go to stdout; the last line is "[pwntriage] {json result}".
+"""
+import argparse
+import ctypes
+import itertools
+import json
+import os
+import platform
+import re
+import shutil
+import signal
+import string
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+from flaggy_forkserver import ForkServer
+
+CYCLIC_ALPHABET = string.ascii_lowercase
+CYCLIC_ORDER = 4
+CYCLIC_MAX = 1 << 14
+OVERFLOW_LENGTHS = (64, 128, 256, 512, 1024, 2048, 4096, 8192)
+SMASHED = b'stack smashing detected'
+FORMAT_MARKER = 0x5a5a5a5a5a5a5a5a
+MAX_FORMAT_INDEX = 64
+MAX_SYMBOLS = 25
+_ADDRESS = re.compile(rb'0x[0-9a-fA-F]{6,16}')
+
+PTRACE_TRACEME, PTRACE_PEEKDATA, PTRACE_PEEKUSER, PTRACE_CONT = 0, 2, 3, 7
+PTRACE_SETOPTIONS, PTRACE_GETSIGINFO, PTRACE_O_EXITKILL = 0x4200, 0x4202, 0x100000
+# x86_64 struct user_regs_struct offsets
+REG_RIP, REG_RSP = 16 * 8, 19 * 8
+CRASH_SIGNALS = (signal.SIGSEGV, signal.SIGBUS, signal.SIGILL, signal.SIGFPE, signal.SIGABRT, signal.SIGTRAP)
+
+_libc = ctypes.CDLL(None, use_errno=True)
+_libc.ptrace.argtypes = [ctypes.c_long, ctypes.c_long, ctypes.c_void_p, ctypes.c_void_p]
+_libc.ptrace.restype = ctypes.c_long
+
+
+def cyclic(length: int, n: int = CYCLIC_ORDER) -> bytes:
+    """De Bruijn sequence over lowercase letters (same bytes as pwntools' cyclic())"""
+    k = len(CYCLIC_ALPHABET)
+    a = [0] * k * n
+
+    def db(t, p):
+        if t > n:
+            if n % p == 0:
+                yield from (CYCLIC_ALPHABET[a[j]] for j in range(1, p + 1))
+        else:
+            a[t] = a[t - p]
+            yield from db(t + 1, p)
+            for j in range(a[t - p] + 1, k):
+                a[t] = j
+                yield from db(t + 1, t)
+
+    return ''.join(itertools.islice(db(1, 1), length)).encode()
+
+
+_PATTERN = cyclic(CYCLIC_MAX)
+
+
+def cyclic_find(word: int, size: int) -> int:
+    """Offset of a little-endian word's first CYCLIC_ORDER bytes in the pattern, -1 if absent"""
+    return _PATTERN.find(word.to_bytes(size, 'little')[:CYCLIC_ORDER]) if word else -1
+
+
+# ===== Binary facts =====
+
+def _tool(cmd):
+    if not shutil.which(cmd[0]):
+        return ''
+    try:
+        return subprocess.run(cmd, capture_output=True, timeout=30).stdout.decode('utf-8', errors='replace')
+    except (OSError, subprocess.TimeoutExpired):
+        return ''
+
+
+def describe_binary(path: str) -> dict:
+    """ELF class/type plus protections, loadable ranges, writable symbols and GOT slots"""
+    with open(path, 'rb') as f:
+        ident = f.read(20)
+    if ident[:4] != b'\x7fELF':
+        return {'format': 'unknown', 'bits': 64, 'loads': []}
+    bits = 64 if ident[4] == 2 else 32
+    e_type = struct.unpack_from('<H', ident, 16)[0]
+    info = {'format': 'elf', 'bits': bits, 'pie': e_type == 3, 'loads': []}
+    segments = _tool(['readelf', '-lW', path])
+    for line in segments.splitlines():
+        parts = line.split()
+        if parts[:1] == ['LOAD'] and len(parts) >= 6:
+            start = int(parts[2], 16)
+            info['loads'].append([start, start + int(parts[5], 16)])
+    info['nx'] = not re.search(r'GNU_STACK.*RWE', segments)
+    dynamic = _tool(['readelf', '-dW', path])
+    info['static'] = 'INTERP' not in segments
+    info['relro'] = ('full' if re.search(r'BIND_NOW|FLAGS.*\bNOW\b', dynamic) else 'partial') \
+        if 'GNU_RELRO' in segments else 'none'
+    got = []
+    for line in _tool(['readelf', '-rW', path]).splitlines():
+        parts = line.split()
+        if len(parts) >= 5 and parts[2].endswith(('JUMP_SLOT', 'GLOB_DAT')):
+            got.append({'name': parts[4].split('@')[0], 'addr': int(parts[0], 16)})
+    info['canary'] = any(slot['name'] == '__stack_chk_fail' for slot in got)
+    info['got'] = got if info['relro'] != 'full' else []
+    symbols = []
+    for line in _tool(['nm', '-nS', '--defined-only', path]).splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[2] in 'dDbB' and not parts[3].startswith(('_', 'completed.')):
+            symbols.append({'name': parts[3], 'addr': int(parts[0], 16), 'size': int(parts[1], 16)})
+    info['writable_symbols'] = symbols[:MAX_SYMBOLS]
+    return info
+
+
+def classify(value: int, info: dict) -> str:
+    """Best guess at what a leaked word points to"""
+    if any(start <= value < end for start, end in info['loads']):
+        return 'binary'
+    if info['bits'] == 64:
+        if 0x7ff000000000 <= value < 0x800000000000:
+            return 'stack'
+        if 0x7f0000000000 <= value < 0x7ff000000000:
+            return 'libc'
+        if 0x550000000000 <= value < 0x570000000000:
+            return 'pie'
+        if 0x1000000 <= value < 0x100000000:
+            return 'heap'
+    elif 0xff000000 <= value:
+        return 'stack'
+    elif 0xf7000000 <= value < 0xff000000:
+        return 'libc'
+    return 'value'
+
+
+# ===== Running the target =====
+
+def _ptrace(request, pid, addr=0, data=0):
+    ctypes.set_errno(0)
+    result = _libc.ptrace(request, pid, addr, data)
+    if result == -1 and ctypes.get_errno():
+        raise OSError(ctypes.get_errno(), os.strerror(ctypes.get_errno()))
+    return result
+
+
+def _traceme():
+    _libc.ptrace(PTRACE_TRACEME, 0, 0, 0)
+
+
+def ptrace_run(argv, data: bytes, timeout: float) -> dict:
+    """One run under ptrace, reading PC/SP/[SP]/fault address at the first crash signal (x86_64)"""
+    out, err = tempfile.TemporaryFile(), tempfile.TemporaryFile()
+    proc = subprocess.Popen(argv, stdin=subprocess.PIPE, stdout=out, stderr=err, preexec_fn=_traceme)
+    pid = proc.pid
+    os.waitpid(pid, 0)
+    result = {'crash_pc': None, 'fault_addr': None, 'crash_sp': None, 'crash_stack_word': None,
+              'timed_out': False}
+    try:
+        proc.stdin.write(data)
+        proc.stdin.close()
+    except BrokenPipeError:
+        pass
+    _ptrace(PTRACE_SETOPTIONS, pid, 0, PTRACE_O_EXITKILL)
+    deadline = time.time() + timeout
+    pending = 0
+    _ptrace(PTRACE_CONT, pid, 0, pending)
+    while True:
+        done, status = os.waitpid(pid, os.WNOHANG)
+        if not done:
+            if time.time() > deadline:
+                os.kill(pid, signal.SIGKILL)
+                _, status = os.waitpid(pid, 0)
+                result['timed_out'] = True
+                break
+            time.sleep(0.001)
+            continue
+        if not os.WIFSTOPPED(status):
+            break
+        signum = os.WSTOPSIG(status)
+        if signum in CRASH_SIGNALS and result['crash_pc'] is None:
+            siginfo = ctypes.create_string_buffer(128)
+            _ptrace(PTRACE_GETSIGINFO, pid, 0, ctypes.addressof(siginfo))
+            mask = (1 << 64) - 1
+            result['crash_pc'] = _ptrace(PTRACE_PEEKUSER, pid, REG_RIP) & mask
+            result['crash_sp'] = _ptrace(PTRACE_PEEKUSER, pid, REG_RSP) & mask
+            result['fault_addr'] = struct.unpack_from('<Q', siginfo.raw, 16)[0]
+            try:
+                result['crash_stack_word'] = _ptrace(PTRACE_PEEKDATA, pid, result['crash_sp']) & mask
+            except OSError:
+                pass
+        pending = signum
+        _ptrace(PTRACE_CONT, pid, 0, pending)
+    code = os.waitstatus_to_exitcode(status)
+    proc.returncode = code
+    out.seek(0)
+    err.seek(0)
+    result.update({'stdout': out.read(1 << 16), 'stderr': err.read(1 << 16),
+                   'exit_code': code if code >= 0 else None, 'signal': -code if code < 0 else None})
+    result['crashed'] = result['signal'] is not None and not result['timed_out']
+    return result
+
+
+class Target:
+    """Fork server when it starts, otherwise ptrace (x86_64) or plain exec per run"""
+
+    def __init__(self, argv, timeout: float):
+        self.argv = argv
+        self.timeout = timeout
+        self.runs = 0
+        self.fs = ForkServer(argv, timeout=timeout)
+        self.use_ptrace = self.fs.mode == 'exec' and platform.machine() == 'x86_64'
+        self.mode = 'ptrace' if self.use_ptrace else self.fs.mode
+
+    def run(self, data: bytes) -> dict:
+        self.runs += 1
+        if self.use_ptrace:
+            try:
+                return ptrace_run(self.argv, data, self.timeout)
+            except OSError:
+                self.use_ptrace = False
+                self.mode = 'exec'
+        return self.fs.run(data)
+
+    def close(self):
+        self.fs.close()
+
+
+# ===== Probes =====
+
+def find_overflow(target: Target, word: int, prefix: bytes, suffix: bytes, max_length: int, log) -> dict:
+    """Grow a de Bruijn pattern until the target crashes, then locate and confirm the controlled word"""
+    previous = 0
+    for length in (n for n in OVERFLOW_LENGTHS if n <= max_length):
+        r = target.run(prefix + _PATTERN[:length] + suffix)
+        smashed = SMASHED in r['stdout'] + r['stderr']
+        if not r['crashed'] and not smashed:
+            previous = length
+            continue
+        log(f"[pwntriage] pattern of {length} bytes -> signal {r['signal']}"
+            f"{' (stack smashing detected)' if smashed else ''}")
+        result = {'crash_length': length,
+                  'min_crash_length': _min_crash_length(target, prefix, suffix, previous, length),
+                  'signal': r['signal'], 'crash_pc': _hex(r['crash_pc']), 'fault_addr': _hex(r['fault_addr'])}
+        if smashed:
+            # The canary's low byte is NUL, so the first byte that changes the outcome sits on it
+            result.update(status='canary', canary_offset=result['min_crash_length'] - 1)
+            return result
+        for control in ('crash_pc', 'crash_stack_word', 'fault_addr'):
+            offset = cyclic_find(r[control] or 0, word)
+            if offset >= 0:
+                marker = int.from_bytes(b'BBBBBBBB'[:word], 'little')
+                check = target.run(prefix + _PATTERN[:offset] + marker.to_bytes(word, 'little')
+                                   + _PATTERN[offset + word:length] + suffix)
+                confirmed = marker in (check['crash_pc'], check['crash_stack_word'], check['fault_addr'])
+                kind = {'crash_pc': 'pc', 'crash_stack_word': 'saved_return', 'fault_addr': 'pointer'}[control]
+                result.update(status='controlled', offset=offset, controls=kind, confirmed=confirmed)
+                return result
+        result['status'] = 'crash_no_control'
+        return result
+    return {'status': 'no_crash', 'max_length': previous}
+
+
+def _min_crash_length(target: Target, prefix: bytes, suffix: bytes, lo: int, hi: int) -> int:
+    """Smallest pattern length that still crashes or trips the canary (lo does not, hi does)"""
+    while hi - lo > 1:
+        mid = (lo + hi) // 2
+        r = target.run(prefix + _PATTERN[:mid] + suffix)
+        if r['crashed'] or SMASHED in r['stdout'] + r['stderr']:
+            hi = mid
+        else:
+            lo = mid
+    return hi
+
+
+def find_format_offset(target: Target, info: dict, prefix: bytes, suffix: bytes, budget: int, log) -> dict:
+    """Pack `%N$p` probes behind a marker word; the probe that prints the marker is the offset"""
+    word = info['bits'] // 8
+    marker = FORMAT_MARKER & ((1 << (8 * word)) - 1)
+    head = marker.to_bytes(word, 'little')
+    leaks = {}
+    index = 1
+    runs = 0
+    while index <= MAX_FORMAT_INDEX:
+        payload, probes = head, []
+        while index <= MAX_FORMAT_INDEX and len(payload) + len(b'%%%d$p.' % index) + len(suffix) <= budget:
+            payload += b'%%%d$p.' % index
+            probes.append(index)
+            index += 1
+        if not probes:
+            return {'status': 'budget_too_small', 'budget': budget}
+        runs += 1
+        r = target.run(prefix + payload + suffix)
+        match = re.search(re.escape(head) + rb'((?:(?:0x[0-9a-fA-F]+|\(nil\))\.)+)', r['stdout'])
+        if not match:
+            vulnerable = b'%1$p' not in r['stdout'] and runs == 1
+            return {'status': 'no_echo' if vulnerable else 'not_vulnerable', 'runs': runs}
+        values = match.group(1).split(b'.')[:-1]
+        for i, value in zip(probes, values):
+            leaks[i] = 0 if value == b'(nil)' else int(value, 16)
+        if marker in leaks.values():
+            break
+    offset = next((i for i, value in sorted(leaks.items()) if value == marker), None)
+    log(f"[pwntriage] format string: {len(leaks)} probes in {runs} runs, offset {offset}")
+    # Words past the marker are the probe text itself
+    own = range(offset, offset + -(-budget // word)) if offset else range(0)
+    shown = [{'index': i, 'value': hex(v), 'kind': 'input' if i in own else classify(v, info)}
+             for i, v in sorted(leaks.items()) if v and v != marker]
+    return {'status': 'found' if offset else 'leaks_only', 'offset': offset, 'runs': runs, 'leaks': shown}
+
+
+def printed_addresses(target: Target, info: dict, prefix: bytes, suffix: bytes) -> list:
+    """Addresses the program prints on a benign input, named when they hit a known symbol"""
+    r = target.run(prefix + b'A' + suffix)
+    names = {s['addr']: s['name'] for s in info.get('writable_symbols', [])}
+    names.update({g['addr']: f"got.{g['name']}" for g in info.get('got', [])})
+    found = []
+    for match in _ADDRESS.finditer(r['stdout']):
+        value = int(match.group(0), 16)
+        found.append({'value': hex(value), 'kind': classify(value, info), 'symbol': names.get(value)})
+    return found[:MAX_SYMBOLS]
+
+
+def _hex(value):
+    return hex(value) if value is not None else None
+
+
+def _unescape(text: str) -> bytes:
+    return text.encode('latin-1').decode('unicode_escape').encode('latin-1')
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('binary')
+    parser.add_argument('args', nargs='*', help='extra arguments for the target')
+    parser.add_argument('--only', choices=('overflow', 'format', 'targets'), action='append',
+                        help='run only these probes (repeatable)')
+    parser.add_argument('--prefix', default='', help='bytes sent before every payload (\\n, \\x escapes), e.g. menu choices')
+    parser.add_argument('--suffix', default='\\n', help='bytes sent after every payload')
+    parser.add_argument('--max-length', type=int, default=4096, help='longest overflow pattern')
+    parser.add_argument('--format-budget', type=int, default=96,
+                        help='bytes the format-string read accepts (probes per run are packed to fit)')
+    parser.add_argument('--timeout', type=float, default=2.0, help='seconds per run')
+    opts = parser.parse_args(argv)
+
+    binary = os.path.abspath(opts.binary)
+    only = set(opts.only or ('overflow', 'format', 'targets'))
+    prefix, suffix = _unescape(opts.prefix), _unescape(opts.suffix)
+    log = lambda line: print(line, flush=True)
+    info = describe_binary(binary)
+    start = time.perf_counter()
+    target = Target([binary] + opts.args, opts.timeout)
+    result = {'binary': opts.binary, 'runner': target.mode,
+              'protections': {k: info.get(k) for k in ('bits', 'pie', 'nx', 'canary', 'relro', 'static')}}
+    try:
+        if 'targets' in only:
+            result['targets'] = {'writable_symbols': [dict(s, addr=hex(s['addr'])) for s in info.get('writable_symbols', [])],
+                                 'got': [dict(g, addr=hex(g['addr'])) for g in info.get('got', [])][:MAX_SYMBOLS],
+                                 'printed': printed_addresses(target, info, prefix, suffix)}
+        if 'format' in only:
+            result['format_string'] = find_format_offset(target, info, prefix, suffix, opts.format_budget, log)
+        if 'overflow' in only:
+            result['overflow'] = find_overflow(target, info['bits'] // 8, prefix, suffix, opts.max_length, log)
+    finally:
+        target.close()
+    result.update(runs=target.runs, seconds=round(time.perf_counter() - start, 3))
+    print(f"[pwntriage] {json.dumps(result)}", flush=True)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
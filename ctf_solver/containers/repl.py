@@ -0,0 +1,122 @@
+"""
+Host side of the persistent Python REPL (see repl_server.py for the in-container half)
+"""
+import base64
+import json
+import logging
+import struct
+import time
+from pathlib import Path
+from typing import Any, Dict, Optional
+
+from ctf_solver.containers.session import SessionClosed, STDOUT
+
+
+logger = logging.getLogger(__name__)
+
+SERVER_SOURCE = (Path(__file__).parent / 'repl_server.py').read_text()
+
+# The server source travels in the environment so no file has to be written first
+BOOTSTRAP = 'import base64,os;exec(compile(base64.b64decode(os.environ.pop("FLAGGY_REPL")),"flaggy_repl","exec"))'
+
+
+class PythonReplSession:
+    """One long-lived python3 per attempt; namespace, imports and live objects persist between calls"""
+
+    def __init__(self, backend, cwd: str, env_setup: str, startup_timeout: float = 30.0,
+                 grace_seconds: float = 5.0, environment: Optional[Dict[str, str]] = None):
+        self.backend = backend
+        self.cwd = cwd
+        self.grace_seconds = grace_seconds
+        self._next_id = 0
+        self._buf = bytearray()
+        self.calls = 0
+        self.cpu_ms_total = 0.0
+        self.channel = backend.open_channel(
+            ['bash', '-lc', f"{env_setup} && cd {cwd} && exec python3 -u -c '{BOOTSTRAP}'"],
+            environment={'FLAGGY_REPL': base64.b64encode(SERVER_SOURCE.encode()).decode('ascii'),
+                         'PYTHONUNBUFFERED': '1', 'TERM': 'xterm', **(environment or {})},
+            workdir=cwd,
+        )
+        hello = self._receive(time.time() + startup_timeout)
+        if not hello or not hello.get('ready'):
+            self.close()
+            raise SessionClosed("python REPL did not start")
+        self.pid: Optional[int] = hello.get('pid')
+        logger.info(f"Python REPL ready (pid={self.pid}, python={hello.get('python')})")
+
+    @property
+    def alive(self) -> bool:
+        return not self.channel.closed
+
+    def execute(self, code: str, timeout: float, max_output: int = 1 << 20) -> Dict[str, Any]:
+        """Run code in the session namespace.
+
+        The server enforces the timeout itself (SIGALRM raises inside the code); if it
+        does not answer shortly after, the call is interrupted with SIGINT and, failing
+        that, the session is torn down.
+        """
+        response = self._call({'op': 'exec', 'code': code, 'timeout': timeout, 'max_output': max_output},
+                              time.time() + timeout + self.grace_seconds)
+        if response is None:
+            # Blocked in C code that ignores SIGALRM (e.g. a blocking read): try SIGINT
+            self.interrupt()
+            response = self._receive(time.time() + self.grace_seconds)
+            if response is None:
+                logger.warning("Python REPL unresponsive after interrupt, restarting it")
+                self.close()
+                return {'ok': False, 'stdout': '', 'stderr': '', 'timed_out': True,
+                        'error': f'TimeoutError: execution exceeded {timeout:g}s; REPL restarted (state lost)'}
+            response['timed_out'] = True
+        self.calls += 1
+        self.cpu_ms_total += float(response.get('cpu_ms') or 0) + float(response.get('children_cpu_ms') or 0)
+        return response
+
+    def reset(self) -> None:
+        """Drop all user state but keep the interpreter (and its imported modules) warm"""
+        self._call({'op': 'reset'}, time.time() + 10)
+
+    def interrupt(self) -> None:
+        """Raise KeyboardInterrupt in whatever the REPL is currently running"""
+        if not self.pid:
+            return
+        try:
+            self.backend.run_command(['kill', '-INT', str(self.pid)])
+        except Exception as e:
+            logger.warning(f"Failed to interrupt Python REPL: {e}")
+
+    def close(self) -> None:
+        self.channel.close()
+
+    # ===== Framing =====
+
+    def _call(self, request: Dict[str, Any], deadline: float) -> Optional[Dict[str, Any]]:
+        self._next_id += 1
+        request['id'] = self._next_id
+        payload = json.dumps(request).encode('utf-8')
+        self.channel.send(struct.pack('>I', len(payload)) + payload)
+        while True:
+            response = self._receive(deadline)
+            if response is None or response.get('id') == request['id']:
+                return response
+
+    def _receive(self, deadline: float) -> Optional[Dict[str, Any]]:
+        while True:
+            if len(self._buf) >= 4:
+                (length,) = struct.unpack('>I', self._buf[:4])
+                if len(self._buf) >= 4 + length:
+                    message = json.loads(bytes(self._buf[4:4 + length]).decode('utf-8'))
+                    del self._buf[:4 + length]
+                    return message
+            remaining = deadline - time.time()
+            if remaining <= 0:
+                return None
+            frame = self.channel.read_frame(timeout=min(0.5, remaining))
+            if frame is None:
+                continue
+            stream, data = frame
+            if stream == STDOUT:
+                self._buf.extend(data)
+            else:
+                # Interpreter-level noise (e.g. warnings printed before capture starts)
+                logger.debug(f"python REPL stderr: {data[:200]!r}")
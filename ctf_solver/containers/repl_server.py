@@ -0,0 +1,201 @@
+"""
+Python REPL server that runs inside the challenge container
+
+Shipped into the container as source (stdlib only) and started once per attempt by
+PythonReplSession. Requests and responses are JSON messages framed with a 4-byte
+big-endian length on the process's original stdin/stdout; while user code runs,
+file descriptors 0/1/2 point at /dev/null and capture files, so neither the code
+nor the programs it spawns can corrupt the protocol stream.
+
+Request:  {"id": n, "op": "exec", "code": "...", "timeout": seconds, "max_output": bytes}
+          {"id": n, "op": "reset"}
+Response: {"id": n, "ok": bool, "stdout", "stderr", "error", "timed_out", "interrupted",
+           "wall_ms", "cpu_ms", "children_cpu_ms", "maxrss_kb"}
+"""
+import ast
+import json
+import os
+import resource
+import signal
+import struct
+import sys
+import tempfile
+import time
+import traceback
+
+
+class ExecTimeout(BaseException):
+    """Raised inside user code when the per-call timer fires (BaseException so bare
+    `except Exception` blocks in user code cannot swallow it)"""
+
+
+def _on_timer(signum, frame):
+    raise ExecTimeout()
+
+
+def _read_exact(fd, n):
+    data = b''
+    while len(data) < n:
+        chunk = os.read(fd, n - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def _send(fd, message):
+    payload = json.dumps(message).encode('utf-8')
+    data = struct.pack('>I', len(payload)) + payload
+    while data:
+        written = os.write(fd, data)
+        data = data[written:]
+
+
+def _read_capture(f, limit):
+    f.seek(0, os.SEEK_END)
+    size = f.tell()
+    if size <= limit:
+        f.seek(0)
+        return f.read().decode('utf-8', errors='replace')
+    # Keep the beginning and the end; the middle is usually the least useful
+    half = limit // 2
+    f.seek(0)
+    head = f.read(half)
+    f.seek(size - half)
+    tail = f.read(half)
+    return (head.decode('utf-8', errors='replace')
+            + f'\n[... {size - 2 * half} bytes truncated ...]\n'
+            + tail.decode('utf-8', errors='replace'))
+
+
+def _compile(code):
+    """Compile like the interactive interpreter: a trailing expression's value is printed"""
+    tree = ast.parse(code, '<flaggy>', 'exec')
+    last = None
+    if tree.body and isinstance(tree.body[-1], ast.Expr):
+        last = ast.Expression(tree.body.pop().value)
+    body = compile(tree, '<flaggy>', 'exec') if tree.body else None
+    return body, (compile(last, '<flaggy>', 'eval') if last is not None else None)
+
+
+def _cpu_ms(usage):
+    return (usage.ru_utime + usage.ru_stime) * 1000.0
+
+
+class Server:
+    def __init__(self, proto_in, proto_out):
+        self.proto_in = proto_in
+        self.proto_out = proto_out
+        self.namespace = {'__name__': '__main__', '__builtins__': __builtins__}
+
+    def run(self):
+        _send(self.proto_out, {'ready': True, 'pid': os.getpid(), 'python': sys.version.split()[0]})
+        while True:
+            try:
+                header = _read_exact(self.proto_in, 4)
+                if header is None:
+                    return
+                (length,) = struct.unpack('>I', header)
+                body = _read_exact(self.proto_in, length)
+                if body is None:
+                    return
+                request = json.loads(body.decode('utf-8'))
+            except KeyboardInterrupt:
+                # An interrupt that arrives between calls has nothing to stop
+                continue
+            op = request.get('op')
+            if op == 'exec':
+                response = self.execute(request)
+            elif op == 'reset':
+                self.namespace = {'__name__': '__main__', '__builtins__': __builtins__}
+                response = {'ok': True}
+            else:
+                response = {'ok': False, 'error': f'unknown op {op!r}'}
+            response['id'] = request.get('id')
+            _send(self.proto_out, response)
+
+    def execute(self, request):
+        code = request.get('code') or ''
+        timeout = float(request.get('timeout') or 0)
+        max_output = int(request.get('max_output') or 1 << 20)
+        out_file = tempfile.TemporaryFile()
+        err_file = tempfile.TemporaryFile()
+        saved = (os.dup(1), os.dup(2))
+        result = {'ok': True, 'error': None, 'timed_out': False, 'interrupted': False}
+
+        self_before = resource.getrusage(resource.RUSAGE_SELF)
+        children_before = resource.getrusage(resource.RUSAGE_CHILDREN)
+        start = time.time()
+        sys.stdout.flush()
+        sys.stderr.flush()
+        os.dup2(out_file.fileno(), 1)
+        os.dup2(err_file.fileno(), 2)
+        try:
+            try:
+                body, last = _compile(code)
+                if timeout > 0:
+                    signal.setitimer(signal.ITIMER_REAL, timeout)
+                if body is not None:
+                    exec(body, self.namespace)
+                if last is not None:
+                    value = eval(last, self.namespace)
+                    if value is not None:
+                        self.namespace['_'] = value
+                        print(repr(value))
+            finally:
+                signal.setitimer(signal.ITIMER_REAL, 0)
+        except ExecTimeout:
+            result.update(ok=False, timed_out=True, error=f'TimeoutError: execution exceeded {timeout:g}s')
+        except KeyboardInterrupt:
+            result.update(ok=False, interrupted=True, error='KeyboardInterrupt')
+        except SystemExit as e:
+            result.update(ok=False, error=f'SystemExit: {e.code}')
+        except BaseException as e:
+            # Drop the server's own frame so the traceback starts at the user's code
+            tb = e.__traceback__.tb_next if e.__traceback__ else None
+            result.update(ok=False, error=''.join(traceback.format_exception(type(e), e, tb)))
+        finally:
+            try:
+                sys.stdout.flush()
+                sys.stderr.flush()
+            except Exception:
+                pass
+            os.dup2(saved[0], 1)
+            os.dup2(saved[1], 2)
+            os.close(saved[0])
+            os.close(saved[1])
+
+        self_after = resource.getrusage(resource.RUSAGE_SELF)
+        children_after = resource.getrusage(resource.RUSAGE_CHILDREN)
+        result['stdout'] = _read_capture(out_file, max_output)
+        result['stderr'] = _read_capture(err_file, max_output)
+        out_file.close()
+        err_file.close()
+        result['wall_ms'] = round((time.time() - start) * 1000, 1)
+        result['cpu_ms'] = round(_cpu_ms(self_after) - _cpu_ms(self_before), 1)
+        result['children_cpu_ms'] = round(_cpu_ms(children_after) - _cpu_ms(children_before), 1)
+        result['maxrss_kb'] = self_after.ru_maxrss
+        return result
+
+
+def main():
+    # Keep private copies of the protocol pipes, then point the standard fds elsewhere
+    proto_in = os.dup(0)
+    proto_out = os.dup(1)
+    devnull = os.open(os.devnull, os.O_RDWR)
+    os.dup2(devnull, 0)
+    os.dup2(devnull, 1)
+    os.close(devnull)
+    sys.stdin = open(0, 'r', closefd=False)
+    sys.stdout = open(1, 'w', buffering=1, closefd=False)
+    sys.stderr = open(2, 'w', buffering=1, closefd=False)
+    signal.signal(signal.SIGALRM, _on_timer)
+    signal.signal(signal.SIGINT, signal.default_int_handler)
+    sys.argv = ['flaggy-repl']
+    if sys.path[0] != '':
+        sys.path.insert(0, '')
+    Server(proto_in, proto_out).run()
+
+
+if __name__ == '__main__':
+    main()
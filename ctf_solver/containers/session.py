@@ -0,0 +1,236 @@
+"""
+Long-lived processes inside a container, driven over an attached exec socket
+"""
+import base64
+import logging
+import secrets
+import socket
+import struct
+import time
+from typing import Any, Dict, List, Optional, Tuple
+
+from ctf_solver.containers.output import BoundedOutput
+
+
+logger = logging.getLogger(__name__)
+
+STDOUT = 1
+STDERR = 2
+
+# Signal the whole process tree below a PID at once, leaving the PID itself alive
+KILL_TREE = 'k(){ for c in $(pgrep -P "$1"); do echo "$c"; k "$c"; done; }; kill -"$1" $(k "$0") 2>/dev/null'
+
+# Defined once per session: dumps what a command changed (exported env, aliases, cwd)
+# so the parent shell can adopt it after the command's subshell exits
+SAVE_STATE_FN = (
+    '__flaggy_save() { { export -p; alias -p; printf "cd -- %q\\n" "$PWD"; } '
+    '> "$__FLAGGY_STATE" 2>/dev/null; }'
+)
+
+
+class SessionClosed(Exception):
+    """Raised when the process behind an exec channel has exited"""
+
+
+class ExecChannel:
+    """Attached, non-tty exec whose stdin/stdout are spoken over the raw Docker socket.
+
+    Docker multiplexes stdout/stderr on the socket as frames with an 8-byte header
+    (stream type, 3 padding bytes, big-endian payload length).
+    """
+
+    def __init__(self, container, cmd: List[str], environment: Optional[Dict[str, str]] = None,
+                 workdir: Optional[str] = None):
+        self.container = container
+        self._api = container.client.api
+        self.exec_id = self._api.exec_create(
+            container.id, cmd, stdin=True, stdout=True, stderr=True, tty=False,
+            environment=environment, workdir=workdir,
+        )['Id']
+        raw = self._api.exec_start(self.exec_id, socket=True)
+        # docker-py hands back a SocketIO wrapper for unix sockets; we need the socket itself
+        self._sock: socket.socket = getattr(raw, '_sock', raw)
+        self._raw = raw
+        self._buf = bytearray()
+        self.closed = False
+
+    def send(self, data: bytes) -> None:
+        if self.closed:
+            raise SessionClosed("exec channel is closed")
+        try:
+            self._sock.sendall(data)
+        except OSError as e:
+            self.closed = True
+            raise SessionClosed(str(e))
+
+    def read_frame(self, timeout: Optional[float]) -> Optional[Tuple[int, bytes]]:
+        """Return the next (stream, payload) frame, or None if nothing arrived in time"""
+        deadline = None if timeout is None else time.time() + timeout
+        while True:
+            if len(self._buf) >= 8:
+                stream, length = struct.unpack('>BxxxL', self._buf[:8])
+                if len(self._buf) >= 8 + length:
+                    payload = bytes(self._buf[8:8 + length])
+                    del self._buf[:8 + length]
+                    return stream, payload
+            if self.closed:
+                raise SessionClosed("exec channel is closed")
+            remaining = None if deadline is None else deadline - time.time()
+            if remaining is not None and remaining <= 0:
+                return None
+            self._sock.settimeout(remaining)
+            try:
+                chunk = self._sock.recv(65536)
+            except socket.timeout:
+                return None
+            except OSError as e:
+                self.closed = True
+                raise SessionClosed(str(e))
+            if not chunk:
+                self.closed = True
+                raise SessionClosed("exec process exited")
+            self._buf.extend(chunk)
+
+    def pid(self) -> Optional[int]:
+        try:
+            return self._api.exec_inspect(self.exec_id).get('Pid')
+        except Exception:
+            return None
+
+    def exit_code(self) -> Optional[int]:
+        try:
+            return self._api.exec_inspect(self.exec_id).get('ExitCode')
+        except Exception:
+            return None
+
+    def close(self) -> None:
+        self.closed = True
+        for obj in (self._sock, self._raw):
+            try:
+                obj.close()
+            except Exception:
+                pass
+
+
+class ShellSession:
+    """One bash process per attempt; commands are framed by a random end-of-command sentinel.
+
+    Each command runs in a subshell of the session shell so that a timeout or an
+    `exit` only ends that command; its cwd, exported environment and aliases are
+    carried back into the session afterwards (plain shell variables are not). The exit code and the
+    resulting working directory are reported in-band.
+    """
+
+    def __init__(self, backend, cwd: str, env_setup: str, grace_seconds: float = 5.0):
+        self.backend = backend
+        self.cwd = cwd
+        self.grace_seconds = grace_seconds
+        self.state_file = f'{backend.tmp_dir}/.flaggy_session_{secrets.token_hex(4)}'
+        self.channel = backend.open_channel(['bash', '-l'], environment={'TERM': 'xterm'}, workdir=cwd)
+        self.shell_pid: Optional[int] = None
+        self.channel.send(f'export __FLAGGY_STATE={self.state_file}; {SAVE_STATE_FN}\n'.encode())
+        init = self.run(f'{env_setup} && cd {cwd} && echo $$', timeout=30)
+        if init['exit_code'] != 0 or init['timed_out']:
+            self.close()
+            raise SessionClosed(f"shell initialisation failed: {init['output'][-200:]!r}")
+        try:
+            self.shell_pid = int(init['output'].strip().splitlines()[-1])
+        except (ValueError, IndexError):
+            self.shell_pid = None
+
+    @property
+    def alive(self) -> bool:
+        return not self.channel.closed
+
+    def run(self, cmd: str, timeout: float, sink: Optional[BoundedOutput] = None) -> Dict[str, Any]:
+        """Run a command in the session shell.
+
+        Output (stdout and stderr merged, as before) is written to sink as it arrives;
+        nothing else is buffered. On timeout, or once the sink's byte budget is
+        exhausted, the command's process tree is sent SIGINT, then SIGKILL after a
+        grace period.
+        """
+        sink = sink if sink is not None else BoundedOutput()
+        token = secrets.token_hex(8)
+        marker = f'__FLAGGY_END_{token}__ '.encode()
+        encoded = base64.b64encode(cmd.encode('utf-8')).decode('ascii')
+        script = (
+            f'( trap __flaggy_save EXIT; eval "$(printf %s {encoded} | base64 -d)" ) </dev/null 2>&1; '
+            f'__flaggy_rc=$?; [ -s "$__FLAGGY_STATE" ] && . "$__FLAGGY_STATE" >/dev/null 2>&1; '
+            f'rm -f "$__FLAGGY_STATE"; printf \'{marker.decode()}%d %s\\n\' "$__flaggy_rc" "$PWD"\n'
+        )
+
+        pending = bytearray()  # output not yet handed to the sink (may hold a partial sentinel)
+        timed_out = False
+        stopping = False  # byte budget exhausted, command is being killed
+        deadline = time.time() + timeout
+        kill_stage = 0
+        self.channel.send(script.encode('utf-8'))
+
+        while True:
+            idx = pending.find(marker)
+            if idx != -1 and pending.find(b'\n', idx) != -1:
+                break
+            # Hand over everything that cannot be part of the sentinel
+            safe = len(pending) - len(marker) if idx == -1 else idx
+            if safe > 0:
+                if not sink.write(bytes(pending[:safe])) and not stopping:
+                    stopping = True
+                    deadline = time.time()
+                del pending[:safe]
+
+            now = time.time()
+            if now >= deadline:
+                kill_stage += 1
+                timed_out = timed_out or not stopping
+                if kill_stage > 2:
+                    # Even SIGKILL of the command did not free the shell: give up on it
+                    self.close()
+                    return self._result(sink, None, timed_out, 124 if timed_out else None)
+                self.interrupt('INT' if kill_stage == 1 else 'KILL')
+                deadline = now + self.grace_seconds
+            try:
+                frame = self.channel.read_frame(timeout=min(0.5, max(0.01, deadline - time.time())))
+            except SessionClosed:
+                # The session shell itself died; report what we have
+                self.close()
+                sink.write(bytes(pending))
+                exit_code = self.channel.exit_code()
+                return self._result(sink, None, timed_out, 124 if timed_out else exit_code)
+            if frame is not None:
+                pending.extend(frame[1])
+
+        end = pending.find(b'\n', idx)
+        sink.write(bytes(pending[:idx]))
+        status_line = pending[idx + len(marker):end].decode('utf-8', errors='replace')
+        rc_text, _, pwd = status_line.partition(' ')
+        try:
+            exit_code = int(rc_text)
+        except ValueError:
+            exit_code = None
+        if pwd:
+            self.cwd = pwd
+        return self._result(sink, self.cwd, timed_out, 124 if timed_out else exit_code)
+
+    def _result(self, sink: BoundedOutput, cwd: Optional[str], timed_out: bool,
+                exit_code: Optional[int]) -> Dict[str, Any]:
+        return {
+            'output': sink.getvalue(),
+            'exit_code': exit_code,
+            'cwd': cwd or self.cwd,
+            'timed_out': timed_out,
+            'aborted': sink.aborted,
+            'total_bytes': sink.total_bytes,
+        }
+
+    def interrupt(self, signal_name: str = 'INT') -> None:
+        """Signal every process started by the current command (the shell itself survives)"""
+        if not self.shell_pid:
+            return
+        try:
+            self.backend.run_command(['bash', '-c', KILL_TREE, str(self.shell_pid), signal_name])
+        except Exception as e:
+            logger.warning(f"Failed to interrupt shell session command: {e}")
+
+    def close(self) -> None:
+        self.channel.close()
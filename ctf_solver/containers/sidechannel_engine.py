@@ -0,0 +1,456 @@
+"""
+Instruction-count side-channel solver that runs inside the challenge container
+
+Shipped into the container as source (stdlib only) and run by the `sidechannel`
+tool. Password checks that bail out at the first wrong character execute more
+instructions the longer the correct prefix is, so the input can be recovered one
+character at a time: run every candidate for the next position, keep the one that
+executes measurably more instructions than the rest, repeat until the program
+prints something that looks like success.
+
+Counters, in order of preference:
+  perf      perf_event_open instructions:u (hardware, full speed; needs a PMU and
+            perf_event_paranoid/seccomp that allow it)
+  valgrind  valgrind --tool=lackey guest instruction count
+  ptrace    single-steps the target from the moment its first stdin read returns
+            (only the input-dependent part is stepped; ~10us per instruction)
+
+Progress lines go to stdout; the last line is "[sidechannel] {json result}".
+"""
+import argparse
+import ctypes
+import json
+import os
+import platform
+import re
+import shutil
+import signal
+import statistics
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+from concurrent.futures import ProcessPoolExecutor
+
+DEFAULT_CHARSET = ('abcdefghijklmnopqrstuvwxyz0123456789_ABCDEFGHIJKLMNOPQRSTUVWXYZ'
+                   '{}!-@#$%^&*+=.,:;?/<>()[]|~\'"` ')
+DEFAULT_SUCCESS = r'(?i)\w*ctf\{|flag\{|\bcorrect\b|congrat|access granted|well done|you win|success'
+FILLER = '\x7f'
+MAX_OUTPUT = 4096
+
+PTRACE_TRACEME, PTRACE_PEEKUSER, PTRACE_CONT, PTRACE_KILL = 0, 3, 7, 8
+PTRACE_SINGLESTEP, PTRACE_DETACH, PTRACE_SYSCALL = 9, 17, 24
+PTRACE_SETOPTIONS, PTRACE_O_TRACESYSGOOD, PTRACE_O_EXITKILL = 0x4200, 0x1, 0x100000
+# x86_64 struct user_regs_struct offsets
+REG_RDI, REG_ORIG_RAX = 14 * 8, 15 * 8
+PERF_EVENT_OPEN = {'x86_64': 298, 'aarch64': 241, 'i686': 336, 'i386': 336}
+PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS = 0, 1
+# perf_event_attr flag bits
+PERF_DISABLED, PERF_INHERIT, PERF_EXCLUDE_KERNEL, PERF_EXCLUDE_HV = 1 << 0, 1 << 1, 1 << 5, 1 << 6
+
+_libc = ctypes.CDLL(None, use_errno=True)
+_libc.ptrace.argtypes = [ctypes.c_long, ctypes.c_long, ctypes.c_void_p, ctypes.c_void_p]
+_libc.ptrace.restype = ctypes.c_long
+_libc.syscall.restype = ctypes.c_long
+
+
+class CounterUnavailable(RuntimeError):
+    pass
+
+
+def _ptrace(request, pid, addr=0, data=0):
+    ctypes.set_errno(0)
+    result = _libc.ptrace(request, pid, addr, data)
+    if result == -1 and ctypes.get_errno():
+        raise OSError(ctypes.get_errno(), os.strerror(ctypes.get_errno()))
+    return result
+
+
+def _traceme():
+    _libc.ptrace(PTRACE_TRACEME, 0, 0, 0)
+
+
+class Counter:
+    """Runs the target with one input and returns (instructions, output, exit code)"""
+    name = ''
+
+    def __init__(self, argv, mode, timeout):
+        self.argv = argv
+        self.mode = mode
+        self.timeout = timeout
+
+    def _command(self, candidate):
+        if self.mode == 'argv':
+            return self.argv + [candidate], b''
+        return list(self.argv), candidate.encode('latin-1') + b'\n'
+
+    def _spawn_traced(self, argv, data):
+        """Start argv stopped at exec under ptrace, with its stdin already written"""
+        out = tempfile.TemporaryFile()
+        proc = subprocess.Popen(argv, stdin=subprocess.PIPE, stdout=out, stderr=subprocess.STDOUT,
+                                preexec_fn=_traceme)
+        _, status = os.waitpid(proc.pid, 0)
+        if not os.WIFSTOPPED(status):
+            raise CounterUnavailable("target did not stop at exec (ptrace not permitted?)")
+        try:
+            # Small inputs fit in the pipe buffer, so the stopped child cannot block us
+            proc.stdin.write(data)
+            proc.stdin.close()
+        except BrokenPipeError:
+            pass
+        return proc, out
+
+    @staticmethod
+    def _collect(proc, out, status):
+        proc.returncode = os.waitstatus_to_exitcode(status)
+        out.seek(0)
+        output = out.read(MAX_OUTPUT)
+        out.close()
+        return output.decode('latin-1'), proc.returncode
+
+    def run(self, candidate):
+        raise NotImplementedError
+
+
+class PerfCounter(Counter):
+    name = 'perf'
+
+    def __init__(self, argv, mode, timeout):
+        super().__init__(argv, mode, timeout)
+        self.nr = PERF_EVENT_OPEN.get(platform.machine())
+        if self.nr is None:
+            raise CounterUnavailable(f"perf_event_open number unknown for {platform.machine()}")
+        fd = self._open(0)
+        os.close(fd)
+
+    def _open(self, pid):
+        # struct perf_event_attr (PERF_ATTR_SIZE_VER5): type, size, config, ..., flags at offset 40
+        attr = bytearray(112)
+        struct.pack_into('IIQ', attr, 0, PERF_TYPE_HARDWARE, len(attr), PERF_COUNT_HW_INSTRUCTIONS)
+        struct.pack_into('Q', attr, 40, PERF_INHERIT | PERF_EXCLUDE_KERNEL | PERF_EXCLUDE_HV)
+        buf = ctypes.create_string_buffer(bytes(attr), len(attr))
+        fd = _libc.syscall(self.nr, buf, ctypes.c_int(pid), ctypes.c_int(-1), ctypes.c_int(-1), ctypes.c_ulong(8))
+        if fd < 0:
+            errno = ctypes.get_errno()
+            raise CounterUnavailable(f"perf_event_open failed: {os.strerror(errno)}")
+        return fd
+
+    def run(self, candidate):
+        argv, data = self._command(candidate)
+        proc, out = self._spawn_traced(argv, data)
+        try:
+            fd = self._open(proc.pid)
+        except CounterUnavailable:
+            os.kill(proc.pid, signal.SIGKILL)
+            os.waitpid(proc.pid, 0)
+            raise
+        try:
+            _ptrace(PTRACE_DETACH, proc.pid, 0, 0)
+            try:
+                _, status = _wait(proc.pid, self.timeout)
+            finally:
+                count = struct.unpack('Q', os.read(fd, 8))[0]
+        finally:
+            os.close(fd)
+        output, code = self._collect(proc, out, status)
+        return count, output, code
+
+
+class ValgrindCounter(Counter):
+    name = 'valgrind'
+
+    def __init__(self, argv, mode, timeout):
+        super().__init__(argv, mode, timeout)
+        self.valgrind = shutil.which('valgrind')
+        if not self.valgrind:
+            raise CounterUnavailable("valgrind is not installed")
+
+    def run(self, candidate):
+        argv, data = self._command(candidate)
+        with tempfile.NamedTemporaryFile('r', suffix='.log') as log:
+            result = subprocess.run([self.valgrind, '--tool=lackey', '--basic-counts=yes',
+                                     f'--log-file={log.name}'] + argv,
+                                    input=data, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                    timeout=self.timeout)
+            m = re.search(r'guest instrs:\s+([\d,]+)', log.read())
+        if not m:
+            raise CounterUnavailable("valgrind produced no instruction count")
+        return int(m.group(1).replace(',', '')), result.stdout[:MAX_OUTPUT].decode('latin-1'), result.returncode
+
+
+class PtraceCounter(Counter):
+    """Single-steps only what runs after the input is read (x86_64); elsewhere from exec"""
+    name = 'ptrace'
+
+    def __init__(self, argv, mode, timeout, max_steps=20_000_000):
+        super().__init__(argv, mode, timeout)
+        self.max_steps = max_steps
+        self.windowed = platform.machine() == 'x86_64' and mode == 'stdin'
+
+    def run(self, candidate):
+        argv, data = self._command(candidate)
+        proc, out = self._spawn_traced(argv, data)
+        pid = proc.pid
+        deadline = time.time() + self.timeout
+        try:
+            _ptrace(PTRACE_SETOPTIONS, pid, 0, PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL)
+            status = self._until_input_read(pid) if self.windowed else None
+            count = 0
+            if status is None:
+                pending = 0
+                while True:
+                    _ptrace(PTRACE_SINGLESTEP, pid, 0, pending)
+                    _, status = os.waitpid(pid, 0)
+                    if os.WIFEXITED(status) or os.WIFSIGNALED(status):
+                        break
+                    signum = os.WSTOPSIG(status)
+                    pending = 0 if signum == signal.SIGTRAP else signum
+                    count += 1
+                    if count >= self.max_steps or (count & 0xffff == 0 and time.time() > deadline):
+                        raise subprocess.TimeoutExpired(argv, self.timeout)
+        except BaseException:
+            os.kill(pid, signal.SIGKILL)
+            os.waitpid(pid, 0)
+            raise
+        output, code = self._collect(proc, out, status)
+        return count, output, code
+
+    @staticmethod
+    def _until_input_read(pid):
+        """Run at full speed to the return of the first read() from fd 0; returns the exit status if it exits first"""
+        entering = True
+        watching = False
+        pending = 0
+        while True:
+            _ptrace(PTRACE_SYSCALL, pid, 0, pending)
+            _, status = os.waitpid(pid, 0)
+            if os.WIFEXITED(status) or os.WIFSIGNALED(status):
+                return status
+            signum = os.WSTOPSIG(status)
+            if signum != signal.SIGTRAP | 0x80:
+                pending = 0 if signum == signal.SIGTRAP else signum
+                continue
+            pending = 0
+            if entering:
+                nr = _ptrace(PTRACE_PEEKUSER, pid, REG_ORIG_RAX, 0)
+                fd = _ptrace(PTRACE_PEEKUSER, pid, REG_RDI, 0)
+                watching = nr == 0 and fd == 0
+            elif watching:
+                return None
+            entering = not entering
+
+
+def _wait(pid, timeout):
+    deadline = time.time() + timeout
+    while True:
+        done, status = os.waitpid(pid, os.WNOHANG)
+        if done:
+            return done, status
+        if time.time() > deadline:
+            os.kill(pid, signal.SIGKILL)
+            return os.waitpid(pid, 0)
+        time.sleep(0.0005)
+
+
+COUNTERS = {'perf': PerfCounter, 'valgrind': ValgrindCounter, 'ptrace': PtraceCounter}
+
+
+def make_counter(kind, argv, mode, timeout):
+    kinds = list(COUNTERS) if kind == 'auto' else [kind]
+    reasons = []
+    for name in kinds:
+        try:
+            return COUNTERS[name](argv, mode, timeout)
+        except CounterUnavailable as e:
+            reasons.append(f"{name}: {e}")
+    raise CounterUnavailable('; '.join(reasons))
+
+
+# Pool workers get the counter once, then only candidates cross the process boundary
+_counter = None
+
+
+def _init_worker(counter):
+    global _counter
+    _counter = counter
+
+
+def _measure(candidate):
+    try:
+        count, output, code = _counter.run(candidate)
+        return candidate, count, output, code, None
+    except subprocess.TimeoutExpired:
+        return candidate, None, '', None, 'timeout'
+    except (OSError, CounterUnavailable) as e:
+        return candidate, None, '', None, str(e)
+
+
+class Solver:
+    def __init__(self, counter, charset=DEFAULT_CHARSET, prefix='', length=None, max_length=64,
+                 success=DEFAULT_SUCCESS, flag_format=None, workers=None, exhaustive=False, time_limit=600,
+                 log=print):
+        self.counter = counter
+        self.charset = charset
+        self.prefix = prefix
+        self.length = length
+        self.max_length = max_length
+        self.success = [re.compile(success)]
+        if flag_format:
+            try:
+                self.success.append(re.compile(flag_format))
+            except re.error:
+                pass
+        self.workers = workers or os.cpu_count() or 1
+        self.exhaustive = exhaustive
+        self.deadline = time.time() + time_limit
+        self.log = log
+        self.runs = 0
+        self.executor = None
+
+    def measure(self, candidates):
+        """candidate -> (count, output); runs in parallel across the worker processes"""
+        self.runs += len(candidates)
+        if self.executor is None:
+            _init_worker(self.counter)
+            results = map(_measure, candidates)
+        else:
+            results = self.executor.map(_measure, candidates)
+        measured = {}
+        for candidate, count, output, code, error in results:
+            if error and error != 'timeout':
+                raise CounterUnavailable(error)
+            measured[candidate] = (count, output)
+        return measured
+
+    def _succeeded(self, measured):
+        for candidate, (_, output) in measured.items():
+            if any(pattern.search(output) for pattern in self.success):
+                return candidate, output
+        return None
+
+    def _noise(self, probe):
+        counts = [c for c, _ in (self.measure([probe])[probe] for _ in range(3)) if c is not None]
+        return max(counts) - min(counts) if counts else 0
+
+    def _detect_length(self, threshold):
+        probes = [self.prefix + FILLER * (n - len(self.prefix)) for n in range(max(len(self.prefix), 1), self.max_length + 1)]
+        measured = self.measure(probes)
+        counts = [measured[p][0] for p in probes]
+        if None in counts or len(counts) < 4:
+            return None
+        steps = [b - a for a, b in zip(counts, counts[1:])]
+        typical = statistics.median(steps)
+        # A length check that passes shows up as a spike: up at the right length, back down after it
+        best = None
+        for i, step in enumerate(steps[:-1]):
+            if step - typical > threshold and steps[i + 1] - typical < -threshold / 2:
+                if best is None or step > steps[best]:
+                    best = i
+        return len(probes[best + 1]) if best is not None else None
+
+    def solve(self):
+        started = time.time()
+        if self.workers > 1:
+            self.executor = ProcessPoolExecutor(max_workers=self.workers, initializer=_init_worker,
+                                                initargs=(self.counter,))
+        try:
+            return self._solve(started)
+        finally:
+            if self.executor is not None:
+                self.executor.shutdown(cancel_futures=True)
+
+    def _solve(self, started):
+        noise = self._noise(self.prefix + FILLER)
+        threshold = max(2, 4 * noise)
+        self.log(f"counter={self.counter.name} workers={self.workers} noise={noise} threshold={threshold}")
+        length = self.length or self._detect_length(threshold)
+        self.log(f"length: {length if length else 'not detected (growing the input)'}")
+
+        known = self.prefix
+        trace = []
+        previous = None
+        result = {'status': 'stalled'}
+        while len(known) < (length or self.max_length):
+            if time.time() > self.deadline:
+                result = {'status': 'time_limit'}
+                break
+            pad = FILLER * (length - len(known) - 1) if length else ''
+            reference = known + FILLER + pad
+            measured = self.measure([reference])
+            base = measured[reference][0]
+            winner = None
+            chunk = max(self.workers * 2, 8)
+            for i in range(0, len(self.charset), chunk):
+                batch = {known + c + pad: c for c in self.charset[i:i + chunk] if c != FILLER}
+                measured.update(self.measure(list(batch)))
+                hit = self._succeeded(measured)
+                if hit:
+                    known = hit[0]
+                    output = hit[1].strip()
+                    self.log(f"success with {known!r}")
+                    return self._result('solved', known, length, trace, started, output=output[-1000:])
+                counts = {c: measured[cand][0] for cand, c in batch.items() if measured[cand][0] is not None}
+                above = [c for c, n in counts.items() if base is not None and n - base > threshold]
+                if len(above) == 1 and not self.exhaustive:
+                    winner = above[0]
+                    break
+            if winner is None:
+                ranked = sorted(((n, cand) for cand, (n, _) in measured.items() if n is not None), reverse=True)
+                if len(ranked) < 2 or ranked[0][0] - ranked[1][0] <= threshold:
+                    result = {'status': 'stalled', 'top': [(cand[len(known):len(known) + 1], n) for n, cand in ranked[:5]]}
+                    break
+                winner = ranked[0][1][len(known)]
+            count = measured[known + winner + pad][0]
+            if previous is not None and count <= previous:
+                result = {'status': 'not_monotonic'}
+                break
+            self.log(f"pos {len(known)}: {winner!r} (+{count - base} instructions over reference)")
+            trace.append({'position': len(known), 'char': winner, 'count': count, 'delta': count - base})
+            known += winner
+            previous = count
+        else:
+            result = {'status': 'exhausted'}
+        return self._result(result.pop('status'), known, length, trace, started, **result)
+
+    def _result(self, status, recovered, length, trace, started, **extra):
+        return {'status': status, 'input': recovered, 'length': length, 'counter': self.counter.name,
+                'runs': self.runs, 'seconds': round(time.time() - started, 2), 'trace': trace, **extra}
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('binary')
+    parser.add_argument('args', nargs='*', help='extra arguments for the target')
+    parser.add_argument('--mode', choices=('stdin', 'argv'), default='stdin',
+                        help='feed candidates on stdin (newline-terminated) or as the last argument')
+    parser.add_argument('--counter', choices=('auto',) + tuple(COUNTERS), default='auto')
+    parser.add_argument('--prefix', default='', help='known start of the input')
+    parser.add_argument('--charset', default=DEFAULT_CHARSET)
+    parser.add_argument('--length', type=int, help='input length, if known')
+    parser.add_argument('--max-length', type=int, default=48)
+    parser.add_argument('--success', default=DEFAULT_SUCCESS, help='regex on program output that means solved')
+    parser.add_argument('--flag-format', help='flag regex; output matching it also means solved')
+    parser.add_argument('--workers', type=int, default=0)
+    parser.add_argument('--exhaustive', action='store_true', help='measure the whole charset at every position')
+    parser.add_argument('--timeout', type=float, default=30, help='seconds per run')
+    parser.add_argument('--time-limit', type=float, default=600)
+    opts = parser.parse_args(argv)
+
+    binary = os.path.abspath(opts.binary)
+    try:
+        counter = make_counter(opts.counter, [binary] + opts.args, opts.mode, opts.timeout)
+        solver = Solver(counter, charset=opts.charset, prefix=opts.prefix, length=opts.length,
+                        max_length=opts.max_length, success=opts.success, flag_format=opts.flag_format,
+                        workers=opts.workers,
+                        exhaustive=opts.exhaustive, time_limit=opts.time_limit,
+                        log=lambda line: print(line, flush=True))
+        result = solver.solve()
+    except CounterUnavailable as e:
+        result = {'status': 'no_counter', 'error': str(e)}
+    print(f"[sidechannel] {json.dumps(result)}", flush=True)
+    return 0 if result['status'] == 'solved' else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -3,11 +3,16 @@ Challenge management system for flaggy
 """
 import os
 import json
+import hashlib
 import shutil
 import logging
 from pathlib import Path
 from typing import Dict, List, Optional, Tuple
 
+from ctf_solver.analysis.signatures import SIGNATURE_VERSION, SignatureStore, render_scripts, stripped_static_targets
+from ctf_solver.analysis.store import AnalysisStore
+from ctf_solver.analysis.triage import render_summary
+from ctf_solver.config import ANALYSIS_ON_SYNC, SIGNATURES_ENABLED
 from ctf_solver.database.db import get_db_cursor
 
 
@@ -171,6 +176,95 @@ class ChallengeManager:
                         challenge['flag_format']
                     ))
                     logger.info(f"Added new challenge: {challenge['name']}")
+        
+        if ANALYSIS_ON_SYNC:
+            self.precompute_analysis([Path(c['directory']) for c in challenges])
+    
+    def workspace_files(self, challenge_dir: Path) -> List[Path]:
+        """Files of a challenge that are copied into attempt workspaces"""
+        return [f for f in sorted(challenge_dir.iterdir())
+                if f.is_file() and self._should_copy_file(f, challenge_dir)]
+    
+    def precompute_analysis(self, challenge_dirs: List[Path]) -> int:
+        """Run static triage over every workspace file of the given challenges (in parallel).
+        Returns the number of files with an artifact."""
+        paths = []
+        for challenge_dir in challenge_dirs:
+            try:
+                paths.extend(str(f) for f in self.workspace_files(challenge_dir))
+            except OSError as e:
+                logger.warning(f"Skipping analysis of {challenge_dir}: {e}")
+        try:
+            artifacts = AnalysisStore().analyze_files(paths)
+        except Exception as e:
+            logger.error(f"Static analysis pipeline failed: {e}")
+            return 0
+        logger.info(f"Static analysis ready for {len(artifacts)}/{len(paths)} challenge files")
+        for challenge_dir in challenge_dirs:
+            self.recover_symbols(challenge_dir, artifacts)
+        return len(artifacts)
+    
+    def recover_symbols(self, challenge_dir: Path,
+                        artifacts: Optional[Dict[str, Dict]] = None) -> Dict[str, Dict]:
+        """Symbol maps for stripped binaries shipped alongside the static libraries they link (binary name -> map).
+        Recovered once per challenge file set and kept in the analysis store; artifacts (path -> artifact)
+        may be passed by callers that already have them."""
+        if not SIGNATURES_ENABLED:
+            return {}
+        try:
+            paths = [str(f) for f in self.workspace_files(challenge_dir)]
+        except OSError as e:
+            logger.warning(f"Skipping symbol recovery for {challenge_dir}: {e}")
+            return {}
+        analysis = AnalysisStore()
+        if artifacts is None or any(p not in artifacts for p in paths):
+            artifacts = {**(artifacts or {}), **analysis.analyze_files(paths)}
+        key = hashlib.sha256(json.dumps(
+            [SIGNATURE_VERSION, sorted((os.path.basename(p), artifacts[p]['sha256']) for p in paths if p in artifacts)]
+        ).encode()).hexdigest()
+        maps = analysis.get_symbols(key)
+        if maps is not None:
+            return maps
+        maps = {}
+        binaries, archives = stripped_static_targets(paths)
+        if binaries and archives:
+            store = SignatureStore()
+            for binary in binaries:
+                try:
+                    symbol_map = store.symbol_map(binary, archives)
+                except Exception as e:
+                    logger.warning(f"Symbol recovery failed for {binary}: {e}")
+                    continue
+                if symbol_map and symbol_map['functions']:
+                    maps[Path(binary).name] = symbol_map
+        try:
+            analysis.put_symbols(key, maps)
+        except OSError as e:
+            logger.warning(f"Failed to store symbol maps for {challenge_dir}: {e}")
+        return maps
+    
+    def get_challenge_analysis(self, challenge_id: int) -> Optional[str]:
+        """Compact static-analysis summary of a challenge's workspace files, if available"""
+        with get_db_cursor() as cursor:
+            cursor.execute("SELECT binary_path FROM challenges WHERE id = %s", (challenge_id,))
+            result = cursor.fetchone()
+        if not result:
+            return None
+        challenge_dir = Path(result[0]).parent
+        paths = [str(f) for f in self.workspace_files(challenge_dir)]
+        # Files missed at sync time (e.g. added by hand) are analysed now
+        artifacts = AnalysisStore().analyze_files(paths)
+        ordered = [artifacts[p] for p in paths if p in artifacts]
+        if not ordered:
+            return None
+        summary = render_summary(ordered)
+        for name, symbol_map in self.recover_symbols(challenge_dir, artifacts).items():
+            functions = symbol_map['functions']
+            shown = ' '.join(f"{addr}:{entry['name']}" for addr, entry in list(functions.items())[:40])
+            summary += (f"\n== {name}: {len(functions)} library functions named by signatures from "
+                        f"{', '.join(symbol_map['archives'])} (full map in {name}.syms.json; "
+                        f"`source {name}.gdb` in gdb, `. {name}.r2` in radare2)\n{shown}")
+        return summary
     
     def prepare_attempt_workspace(self, challenge_id: int, attempt_id: int) -> Tuple[str, Dict[str, str]]:
         """
@@ -216,6 +310,12 @@ class ChallengeManager:
         
         logger.info(f"Copied {len(copied_files)} files, excluded {len(excluded_files)} files")
         
+        # Names recovered from shipped static libraries, as files the agent and debuggers can load
+        for name, symbol_map in self.recover_symbols(challenge_dir).items():
+            (attempt_dir / f"{name}.syms.json").write_text(json.dumps(symbol_map['functions'], indent=1))
+            for kind, script in render_scripts(symbol_map).items():
+                (attempt_dir / f"{name}.{kind}").write_text(script)
+        
         # Prepare container mounts (host_path -> container_path)  
         # Only mount the filtered working copy - no access to raw source files
         container_mounts = {
@@ -239,6 +339,25 @@ class ChallengeManager:
             challenge_dir = Path(result[0]).parent
             return [f.name for f in challenge_dir.iterdir() if f.is_file()]
     
+    def get_challenge_backend(self, challenge_id: int) -> Optional[str]:
+        """Execution backend requested by the challenge metadata ("backend" key), if any"""
+        with get_db_cursor() as cursor:
+            cursor.execute("SELECT binary_path FROM challenges WHERE id = %s", (challenge_id,))
+            result = cursor.fetchone()
+        if not result:
+            return None
+        challenge_dir = Path(result[0]).parent
+        for name in ("challenge.json", "metadata.json"):
+            metadata_file = challenge_dir / name
+            if metadata_file.exists():
+                try:
+                    with open(metadata_file) as f:
+                        return json.load(f).get('backend')
+                except Exception as e:
+                    logger.warning(f"Error reading {name} for backend selection: {e}")
+                    return None
+        return None
+    
     def cleanup_attempt_workspace(self, attempt_id: int, keep_successful: bool = True):
         """
         Clean up attempt workspace (optional - by default we keep everything)
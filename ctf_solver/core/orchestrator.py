@@ -4,9 +4,10 @@ import signal
 import threading
 from dataclasses import dataclass
 from queue import Queue, Empty
-from typing import Callable, Dict, Optional, Set
+from typing import Any, Callable, Dict, Optional, Set
 
 from ctf_solver.core.runner import ChallengeRunner
+from ctf_solver.database.db import reserve_db_connections
 
 logger = logging.getLogger(__name__)
 
@@ -18,6 +19,7 @@ class _Job:
     on_attempt_finished: Optional[Callable[[int, str], None]] = None
     optimized_agent_name: Optional[str] = None
     use_presenter: bool = True
+    on_event: Optional[Callable[[str, int, Dict[str, Any]], None]] = None
 
 
 
@@ -29,6 +31,7 @@ class SimpleOrchestrator:
         max_parallel: int = 1,
         optimized_agent_name: Optional[str] = None,
         install_signal_handlers: bool = True,
+        backend: Optional[str] = None,
     ):
         if callable(db_factory):
             self._db_factory = db_factory  # type: ignore[assignment]
@@ -39,6 +42,7 @@ class SimpleOrchestrator:
 
         self.max_parallel = max_parallel
         self.optimized_agent_name = optimized_agent_name
+        self.backend = backend
         self.job_queue: "Queue[_Job]" = Queue()
         self.workers = []
         self.active_runners: Set[ChallengeRunner] = set()
@@ -50,6 +54,8 @@ class SimpleOrchestrator:
             signal.signal(signal.SIGINT, self._handle_interrupt)
             signal.signal(signal.SIGTERM, self._handle_interrupt)
 
+        # Each worker's runner holds a pooled connection for its whole attempt
+        reserve_db_connections(max_parallel)
         for _ in range(max_parallel):
             worker = threading.Thread(target=self._worker, daemon=True)
             worker.start()
@@ -63,6 +69,7 @@ class SimpleOrchestrator:
         on_attempt_finished: Optional[Callable[[int, str], None]] = None,
         optimized_agent_name: Optional[str] = None,
         use_presenter: bool = True,
+        on_event: Optional[Callable[[str, int, Dict[str, Any]], None]] = None,
     ) -> None:
         job = _Job(
             challenge_id=challenge_id,
@@ -70,6 +77,7 @@ class SimpleOrchestrator:
             on_attempt_finished=on_attempt_finished,
             optimized_agent_name=optimized_agent_name,
             use_presenter=use_presenter,
+            on_event=on_event,
         )
         self.job_queue.put(job)
 
@@ -81,6 +89,7 @@ class SimpleOrchestrator:
         on_attempt_finished: Optional[Callable[[int, str], None]] = None,
         optimized_agent_name: Optional[str] = None,
         use_presenter: bool = True,
+        on_event: Optional[Callable[[str, int, Dict[str, Any]], None]] = None,
     ) -> None:
         job = _Job(
             challenge_id=challenge_id,
@@ -88,6 +97,7 @@ class SimpleOrchestrator:
             on_attempt_finished=on_attempt_finished,
             optimized_agent_name=optimized_agent_name,
             use_presenter=use_presenter,
+            on_event=on_event,
         )
         await asyncio.to_thread(self._run_job, job)
 
@@ -117,6 +127,8 @@ class SimpleOrchestrator:
             f"exegol_{job.challenge_id}",
             use_presenter=job.use_presenter,
             optimized_agent_name=job.optimized_agent_name or self.optimized_agent_name,
+            backend=self.backend,
+            on_event=job.on_event,
         )
 
         def _on_attempt_created(attempt_id: int) -> None:
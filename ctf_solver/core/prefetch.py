@@ -0,0 +1,180 @@
+"""
+Speculative prefetch of cheap triage commands while the LLM is thinking
+
+Each step spends seconds waiting on the model while the backend sits idle. Before
+the agent call, the runner asks the Prefetcher to guess the next few commands:
+category-specific opening triage on the challenge binaries, plus the command that
+usually follows the agent's last one (`file` -> `checksec`, `checksec` ->
+`readelf -s`, ...). Only plain calls of the triage cache's pure tools are ever
+speculated; they read their operands and write nothing, so they run against the
+live workspace outside the shell session without side effects. When the agent's
+action is one of them, the finished (or already running) result is served instead
+of running the command again. Results also land in the triage cache, so a guess
+that only pays off a few steps later is still a cache hit.
+"""
+import logging
+import os
+import threading
+import time
+from concurrent.futures import Future, ThreadPoolExecutor
+from typing import Any, Dict, List, Optional, Tuple
+
+from ctf_solver.config import PREFETCH_MAX_COMMANDS
+from ctf_solver.containers.cache import command_operands, parse_triage_command
+
+
+logger = logging.getLogger(__name__)
+
+PREFETCH_TIMEOUT = 30
+
+# Opening triage per category; {f} is a challenge binary
+CATEGORY_TRIAGE = {
+    'pwn': ['checksec --file={f}', 'readelf -s {f}', 'objdump -d -M intel {f}'],
+    'reverse': ['strings -n 6 {f}', 'objdump -d -M intel {f}', 'readelf -s {f}'],
+    'rev': ['strings -n 6 {f}', 'objdump -d -M intel {f}', 'readelf -s {f}'],
+}
+DEFAULT_TRIAGE = ['file {f}', 'strings -n 6 {f}']
+
+# What the agent typically runs next on the same file
+FOLLOW_UPS = {
+    'file': ['checksec --file={f}', 'strings -n 6 {f}'],
+    'checksec': ['readelf -s {f}', 'objdump -d -M intel {f}'],
+    'strings': ['readelf -s {f}', 'objdump -d -M intel {f}'],
+    'readelf': ['objdump -d -M intel {f}', 'strings -n 6 {f}'],
+    'nm': ['objdump -d -M intel {f}'],
+    'rabin2': ['objdump -d -M intel {f}'],
+    'binwalk': ['strings -n 6 {f}'],
+}
+
+# Totals across attempts for the service metrics
+_totals = {'launched': 0, 'hits': 0, 'saved_ms': 0}
+_totals_lock = threading.Lock()
+
+
+def prefetch_stats() -> Dict[str, Any]:
+    with _totals_lock:
+        totals = dict(_totals)
+    totals['hit_rate'] = round(totals['hits'] / totals['launched'], 3) if totals['launched'] else None
+    return totals
+
+
+def _plain(arg: str) -> str:
+    """Drop a `./` prefix, also from option values (`--file=./vuln`)"""
+    option, sep, value = arg.rpartition('=') if arg.startswith('-') else ('', '', arg)
+    return option + sep + (value[2:] if value.startswith('./') else value)
+
+
+def _normalize(cmd: str) -> Optional[Tuple[str, ...]]:
+    """Comparable form of a speculable command: argv with `./` prefixes dropped, or None"""
+    argv = parse_triage_command(cmd)
+    if argv is None:
+        return None
+    return tuple([os.path.basename(argv[0])] + [_plain(arg) for arg in argv[1:]])
+
+
+class Prefetcher:
+    """Speculates triage commands for one attempt on a small thread pool"""
+
+    def __init__(self, backend, category: Optional[str], max_commands: int = PREFETCH_MAX_COMMANDS):
+        self.backend = backend
+        self.category = (category or '').lower()
+        self.max_commands = max_commands
+        self._pool = ThreadPoolExecutor(max_workers=2, thread_name_prefix='prefetch')
+        self._pending: Dict[Tuple[str, ...], Tuple[Future, float, str]] = {}
+        self._seen = set()  # speculated or issued by the agent; never guessed again
+        self.stats = {'launched': 0, 'hits': 0, 'waited': 0, 'saved_ms': 0}
+
+    def speculate(self, state: Dict[str, Any]) -> List[str]:
+        """Start this step's guesses (call right before the agent)"""
+        # Finished guesses from earlier steps may be stale now (the agent can patch files);
+        # the triage cache still serves them, keyed by file contents
+        self._pending = {key: entry for key, entry in self._pending.items() if not entry[0].done()}
+        launched = []
+        for cmd in self.predict(state):
+            key = _normalize(cmd)
+            if key is None or key in self._seen:
+                continue
+            self._seen.add(key)
+            cwd = self.backend.cwd
+            self._pending[key] = (self._pool.submit(self._run, cmd), time.time(), cwd)
+            launched.append(cmd)
+            if len(launched) >= self.max_commands:
+                break
+        self.stats['launched'] += len(launched)
+        if launched:
+            logger.debug(f"Prefetching: {launched}")
+        return launched
+
+    def predict(self, state: Dict[str, Any]) -> List[str]:
+        info = state.get('discovered_info') or {}
+        candidates = []
+        last = self._last_command(state.get('history') or [])
+        if last is not None:
+            tool, operand = last
+            candidates += [t.format(f=operand) for t in FOLLOW_UPS.get(tool, [])]
+        binary = info.get('binary')
+        if binary:
+            candidates += [t.format(f=binary) for t in CATEGORY_TRIAGE.get(self.category, DEFAULT_TRIAGE)]
+        return candidates
+
+    @staticmethod
+    def _last_command(history) -> Optional[Tuple[str, str]]:
+        """(tool, file operand) of the agent's latest pure triage command"""
+        for action, _ in reversed(history):
+            argv = parse_triage_command((action or {}).get('cmd') or '') if (action or {}).get('tool', 'bash') == 'bash' else None
+            if argv is None:
+                continue
+            operands = command_operands(argv)
+            if operands:
+                return os.path.basename(argv[0]), _plain(operands[-1])
+        return None
+
+    def take(self, action: Dict[str, Any]) -> Optional[Dict[str, Any]]:
+        """The speculative result for the agent's action, or None to execute it normally"""
+        if action.get('tool', 'bash') != 'bash':
+            return None
+        key = _normalize(action.get('cmd') or '')
+        if key is None:
+            return None
+        self._seen.add(key)
+        entry = self._pending.pop(key, None)
+        if entry is None:
+            return None
+        future, started, cwd = entry
+        if cwd != self.backend.cwd:
+            return None
+        if not future.done():
+            # Still queued behind other guesses: cheaper to run it directly than wait
+            if not future.running():
+                future.cancel()
+                return None
+            self.stats['waited'] += 1
+        try:
+            result = future.result(timeout=PREFETCH_TIMEOUT)
+        except Exception as e:
+            logger.debug(f"Prefetched {action.get('cmd')!r} unusable: {e}")
+            return None
+        if result.get('error'):
+            return None
+        saved_ms = int(min(time.time() - started, result.get('_ms', 0) / 1000) * 1000)
+        self.stats['hits'] += 1
+        self.stats['saved_ms'] += saved_ms
+        return {**{k: v for k, v in result.items() if k != '_ms'}, 'cwd': self.backend.cwd, 'prefetched': True}
+
+    def _run(self, cmd: str) -> Dict[str, Any]:
+        start = time.time()
+        result = self.backend.execute_concurrent({'tool': 'bash', 'cmd': cmd, 'timeout_seconds': PREFETCH_TIMEOUT})
+        result['_ms'] = int((time.time() - start) * 1000)
+        return result
+
+    def summary(self) -> Dict[str, Any]:
+        launched = self.stats['launched']
+        return {**self.stats, 'hit_rate': round(self.stats['hits'] / launched, 3) if launched else None}
+
+    def close(self) -> None:
+        self._pool.shutdown(wait=False, cancel_futures=True)
+        with _totals_lock:
+            for k in _totals:
+                _totals[k] += self.stats[k]
+        if self.stats['launched']:
+            logger.info(f"Prefetch: {self.summary()}")
@@ -3,18 +3,34 @@ import time
 import json
 import logging
 import threading
-from typing import Optional, Dict, Any, List, Callable
+from typing import Optional, Dict, Any, List, Callable, Tuple
 
-from ctf_solver.containers.exegol import ExegolContainer
+from ctf_solver.containers.backends import create_backend
 from ctf_solver.agent.dspy_agent import CTFAgent
-from ctf_solver.config import EXEGOL_TOOLS, MAX_OUTPUT_TOKENS, MAX_OUTPUT_CHARS, CTF_OUTER_MAX_STEPS
+from ctf_solver.analysis.facts import WorkspaceFacts
+from ctf_solver.analysis.flags import FlagMatcher
+from ctf_solver.analysis.xorscan import XorScanner
+from ctf_solver.config import (EXEGOL_TOOLS, MAX_OUTPUT_TOKENS, MAX_OUTPUT_CHARS, CTF_OUTER_MAX_STEPS, XOR_SCAN_ENABLED,
+                               FUZZ_ENABLED, FUZZ_WORKERS, PREFETCH_ENABLED, EVENT_OUTPUT_CHUNK)
 from ctf_solver.core.challenge_manager import ChallengeManager
+from ctf_solver.core.prefetch import Prefetcher
+from ctf_solver.database.blobs import blob_tables_exist, blobs_writable, full_output, split_output, store_blobs
+from ctf_solver.database.writer import get_step_writer
 from ctf_solver.ui.cli_presenter import CLIPresenter
 
 
 logger = logging.getLogger(__name__)
 
 
+def describe_action(action: Dict[str, Any]) -> str:
+    """One-line label for an action (batch headers and step display)"""
+    tool = action.get('tool', 'bash')
+    if tool == 'bash':
+        return f"$ {action.get('cmd', '')}"
+    target = action.get('filename') or action.get('binary') or action.get('job_id') or action.get('cmd') or action.get('code') or ''
+    return f"{tool} {target}".rstrip()
+
+
 class ChallengeRunner:
     def __init__(
         self,
@@ -24,16 +40,26 @@ class ChallengeRunner:
         optimized_agent_name: str = None,
         on_attempt_created: Optional[Callable[[int], None]] = None,
         on_attempt_finished: Optional[Callable[[int, str], None]] = None,
+        backend: Optional[str] = None,
+        on_event: Optional[Callable[[str, int, Dict[str, Any]], None]] = None,
     ):
         self.db = db_conn
         self.container_name = container_name
         self.container = None  # Will be initialized with mounts in run_attempt
         self.agent = None  # Will be created fresh for each attempt
         self.optimized_agent_name = optimized_agent_name
+        self.backend = backend  # None: challenge metadata, then FLAGGY_BACKEND
+        self._workspace_facts: Optional[WorkspaceFacts] = None
+        self._fuzzer = None
+        self._prefetcher: Optional[Prefetcher] = None
+        self._flag_matcher: Optional[FlagMatcher] = None  # compiled once per attempt from flag_format
+        self._step_writer = get_step_writer()  # None: steps are committed one by one on this thread
+        self._steps_since = 0  # step writer mark() taken when the attempt was created
         self.challenge_manager = ChallengeManager()
         self.presenter = CLIPresenter() if use_presenter else None
         self.on_attempt_created = on_attempt_created
         self.on_attempt_finished = on_attempt_finished
+        self.on_event = on_event  # (kind, attempt_id, fields): live progress for service subscribers
         self._stop_event = threading.Event()
         self.current_attempt_id: Optional[int] = None
         self._finished_notified = False
@@ -57,6 +83,7 @@ class ChallengeRunner:
     def _encode_output_for_bytea(self, output: str) -> bytes:
         """
         Encode command output as bytes for BYTEA storage.
+        Long outputs are moved to output_blobs (or truncated) when the step is stored.
         
         Args:
             output: Raw command output string
@@ -68,12 +95,6 @@ class ChallengeRunner:
             return b''
         
         try:
-            # Truncate very long outputs to prevent database bloat
-            max_length = 100000  # 100KB limit
-            if len(output) > max_length:
-                truncated = output[:max_length] + f"\n\n<TRUNCATED: {len(output) - max_length} more chars>"
-                return truncated.encode('utf-8', errors='replace')
-            
             return output.encode('utf-8', errors='replace')
             
         except Exception as e:
@@ -110,6 +131,14 @@ class ChallengeRunner:
         stderr = result.get('stderr', '')
         total_output = stdout + stderr
         
+        output_meta = result.get('output_meta') or {}
+        if output_meta.get('truncated'):
+            # Already cut down to head + tail while streaming; keep it and tell the agent
+            note = (f"Output truncated: {output_meta.get('total_bytes', 0):,} bytes produced, showing head and tail. "
+                    "Use filters (| grep, | head, | tail) or narrower options for targeted output.")
+            result['stderr'] = f"{stderr}\n{note}" if stderr else note
+            return result
+        
         if len(total_output) > MAX_OUTPUT_CHARS:
             # Replace large output with helpful error message
             guidance_msg = f"""Command output too large ({len(total_output):,} characters, ~{len(total_output)//4:,} tokens).
@@ -140,6 +169,8 @@ Try a more specific command that focuses on what you need to find."""
         # Create attempt record first (without container name)
         attempt_id = self._create_attempt(challenge_id)
         self.current_attempt_id = attempt_id
+        if self._step_writer:
+            self._steps_since = self._step_writer.mark()
         if self._stop_event.is_set():
             self._mark_cancelled(attempt_id)
             self._notify_attempt_finished(attempt_id, "cancelled")
@@ -171,9 +202,16 @@ Try a more specific command that focuses on what you need to find."""
             else:
                 self.agent = CTFAgent(container=None)  # Container will be set after creation
             
-            self.container = ExegolContainer(
+            cursor = self.db.cursor()
+            cursor.execute("SELECT flag_format, category FROM challenges WHERE id = %s", (challenge_id,))
+            row = cursor.fetchone()
+            self._flag_matcher = FlagMatcher.for_format(row[0] if row else None)
+            
+            self.container = create_backend(
                 container_name,
-                mounts=container_mounts
+                mounts=container_mounts,
+                kind=self.backend or self.challenge_manager.get_challenge_backend(challenge_id),
+                flag_format=row[0] if row else None
             )
             
             # Update agent with container reference for ReAct tools
@@ -194,6 +232,44 @@ Try a more specific command that focuses on what you need to find."""
                 'last_output': f'Challenge initialized. Directory contents:\n{ls_output}\nAvailable tool categories: binary_analysis, debugging, exploitation, network, web, crypto, forensics, reverse_engineering, mobile, osint, post_exploitation, utilities. Request tools with action_type="get_tools".',
                 'discovered_info': {}
             }
+            self._workspace_facts = WorkspaceFacts(self.container)
+            state['discovered_info'].update(self._workspace_facts.refresh())
+            
+            # Precomputed static analysis saves the usual file/checksec/strings/objdump opening steps
+            try:
+                analysis = self.challenge_manager.get_challenge_analysis(challenge_id)
+            except Exception as e:
+                logger.warning(f"Static analysis unavailable for challenge {challenge_id}: {e}")
+                analysis = None
+            if analysis:
+                state['last_output'] += f'\n\nPrecomputed static analysis of the challenge files (no need to re-run file/checksec/strings for this):\n{analysis}'
+            
+            # Flags hidden behind XOR/ADD/ROT are common in beginner reversing; finding them costs milliseconds
+            if XOR_SCAN_ENABLED:
+                try:
+                    encoded = XorScanner(row[0] if row else None).scan_directory(work_dir)
+                except Exception as e:
+                    logger.warning(f"Encoded-flag scan failed for challenge {challenge_id}: {e}")
+                    encoded = []
+                if encoded:
+                    state['discovered_info']['encoded_flags'] = encoded
+                    lines = '\n'.join(
+                        f"  {f['file']} @ {f['offset']:#x}: {f['flag']} ({f['encoding']} key {f['key']}"
+                        f"{', stack string' if f.get('stack_string') else ''})" for f in encoded)
+                    state['last_output'] += f'\n\nCandidate flags decoded from the challenge files (may include decoys; verify before submitting):\n{lines}'
+            
+            # Pwn binaries get fuzzed on otherwise idle cores while the agent waits on the LLM
+            self._fuzzer = None
+            target = state['discovered_info'].get('binary')
+            if FUZZ_ENABLED and target and row and (row[1] or '').lower() == 'pwn':
+                try:
+                    self._fuzzer = self.container.start_fuzzer(target, workers=FUZZ_WORKERS)
+                    state['last_output'] += f'\n\nA background fuzzer is running on {target}; new crashes will appear in discovered_info.fuzz_crashes.'
+                except Exception as e:
+                    logger.warning(f"Background fuzzer unavailable for challenge {challenge_id}: {e}")
+            
+            # Likely next triage commands run during each LLM call
+            self._prefetcher = Prefetcher(self.container, row[1] if row else None) if PREFETCH_ENABLED else None
             
             # Get challenge name for display
             cursor = self.db.cursor()
@@ -216,6 +292,7 @@ Try a more specific command that focuses on what you need to find."""
                     return None
                 # Record execution start time
                 start_time = time.time()
+                self._emit('step_started', attempt_id, step=step_num)
                 
                 try:
                     if not self.presenter:
@@ -225,6 +302,9 @@ Try a more specific command that focuses on what you need to find."""
                         # Start the thinking indicator
                         self.presenter.start_thinking()
                     
+                    if self._prefetcher is not None:
+                        self._prefetcher.speculate(state)
+                    
                     # Get agent response with reasoning (measure LLM time)
                     llm_start = time.time()
                     agent_response = self.agent(state)
@@ -244,6 +324,8 @@ Try a more specific command that focuses on what you need to find."""
                         
                         # Extract command from the action
                         command = action.get('cmd', '') if isinstance(action, dict) else str(action)
+                        if isinstance(action, dict) and action.get('tool') == 'batch':
+                            command = '\n'.join(describe_action(a) for a in action.get('actions') or [])
                         
                         # Display step with presenter or fallback to logging
                         if self.presenter:
@@ -289,19 +371,27 @@ Try a more specific command that focuses on what you need to find."""
                     return None
                 
                 # Execute in container for any well-formed action dict (supports bash/read_file/write_file)
+                prefetched = None
                 if action and isinstance(action, dict):
                     if not self.presenter:
                         logger.info(f"Step {step_num}: Executing action in container (tool={action.get('tool')})...")
                     shell_start = time.time()
-                    result = self.container.execute(action)
+                    prefetched = self._prefetcher.take(action) if self._prefetcher is not None else None
+                    if prefetched is not None:
+                        result = prefetched
+                    elif action.get('tool') == 'batch':
+                        result, batch_history = self._execute_batch(action)
+                    else:
+                        result = self.container.execute(action)
                     shell_duration = time.time() - shell_start
                 else:
                     result = {'stdout': '', 'stderr': '', 'exit_code': 0, 'tool': action.get('tool') if isinstance(action, dict) else 'bash'}
                     shell_duration = 0.0
                 # No extra rendering pass needed (we already showed the analysis/approach step above)
                 
-                # Check if output is too large and provide guidance if needed
-                result = self._check_output_size(result, command)
+                # Check if output is too large and provide guidance if needed (batch results were checked one by one)
+                if result.get('tool') != 'batch':
+                    result = self._check_output_size(result, command)
                 
                 if not self.presenter:
                     logger.info(f"Step {step_num}: Container execution complete")
@@ -312,7 +402,17 @@ Try a more specific command that focuses on what you need to find."""
                     result['execution_time_ms'] = int(total_duration * 1000)
                 
                 self._log_step(attempt_id, step_num, action, result)
-                state['history'].append((action, result))
+                self._emit_step_events(attempt_id, step_num, action, result, {
+                    'llm_ms': int(llm_duration * 1000),
+                    'shell_ms': int(shell_duration * 1000),
+                    'total_ms': int((time.time() - start_time) * 1000),
+                    'prefetched': prefetched is not None,
+                })
+                if result.get('tool') == 'batch':
+                    # One history entry per batch action, in the order the agent listed them
+                    state['history'].extend(batch_history)
+                else:
+                    state['history'].append((action, result))
                 
                 # Update last_output with full stdout+stderr
                 stdout = (result or {}).get('stdout', '')
@@ -322,10 +422,7 @@ Try a more specific command that focuses on what you need to find."""
                 # Display command output
                 if self.presenter:
                     # Get flag format for highlighting
-                    cursor = self.db.cursor()
-                    cursor.execute("SELECT flag_format FROM challenges WHERE id = %s", (challenge_id,))
-                    format_result = cursor.fetchone()
-                    flag_format = format_result[0] if format_result else None
+                    flag_format = self._flag_matcher.flag_format
                     
                     # Build executed display line for non-bash tools like read_file
                     executed_display = None
@@ -360,18 +457,16 @@ Try a more specific command that focuses on what you need to find."""
                 flag = self._extract_flag_from_challenge(challenge_id, combined_display)
                 if flag:
                     # Get flag format for display
-                    cursor = self.db.cursor()
-                    cursor.execute("SELECT flag_format FROM challenges WHERE id = %s", (challenge_id,))
-                    format_result = cursor.fetchone()
-                    flag_format = format_result[0] if format_result else None
+                    flag_format = self._flag_matcher.flag_format
                     
                     if self.presenter:
                         self.presenter.show_flag_found(flag, flag_format)
                     else:
                         logger.info(f"Challenge {challenge_id} solved! Flag: {flag}")
+                    self._emit('flag_found', attempt_id, step=step_num, flag=flag)
                         
-                    self._mark_success(attempt_id, flag, step_num)
-                    self._notify_attempt_finished(attempt_id, "completed")
+                    status = self._mark_success(attempt_id, flag, step_num)
+                    self._notify_attempt_finished(attempt_id, status, flag)
                     return flag
                     
             self._mark_failed(attempt_id)
@@ -389,7 +484,11 @@ Try a more specific command that focuses on what you need to find."""
                 self._notify_attempt_finished(attempt_id, "failed")
             return None
         finally:
-            # Clean up container
+            # Clean up container (also stops the background fuzzer)
+            self._fuzzer = None
+            if self._prefetcher is not None:
+                self._prefetcher.close()
+                self._prefetcher = None
             if self.container:
                 self.container.cleanup()
             if attempt_id is not None:
@@ -407,26 +506,62 @@ Try a more specific command that focuses on what you need to find."""
     def stop_requested(self) -> bool:
         return self._stop_event.is_set()
 
+    def _execute_batch(self, action: Dict[str, Any]) -> Tuple[Dict[str, Any], List[Tuple[Dict[str, Any], Dict[str, Any]]]]:
+        """Run a batch step; returns the merged result (logged as one step) and per-action history entries"""
+        actions = action.get('actions') or []
+        if not actions:
+            return {'stdout': '', 'stderr': 'Empty batch: give one bash command per line in command, '
+                                         'or a JSON list of actions in content', 'exit_code': 1, 'tool': 'batch'}, []
+        results = self.container.execute_batch(actions)
+        history, parts, summary = [], [], []
+        for i, (sub, res) in enumerate(zip(actions, results), 1):
+            res = self._check_output_size(res, sub.get('cmd', ''))
+            if i == 1:
+                # The step's reasoning travels with the first entry, as for single actions
+                sub = {**sub, **{k: action[k] for k in ('analysis', 'approach') if action.get(k)}}
+            history.append((sub, res))
+            output = ((res.get('stdout') or '') + (res.get('stderr') or '')).rstrip() or res.get('error', '')
+            parts.append(f"===== [{i}/{len(actions)}] {describe_action(sub)} (exit {res.get('exit_code')}) =====\n{output}")
+            summary.append({'tool': res.get('tool', sub.get('tool')), 'exit_code': res.get('exit_code'),
+                            **({'error': res['error']} if res.get('error') else {})})
+        failed = [s['exit_code'] for s in summary if s['exit_code']]
+        return {'stdout': '\n\n'.join(parts) + '\n', 'stderr': '', 'exit_code': failed[0] if failed else 0,
+                'tool': 'batch', 'batch': summary}, history
+
     def _analyze_result_for_state(self, state: Dict[str, Any], result: Dict[str, Any]):
-        """Analyze command result and update state with discovered information"""
-        if not result or 'stdout' not in result:
+        """Refresh discovered binary facts from the workspace (picks up binaries the agent built or patched)
+        and pick up crashes the background fuzzer found since the last step"""
+        if self._fuzzer is not None:
+            self._collect_fuzz_crashes(state)
+        if result.get('job'):
+            # Latest known state of each detached job, so the agent remembers what is still running
+            job = result['job']
+            state['discovered_info'].setdefault('jobs', {})[job['id']] = {
+                k: job.get(k) for k in ('status', 'exit_code', 'output_bytes', 'elapsed_s')}
+        if self._workspace_facts is None:
             return
-            
-        stdout = result.get('stdout', '')
-        discovered = state['discovered_info']
-        
-        # Simple pattern detection - let DSPy learn what matters
-        if 'ELF 64-bit' in stdout:
-            discovered['arch'] = 'x86_64'
-        elif 'ELF 32-bit' in stdout:
-            discovered['arch'] = 'i386'
-            
-        if 'NX enabled' in stdout:
-            discovered['nx'] = True
-        if 'Canary found' in stdout:
-            discovered['canary'] = True
-        if 'PIE enabled' in stdout:
-            discovered['pie'] = True
+        try:
+            state['discovered_info'].update(self._workspace_facts.refresh())
+        except Exception as e:
+            logger.debug(f"Workspace fact refresh failed: {e}")
+
+    def _collect_fuzz_crashes(self, state: Dict[str, Any]) -> None:
+        try:
+            new = self._fuzzer.poll()
+        except Exception as e:
+            logger.debug(f"Background fuzzer poll failed: {e}")
+            return
+        if self._fuzzer.stats:
+            state['discovered_info']['fuzz_stats'] = {k: self._fuzzer.stats.get(k)
+                                                      for k in ('execs', 'execs_per_sec', 'buckets', 'elapsed')}
+        if not new:
+            return
+        state['discovered_info']['fuzz_crashes'] = [
+            {k: c.get(k) for k in ('bucket', 'signal', 'crash_pc', 'fault_addr', 'crash_stack_word', 'input', 'input_len')}
+            for c in self._fuzzer.crashes[-10:]]
+        lines = '\n'.join(f"  signal {c.get('signal')} at pc {c.get('crash_pc')} ([sp]={c.get('crash_stack_word')}),"
+                          f" input {c.get('input')} ({c.get('input_len')} bytes)" for c in new)
+        state['last_output'] += f'\n\n[background fuzzer] {len(new)} new crash bucket(s):\n{lines}'
 
     def _create_attempt(self, challenge_id: int) -> int:
         """Create a new attempt record in database"""
@@ -445,6 +580,7 @@ Try a more specific command that focuses on what you need to find."""
                     self.on_attempt_created(attempt_id)
                 except Exception as callback_exc:  # noqa: BLE001
                     logger.warning("Attempt created callback failed: %s", callback_exc)
+            self._emit('attempt_created', attempt_id, challenge_id=challenge_id)
             return attempt_id
         except Exception as e:
             logger.error(f"Failed to create attempt: {e}")
@@ -453,6 +589,10 @@ Try a more specific command that focuses on what you need to find."""
     
     def _update_attempt_container(self, attempt_id: int, container_name: str):
         """Update attempt record with container name"""
+        if self._step_writer:
+            self._step_writer.execute_later("UPDATE attempts SET container_name = %s WHERE id = %s",
+                                            (container_name, attempt_id))
+            return
         try:
             cursor = self.db.cursor()
             cursor.execute("""
@@ -465,25 +605,40 @@ Try a more specific command that focuses on what you need to find."""
             self.db.rollback()
 
     def _log_step(self, attempt_id: int, step_num: int, action: Dict[str, Any], result: Dict[str, Any]):
-        """Log a step execution to database"""
+        """Log a step execution to database (queued on the step writer when enabled)"""
         try:
-            cursor = self.db.cursor()
-            
             # Extract relevant data from result
             output = result.get('stdout', '') + result.get('stderr', '')
             exit_code = result.get('exit_code')
             tool = result.get('tool', action.get('tool', 'bash'))
+            if result.get('job'):
+                # Job actions record which job they touched and its state at that step
+                action = {**action, 'job': result['job']}
             
             # Calculate execution time if available
             execution_time = result.get('execution_time_ms')
             
             # Encode output as bytes for BYTEA storage
             output_bytes = self._encode_output_for_bytea(output)
-            
-            cursor.execute("""
-                INSERT INTO steps (attempt_id, step_num, action, output, exit_code, tool, execution_time_ms)
-                VALUES (%s, %s, %s, %s, %s, %s, %s)
-            """, (attempt_id, step_num, json.dumps(action), output_bytes, exit_code, tool, execution_time))
+
+            if self._step_writer:
+                self._step_writer.submit_step(attempt_id, step_num, json.dumps(action), output_bytes,
+                                              exit_code, tool, execution_time)
+                return
+
+            cursor = self.db.cursor()
+            inline, digest = split_output(output_bytes, blobs_writable(cursor))
+            if digest:
+                store_blobs(cursor, {digest: output_bytes})
+                cursor.execute("""
+                    INSERT INTO steps (attempt_id, step_num, action, output, exit_code, tool, execution_time_ms, output_hash)
+                    VALUES (%s, %s, %s, %s, %s, %s, %s, %s)
+                """, (attempt_id, step_num, json.dumps(action), inline, exit_code, tool, execution_time, digest))
+            else:
+                cursor.execute("""
+                    INSERT INTO steps (attempt_id, step_num, action, output, exit_code, tool, execution_time_ms)
+                    VALUES (%s, %s, %s, %s, %s, %s, %s)
+                """, (attempt_id, step_num, json.dumps(action), inline, exit_code, tool, execution_time))
             
             # Update attempt total_steps
             cursor.execute("""
@@ -497,73 +652,29 @@ Try a more specific command that focuses on what you need to find."""
             logger.error(f"Failed to log step: {e}")
             self.db.rollback()
 
+    def _flush_steps(self, attempt_id: int) -> bool:
+        """Make queued steps durable before the attempt is finished or read back (False if some were lost)"""
+        if self._step_writer and not self._step_writer.flush(since=self._steps_since):
+            logger.error(f"Steps of attempt {attempt_id} were dropped or timed out before being written")
+            return False
+        return True
+
     def _extract_flag_from_challenge(self, challenge_id: int, stdout: str) -> Optional[str]:
-        """Extract flag using the challenge's specific flag_format from metadata"""
+        """Extract a flag with the attempt's compiled matcher for the challenge's flag_format
+        (as printed, after a `flag:` label, or base64/hex/reversed/URL-encoded)"""
         if not stdout:
             return None
             
         try:
-            # Get the flag format from challenge metadata
-            cursor = self.db.cursor()
-            cursor.execute("SELECT flag_format FROM challenges WHERE id = %s", (challenge_id,))
-            result = cursor.fetchone()
-            
-            if not result:
-                # Fallback to standard patterns if no metadata
-                flag_format = r'picoCTF\{[^}]+\}'
-            else:
-                flag_format = result[0]
-            
-            # Use the challenge's specific flag format
-            matches = re.findall(flag_format, stdout, re.IGNORECASE | re.MULTILINE)
-            if matches:
-                flag = matches[0].strip()
-                # Sanity-check to avoid placeholders like %s or template tokens
-                try:
-                    inner_match = re.search(r"\{([^}]*)\}", flag)
-                    inner = inner_match.group(1) if inner_match else ""
-                except Exception:
-                    inner = ""
-                placeholder_like = bool(re.fullmatch(r"\s*%[a-zA-Z]|%\(.*?\)[sd]|\{\w+\}|\s*", inner))
-                too_short = len(inner) < 4
-                if placeholder_like or too_short:
-                    logger.debug(f"Discarding suspicious flag candidate: {flag}")
-                else:
-                    if self.presenter:
-                        logger.info(f"Flag found using format '{flag_format}': {flag}")
-                    else:
-                        logger.info(f"Flag extracted: {flag}")
-                    return flag
-                
-            # Also check for common flag indicators in output even if format doesn't match
-            flag_indicators = [
-                r'Flag:\s*([^\s\n]+)',
-                r'flag:\s*([^\s\n]+)',
-                r'FLAG:\s*([^\s\n]+)',
-            ]
-            
-            for pattern in flag_indicators:
-                matches = re.findall(pattern, stdout, re.IGNORECASE | re.MULTILINE)
-                if matches:
-                    potential_flag = matches[0].strip()
-                    # Verify it matches the expected format
-                    if re.match(flag_format, potential_flag, re.IGNORECASE):
-                        # Apply same sanity check to avoid placeholders
-                        try:
-                            inner_match = re.search(r"\{([^}]*)\}", potential_flag)
-                            inner = inner_match.group(1) if inner_match else ""
-                        except Exception:
-                            inner = ""
-                        placeholder_like = bool(re.fullmatch(r"\s*%[a-zA-Z]|%\(.*?\)[sd]|\{\w+\}|\s*", inner))
-                        too_short = len(inner) < 4
-                        if not (placeholder_like or too_short):
-                            if self.presenter:
-                                logger.info(f"Flag found via indicator, verified with format: {potential_flag}")
-                            else:
-                                logger.info(f"Flag extracted: {potential_flag}")
-                            return potential_flag
-            
-            return None
+            if self._flag_matcher is None:
+                cursor = self.db.cursor()
+                cursor.execute("SELECT flag_format FROM challenges WHERE id = %s", (challenge_id,))
+                result = cursor.fetchone()
+                self._flag_matcher = FlagMatcher.for_format(result[0] if result else None)
+            flag = self._flag_matcher.find(stdout)
+            if flag:
+                logger.info(f"Flag found using format '{self._flag_matcher.flag_format}': {flag}")
+            return flag
             
         except Exception as e:
             logger.error(f"Error in flag extraction: {e}")
@@ -595,23 +706,31 @@ Try a more specific command that focuses on what you need to find."""
             logger.error(f"Error extracting flag: {e}")
             return None
 
-    def _mark_success(self, attempt_id: int, flag: str, step_num: int):
-        """Mark attempt as successful with flag"""
+    def _mark_success(self, attempt_id: int, flag: str, step_num: int) -> str:
+        """Mark attempt as successful with flag and return the status recorded; an attempt
+        whose steps were not all written keeps its flag but is marked failed, so its
+        incomplete trajectory is never treated as a solve"""
+        status = 'completed' if self._flush_steps(attempt_id) else 'failed'
         try:
             cursor = self.db.cursor()
             cursor.execute("""
                 UPDATE attempts 
-                SET status = 'completed', flag = %s, total_steps = %s, completed_at = NOW()
+                SET status = %s, flag = %s, total_steps = %s, completed_at = NOW()
                 WHERE id = %s
-            """, (flag, step_num + 1, attempt_id))
+            """, (status, flag, step_num + 1, attempt_id))
             self.db.commit()
-            logger.info(f"Marked attempt {attempt_id} as successful with flag: {flag}")
+            if status == 'completed':
+                logger.info(f"Marked attempt {attempt_id} as successful with flag: {flag}")
+            else:
+                logger.error(f"Marked attempt {attempt_id} as failed: flag {flag} found but steps were lost")
         except Exception as e:
             logger.error(f"Failed to mark success: {e}")
             self.db.rollback()
+        return status
 
     def _get_attempt_data(self, attempt_id: int) -> Dict[str, Any]:
         """Get attempt data from database"""
+        self._flush_steps(attempt_id)
         try:
             cursor = self.db.cursor()
             
@@ -627,20 +746,27 @@ Try a more specific command that focuses on what you need to find."""
             
             status, flag, total_steps, started_at, completed_at = attempt_row
             
-            # Get all steps
-            cursor.execute("""
-                SELECT step_num, action, output, exit_code, tool, created_at
-                FROM steps WHERE attempt_id = %s ORDER BY step_num
-            """, (attempt_id,))
+            # Get all steps, with the full output of those stored as blobs
+            if blob_tables_exist(cursor):
+                cursor.execute("""
+                    SELECT s.step_num, s.action, s.output, s.exit_code, s.tool, s.created_at, b.dict_id, b.data
+                    FROM steps s LEFT JOIN output_blobs b ON b.hash = s.output_hash
+                    WHERE s.attempt_id = %s ORDER BY s.step_num
+                """, (attempt_id,))
+            else:
+                cursor.execute("""
+                    SELECT step_num, action, output, exit_code, tool, created_at, NULL, NULL
+                    FROM steps WHERE attempt_id = %s ORDER BY step_num
+                """, (attempt_id,))
             steps_rows = cursor.fetchall()
             
             steps = []
             for row in steps_rows:
-                step_num, action, output, exit_code, tool, created_at = row
+                step_num, action, output, exit_code, tool, created_at, dict_id, blob = row
                 steps.append({
                     'step_num': step_num,
                     'action': action,
-                    'output': output,
+                    'output': full_output(output, dict_id, blob, cursor),
                     'exit_code': exit_code,
                     'tool': tool,
                     'timestamp': created_at
@@ -661,6 +787,7 @@ Try a more specific command that focuses on what you need to find."""
 
     def _mark_failed(self, attempt_id: int):
         """Mark attempt as failed"""
+        self._flush_steps(attempt_id)
         try:
             cursor = self.db.cursor()
             cursor.execute("""
@@ -676,6 +803,7 @@ Try a more specific command that focuses on what you need to find."""
             
     def _mark_cancelled(self, attempt_id: int):
         """Mark attempt as cancelled."""
+        self._flush_steps(attempt_id)
         try:
             cursor = self.db.cursor()
             cursor.execute(
@@ -694,7 +822,7 @@ Try a more specific command that focuses on what you need to find."""
             logger.error("Failed to mark attempt as cancelled: %s", exc)
             self.db.rollback()
 
-    def _notify_attempt_finished(self, attempt_id: int, status: str) -> None:
+    def _notify_attempt_finished(self, attempt_id: int, status: str, flag: Optional[str] = None) -> None:
         if self._finished_notified:
             return
         self._finished_notified = True
@@ -703,6 +831,41 @@ Try a more specific command that focuses on what you need to find."""
                 self.on_attempt_finished(attempt_id, status)
             except Exception as exc:  # noqa: BLE001
                 logger.warning("Attempt finished callback failed: %s", exc)
+        # After the status update above (and the _mark_* flush), so subscribers see the final state
+        self._emit('finished', attempt_id, status=status, flag=flag)
+
+    def _emit(self, kind: str, attempt_id: int, **fields: Any) -> None:
+        if self.on_event is None:
+            return
+        try:
+            self.on_event(kind, attempt_id, fields)
+        except Exception as exc:  # noqa: BLE001
+            logger.warning("Attempt event callback failed: %s", exc)
+
+    def _emit_step_events(self, attempt_id: int, step_num: int, action: Any, result: Dict[str, Any],
+                          timings: Dict[str, Any]) -> None:
+        """Output chunks now, step_finished once the step is committed (so subscribers can read it back)"""
+        if self.on_event is None:
+            return
+        for stream in ('stdout', 'stderr'):
+            text = result.get(stream) or ''
+            for offset in range(0, len(text), EVENT_OUTPUT_CHUNK):
+                self._emit('output', attempt_id, step=step_num, stream=stream, offset=offset,
+                           data=text[offset:offset + EVENT_OUTPUT_CHUNK])
+        fields = {
+            'step': step_num,
+            'action': describe_action(action) if isinstance(action, dict) else str(action),
+            'tool': result.get('tool') or (action.get('tool') if isinstance(action, dict) else None),
+            'exit_code': result.get('exit_code'),
+            **timings,
+        }
+        if self._step_writer:
+            try:
+                self._step_writer.call_after_commit(lambda: self._emit('step_finished', attempt_id, **fields))
+                return
+            except RuntimeError:  # writer closed at exit
+                pass
+        self._emit('step_finished', attempt_id, **fields)
 
     def _create_streaming_callback(self, step_num: int, challenge_id: int):
         """Create a streaming callback for real-time ReAct display"""
@@ -779,13 +942,7 @@ Try a more specific command that focuses on what you need to find."""
             elif event_type == 'flag_detected':
                 # If a live flag is detected, display it and record for early termination
                 flag = data.get('flag', '')
-                try:
-                    cursor = self.db.cursor()
-                    cursor.execute("SELECT flag_format FROM challenges WHERE id = %s", (challenge_id,))
-                    format_result = cursor.fetchone()
-                    flag_format = format_result[0] if format_result else None
-                except Exception:
-                    flag_format = None
+                flag_format = self._flag_matcher.flag_format if self._flag_matcher else None
                 self.presenter.show_flag_found(flag, flag_format)
                 self._live_flag = True
                 self._live_flag_value = flag
@@ -0,0 +1,295 @@
+"""
+Content-addressed, compressed storage of step output
+
+Outputs longer than PREVIEW_BYTES are stored once in output_blobs, keyed by the
+SHA-256 of the raw bytes and deflated with a preset dictionary, and steps
+reference them through output_hash. steps.output keeps only the first
+PREVIEW_BYTES as a preview, so the TUI and the past-run summaries read steps
+exactly as before; readers that need the whole output join output_blobs and call
+full_output(). Shorter outputs stay inline with a NULL hash, as do rows written
+before the migration.
+
+Tool output is repetitive across attempts (`ls -la` listings, checksec tables,
+readelf headers), so the codec primes deflate with a dictionary: dictionary 0 is
+built in, and `flaggy db train-output-dict` derives a better one from the lines
+that recur most in stored outputs. New blobs use the newest dictionary; each blob
+records which one it needs.
+"""
+import hashlib
+import logging
+import threading
+import zlib
+from collections import Counter
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+
+from ctf_solver.config import OUTPUT_BLOBS_ENABLED
+
+
+logger = logging.getLogger(__name__)
+
+PREVIEW_BYTES = 512  # the TUI shows at most 500 characters of a step's output
+INLINE_MAX_BYTES = 100000  # inline outputs are truncated here when blobs are off
+ZLIB_LEVEL = 6
+MAX_DICT_BYTES = 32 * 1024  # deflate only looks back 32KB
+
+# Fragments of common tool output; deflate prefers nearer matches, so the most common come last
+BUILTIN_DICT = b"""\
+Traceback (most recent call last):
+  File "<stdin>", line 1, in <module>
+Segmentation fault (core dumped)
+Permission denied
+No such file or directory
+command not found
+    Arch:     amd64-64-little
+    RELRO:    Partial RELRO
+    RELRO:    Full RELRO
+    Stack:    No canary found
+    Stack:    Canary found
+    NX:       NX enabled
+    PIE:      No PIE (0x400000)
+    PIE:      PIE enabled
+    SHSTK:    Enabled
+    IBT:      Enabled
+    Stripped:   No
+ELF Header:
+  Magic:   7f 45 4c 46 02 01 01 00 00 00 00 00 00 00 00 00
+  Class:                             ELF64
+  Data:                              2's complement, little endian
+  OS/ABI:                            UNIX - System V
+  Type:                              EXEC (Executable file)
+  Type:                              DYN (Position-Independent Executable file)
+  Machine:                           Advanced Micro Devices X86-64
+Symbol table '.symtab' contains
+   Num:    Value          Size Type    Bind   Vis      Ndx Name
+     0: 0000000000000000     0 NOTYPE  LOCAL  DEFAULT  UND
+0000000000000000     0 FUNC    GLOBAL DEFAULT  UND
+Disassembly of section .text:
+Disassembly of section .plt:
+file format elf64-x86-64
+	mov    rbp,rsp
+	push   rbp
+	sub    rsp,0x
+	call
+	lea    rax,[rip+0x
+	mov    eax,0x0
+	mov    rdi,rax
+	leave
+	ret
+	nop
+ELF 64-bit LSB executable, x86-64, version 1 (SYSV), dynamically linked, interpreter /lib64/ld-linux-x86-64.so.2, for GNU/Linux 3.2.0, not stripped
+ELF 64-bit LSB pie executable, x86-64, version 1 (SYSV), dynamically linked, interpreter /lib64/ld-linux-x86-64.so.2, BuildID[sha1]=
+, for GNU/Linux 3.2.0, stripped
+ASCII text
+total
+drwxr-xr-x 2 root root 4096
+drwxr-xr-x 3 root root 4096
+-rw-r--r-- 1 root root
+-rwxr-xr-x 1 root root
+"""
+
+
+def output_hash(raw: bytes) -> bytes:
+    return hashlib.sha256(raw).digest()
+
+
+def train_dictionary(samples: Iterable[bytes], size: int = MAX_DICT_BYTES) -> bytes:
+    """Lines that recur across samples, most valuable (frequency x length) last, up to size bytes"""
+    counts: Counter = Counter()
+    for sample in samples:
+        counts.update(set(line for line in sample.splitlines(keepends=True) if 8 <= len(line) <= 512))
+    ranked = sorted((line for line, n in counts.items() if n > 1), key=lambda line: (counts[line] - 1) * len(line),
+                    reverse=True)
+    picked: List[bytes] = []
+    total = 0
+    for line in ranked:
+        if total + len(line) > size:
+            continue
+        picked.append(line)
+        total += len(line)
+    return b''.join(reversed(picked))
+
+
+class OutputCodec:
+    """Deflate with a preset dictionary; dictionaries are loaded from output_dicts by id"""
+
+    def __init__(self):
+        self.dicts: Dict[int, bytes] = {0: BUILTIN_DICT}
+        self._lock = threading.Lock()
+
+    @property
+    def current_id(self) -> int:
+        return max(self.dicts)
+
+    def load(self, cursor) -> None:
+        cursor.execute("SELECT id, data FROM output_dicts")
+        with self._lock:
+            for dict_id, data in cursor.fetchall():
+                self.dicts[dict_id] = bytes(data)
+
+    def compress(self, raw: bytes) -> Tuple[int, bytes]:
+        dict_id = self.current_id
+        compressor = zlib.compressobj(ZLIB_LEVEL, zdict=self.dicts[dict_id])
+        return dict_id, compressor.compress(raw) + compressor.flush()
+
+    def decompress(self, dict_id: int, data: bytes, cursor=None) -> bytes:
+        if dict_id not in self.dicts and cursor is not None:
+            self.load(cursor)
+        decompressor = zlib.decompressobj(zdict=self.dicts[dict_id])
+        return decompressor.decompress(bytes(data)) + decompressor.flush()
+
+
+_codec: Optional[OutputCodec] = None
+_codec_lock = threading.Lock()
+
+
+def get_output_codec(cursor=None) -> OutputCodec:
+    """Process-wide codec; the first call with a cursor loads trained dictionaries"""
+    global _codec
+    with _codec_lock:
+        if _codec is None:
+            _codec = OutputCodec()
+            if cursor is not None:
+                try:
+                    _codec.load(cursor)
+                except Exception as e:
+                    logger.debug(f"No trained output dictionaries loaded: {e}")
+                    cursor.connection.rollback()
+        return _codec
+
+
+_tables: Optional[bool] = None
+
+
+def blob_tables_exist(cursor) -> bool:
+    """Whether the output_blobs migration has been applied (checked once per process)"""
+    global _tables
+    if _tables is None:
+        cursor.execute("SELECT to_regclass('output_blobs') IS NOT NULL")
+        _tables = bool(cursor.fetchone()[0])
+        if not _tables:
+            logger.warning("output_blobs table missing (run `flaggy db migrate`); step output is stored inline")
+    return _tables
+
+
+def blobs_writable(cursor) -> bool:
+    return OUTPUT_BLOBS_ENABLED and blob_tables_exist(cursor)
+
+
+def split_output(raw: bytes, use_blobs: bool) -> Tuple[bytes, Optional[bytes]]:
+    """(value for steps.output, blob hash or None when the output stays inline)"""
+    if use_blobs and len(raw) > PREVIEW_BYTES:
+        return raw[:PREVIEW_BYTES], output_hash(raw)
+    if len(raw) > INLINE_MAX_BYTES:
+        return raw[:INLINE_MAX_BYTES] + f"\n\n<TRUNCATED: {len(raw) - INLINE_MAX_BYTES} more bytes>".encode(), None
+    return raw, None
+
+
+def store_blobs(cursor, blobs: Dict[bytes, bytes], codec: Optional[OutputCodec] = None) -> int:
+    """Insert the outputs (hash -> raw) not stored yet; returns how many were new"""
+    if not blobs:
+        return 0
+    codec = codec or get_output_codec(cursor)
+    cursor.execute("SELECT hash FROM output_blobs WHERE hash = ANY(%s)", (list(blobs),))
+    present = {bytes(row[0]) for row in cursor.fetchall()}
+    rows = []
+    for digest, raw in blobs.items():
+        if digest not in present:
+            dict_id, data = codec.compress(raw)
+            rows.append((digest, len(raw), dict_id, data))
+    if rows:
+        cursor.execute("""
+            INSERT INTO output_blobs (hash, size, dict_id, data)
+            SELECT * FROM unnest(%s::bytea[], %s::int[], %s::int[], %s::bytea[])
+            ON CONFLICT (hash) DO NOTHING
+        """, [list(column) for column in zip(*rows)])
+    return len(rows)
+
+
+def full_output(inline: Optional[bytes], dict_id: Optional[int], data: Optional[bytes], cursor=None) -> bytes:
+    """The complete output of a step row read with `LEFT JOIN output_blobs b ON b.hash = s.output_hash`"""
+    if data is None:
+        return bytes(inline or b'')
+    return get_output_codec(cursor).decompress(dict_id, data, cursor)
+
+
+# ===== Maintenance =====
+
+def compact_outputs(conn, batch: int = 500) -> Dict[str, Any]:
+    """Move inline outputs longer than the preview (rows from before the migration) into blobs"""
+    codec = get_output_codec(conn.cursor())
+    moved = inline_bytes = 0
+    last_id = 0
+    while True:
+        with conn.cursor() as cursor:
+            cursor.execute("""
+                SELECT id, output FROM steps
+                WHERE id > %s AND output_hash IS NULL AND length(output) > %s
+                ORDER BY id LIMIT %s
+            """, (last_id, PREVIEW_BYTES, batch))
+            rows = cursor.fetchall()
+            if not rows:
+                break
+            blobs = {}
+            updates = []
+            for step_id, output in rows:
+                raw = bytes(output)
+                digest = output_hash(raw)
+                blobs[digest] = raw
+                updates.append((raw[:PREVIEW_BYTES], digest, step_id))
+                inline_bytes += len(raw)
+            store_blobs(cursor, blobs, codec)
+            cursor.executemany("UPDATE steps SET output = %s, output_hash = %s WHERE id = %s", updates)
+        conn.commit()
+        moved += len(rows)
+        last_id = rows[-1][0]
+    return {'steps_moved': moved, 'inline_bytes_moved': inline_bytes, **output_storage_stats(conn)}
+
+
+def output_storage_stats(conn) -> Dict[str, Any]:
+    with conn.cursor() as cursor:
+        cursor.execute("""
+            SELECT count(*), COALESCE(sum(size), 0), COALESCE(sum(length(data)), 0) FROM output_blobs
+        """)
+        blobs, raw_bytes, stored_bytes = cursor.fetchone()
+        cursor.execute("""
+            SELECT count(*), count(output_hash), COALESCE(sum(b.size), 0) FROM steps s
+            LEFT JOIN output_blobs b ON b.hash = s.output_hash
+        """)
+        steps, referencing, referenced_bytes = cursor.fetchone()
+    conn.commit()
+    return {
+        'blobs': blobs, 'blob_raw_bytes': int(raw_bytes), 'blob_stored_bytes': int(stored_bytes),
+        'compression_ratio': round(raw_bytes / stored_bytes, 2) if stored_bytes else None,
+        'steps': steps, 'steps_with_blob': referencing,
+        'dedup_ratio': round(referenced_bytes / raw_bytes, 2) if raw_bytes else None,
+    }
+
+
+def train_output_dict(conn, samples: int = 2000, size: int = MAX_DICT_BYTES) -> Dict[str, Any]:
+    """Train a dictionary on recent outputs and make it the one new blobs use"""
+    codec = get_output_codec(conn.cursor())
+    with conn.cursor() as cursor:
+        cursor.execute("""
+            SELECT s.output, b.dict_id, b.data FROM steps s
+            LEFT JOIN output_blobs b ON b.hash = s.output_hash
+            WHERE length(s.output) > 0
+            ORDER BY s.id DESC LIMIT %s
+        """, (samples,))
+        outputs = [full_output(inline, dict_id, data, cursor) for inline, dict_id, data in cursor.fetchall()]
+        trained = train_dictionary(outputs, size)
+        if not trained:
+            return {'samples': len(outputs), 'dict_id': None}
+        cursor.execute("SELECT COALESCE(max(id), 0) + 1 FROM output_dicts")
+        dict_id = cursor.fetchone()[0]
+        cursor.execute("INSERT INTO output_dicts (id, data, samples) VALUES (%s, %s, %s)",
+                       (dict_id, trained, len(outputs)))
+    conn.commit()
+    codec.dicts[dict_id] = trained
+    # Report the gain on the samples themselves
+    before = sum(len(zlib.compress(o, ZLIB_LEVEL)) for o in outputs)
+    with_builtin = sum(len(c.compress(o) + c.flush()) for o in outputs
+                       for c in [zlib.compressobj(ZLIB_LEVEL, zdict=BUILTIN_DICT)])
+    with_trained = sum(len(c.compress(o) + c.flush()) for o in outputs
+                       for c in [zlib.compressobj(ZLIB_LEVEL, zdict=trained)])
+    return {'samples': len(outputs), 'dict_id': dict_id, 'dict_bytes': len(trained), 'raw_bytes': sum(map(len, outputs)),
+            'zlib_bytes': before, 'builtin_dict_bytes': with_builtin, 'trained_dict_bytes': with_trained}
@@ -1,34 +1,306 @@
 """
 Database connection and utilities for flaggy
+
+Connections come from one process-wide pool, so runners, the service and TUI
+refreshes reuse open sessions instead of paying a TCP + auth handshake each time.
+get_db_connection() hands out a pooled connection whose close() returns it to the
+pool; get_db_cursor() checks one out per thread (nested calls on the same thread
+share it and its transaction, committed by the outermost).
 """
-import psycopg
+import logging
+import threading
+import time
+from collections import deque
 from contextlib import contextmanager
-from typing import Generator
+from typing import Any, Deque, Dict, Generator, Optional, Tuple
+
+import psycopg
+from psycopg import pq
+
+from ctf_solver.config import DB_DSN, DB_POOL_CHECK_SECONDS, DB_POOL_MAX, DB_POOL_MIN, DB_POOL_TIMEOUT
+
+
+logger = logging.getLogger(__name__)
+
+# Idle connections above min_size are closed after this long unused
+POOL_MAX_IDLE_SECONDS = 300
+# Connections kept free beyond those reserved for attempts: service and TUI queries, and the
+# short lookups runners make while holding their own (the step writer connects outside the pool)
+POOL_HEADROOM = 4
+
+
+class PoolTimeout(psycopg.OperationalError):
+    """No connection became free within the pool timeout"""
+
+
+class ConnectionPool:
+    """Bounded pool of psycopg connections with checkout health checks and wait metrics"""
+
+    def __init__(self, dsn: str = DB_DSN, min_size: int = DB_POOL_MIN, max_size: int = DB_POOL_MAX,
+                 timeout: float = DB_POOL_TIMEOUT, check_after: float = DB_POOL_CHECK_SECONDS):
+        self.dsn = dsn
+        self.max_size = max(1, max_size)
+        self.min_size = max(0, min(min_size, self.max_size))
+        self.timeout = timeout
+        self.check_after = check_after
+        self._idle: Deque[Tuple[psycopg.Connection, float]] = deque()  # (connection, returned at), newest last
+        self._size = 0  # open connections, idle or checked out
+        self._cond = threading.Condition()
+        self._local = threading.local()
+        self._closed = False
+        self._stats = {'checkouts': 0, 'waits': 0, 'wait_ms_total': 0, 'wait_ms_max': 0, 'timeouts': 0,
+                       'saturated': 0, 'opened': 0, 'closed': 0, 'health_check_failures': 0}
+
+    # ===== Checkout =====
+
+    def getconn(self, timeout: Optional[float] = None) -> psycopg.Connection:
+        """Check out a healthy connection, opening one while below max_size, else waiting"""
+        timeout = self.timeout if timeout is None else timeout
+        start = time.perf_counter()
+        waited = False
+        while True:
+            with self._cond:
+                if self._closed:
+                    raise psycopg.OperationalError("connection pool is closed")
+                conn, returned = None, 0.0
+                if self._idle:
+                    conn, returned = self._idle.pop()
+                elif self._size < self.max_size:
+                    self._size += 1
+                else:
+                    if not waited:
+                        waited = True
+                        self._stats['saturated'] += 1
+                    remaining = timeout - (time.perf_counter() - start)
+                    if remaining <= 0 or not self._cond.wait(remaining):
+                        if not self._idle and self._size >= self.max_size:
+                            self._stats['timeouts'] += 1
+                            raise PoolTimeout(f"No database connection free after {timeout:g}s "
+                                              f"({self.max_size} in use; raise FLAGGY_DB_POOL_MAX)")
+                    continue
+            if conn is None:
+                conn = self._open()
+            elif not self._healthy(conn, returned):
+                self._discard(conn)
+                continue
+            self._record_checkout(start, waited)
+            return conn
+
+    def putconn(self, conn: psycopg.Connection) -> None:
+        """Return a connection; an open transaction is rolled back, a broken connection dropped"""
+        try:
+            if self._closed or conn.closed or conn.broken:
+                raise psycopg.OperationalError("connection is closed")
+            if conn.info.transaction_status != pq.TransactionStatus.IDLE:
+                conn.rollback()
+            if conn.autocommit:
+                conn.autocommit = False
+        except Exception:
+            self._discard(conn)
+            return
+        expired = []
+        with self._cond:
+            self._idle.append((conn, time.monotonic()))
+            # The oldest idle connections beyond min_size are no longer needed
+            now = time.monotonic()
+            while len(self._idle) > self.min_size and now - self._idle[0][1] > POOL_MAX_IDLE_SECONDS:
+                expired.append(self._idle.popleft()[0])
+                self._size -= 1
+                self._stats['closed'] += 1
+            self._cond.notify()
+        for old in expired:
+            old.close()
+
+    @contextmanager
+    def connection(self) -> Generator[psycopg.Connection, None, None]:
+        """Per-thread checkout: nested uses on one thread share the outermost connection"""
+        held = getattr(self._local, 'conn', None)
+        if held is not None:
+            yield held
+            return
+        conn = self.getconn()
+        self._local.conn = conn
+        try:
+            yield conn
+        finally:
+            self._local.conn = None
+            self.putconn(conn)
+
+    def grow(self, max_size: int) -> None:
+        """Raise max_size (never lowered, so checked-out connections stay within the bound)"""
+        with self._cond:
+            if max_size > self.max_size:
+                self.max_size = max_size
+                self._cond.notify_all()
+
+    # ===== Internals =====
+
+    def _open(self) -> psycopg.Connection:
+        try:
+            conn = psycopg.connect(self.dsn)
+        except Exception:
+            with self._cond:
+                self._size -= 1
+                self._cond.notify()
+            raise
+        with self._cond:
+            self._stats['opened'] += 1
+        return conn
+
+    def _healthy(self, conn: psycopg.Connection, returned: float) -> bool:
+        """Cheap state check always; a round trip only for connections idle longer than check_after"""
+        if conn.closed or conn.broken:
+            return False
+        if time.monotonic() - returned < self.check_after:
+            return True
+        try:
+            conn.execute("SELECT 1")
+            conn.rollback()
+            return True
+        except Exception as e:
+            logger.debug(f"Discarding stale database connection: {e}")
+            with self._cond:
+                self._stats['health_check_failures'] += 1
+            return False
 
-from ctf_solver.config import DB_DSN
+    def _discard(self, conn: psycopg.Connection) -> None:
+        try:
+            conn.close()
+        except Exception:
+            pass
+        with self._cond:
+            self._size -= 1
+            self._stats['closed'] += 1
+            self._cond.notify()
+
+    def _record_checkout(self, start: float, waited: bool) -> None:
+        wait_ms = int((time.perf_counter() - start) * 1000)
+        with self._cond:
+            self._stats['checkouts'] += 1
+            if waited:
+                self._stats['waits'] += 1
+                self._stats['wait_ms_total'] += wait_ms
+                self._stats['wait_ms_max'] = max(self._stats['wait_ms_max'], wait_ms)
+
+    # ===== Lifecycle =====
+
+    def stats(self) -> Dict[str, Any]:
+        with self._cond:
+            stats: Dict[str, Any] = dict(self._stats)
+            stats.update(size=self._size, idle=len(self._idle), in_use=self._size - len(self._idle),
+                         min_size=self.min_size, max_size=self.max_size)
+        stats['avg_wait_ms'] = round(stats['wait_ms_total'] / stats['waits'], 1) if stats['waits'] else 0
+        return stats
+
+    def close(self) -> None:
+        """Close idle connections; checked-out ones are closed when they come back"""
+        with self._cond:
+            idle = [conn for conn, _ in self._idle]
+            self._idle.clear()
+            self._size -= len(idle)
+            self._closed = True
+            self._cond.notify_all()
+        for conn in idle:
+            conn.close()
+
+
+class PooledConnection:
+    """A checked-out connection; close() (or leaving a `with` block) gives it back to the pool"""
+
+    def __init__(self, pool: ConnectionPool, conn: psycopg.Connection):
+        object.__setattr__(self, '_pool', pool)
+        object.__setattr__(self, '_conn', conn)
+
+    def __getattr__(self, name: str) -> Any:
+        conn = self._conn
+        if conn is None:
+            raise psycopg.InterfaceError("connection returned to the pool")
+        return getattr(conn, name)
+
+    def __setattr__(self, name: str, value: Any) -> None:
+        setattr(self._conn, name, value)
+
+    @property
+    def closed(self) -> bool:
+        return self._conn is None or self._conn.closed
+
+    def close(self) -> None:
+        conn = self._conn
+        if conn is not None:
+            object.__setattr__(self, '_conn', None)
+            self._pool.putconn(conn)
+
+    def __enter__(self) -> 'PooledConnection':
+        return self
+
+    def __exit__(self, exc_type, exc, tb) -> None:
+        # Same contract as psycopg's connection context: commit or roll back, then close
+        if self._conn is not None and not self._conn.closed:
+            if exc_type is None:
+                self._conn.commit()
+            else:
+                self._conn.rollback()
+        self.close()
+
+    def __del__(self):
+        try:
+            self.close()
+        except Exception:
+            pass
+
+
+_pool: Optional[ConnectionPool] = None
+_pool_lock = threading.Lock()
+_reserved = 0  # connections held for a whole attempt (one per parallel runner)
+
+
+def get_db_pool() -> ConnectionPool:
+    """Return the process-wide connection pool"""
+    global _pool
+    with _pool_lock:
+        if _pool is None:
+            _pool = ConnectionPool(max_size=max(DB_POOL_MAX, _reserved + POOL_HEADROOM))
+        return _pool
+
+
+def reserve_db_connections(count: int) -> None:
+    """Make sure the pool can hand out `count` long-held connections plus POOL_HEADROOM,
+    so --parallel above FLAGGY_DB_POOL_MAX does not starve attempts into PoolTimeout"""
+    global _reserved
+    with _pool_lock:
+        _reserved = max(_reserved, count)
+        if _pool is not None:
+            _pool.grow(_reserved + POOL_HEADROOM)
+
+
+def db_pool_stats() -> Optional[Dict[str, Any]]:
+    with _pool_lock:
+        return _pool.stats() if _pool else None
 
 
 def get_db_connection():
-    """Get a database connection using the configured DSN"""
-    return psycopg.connect(DB_DSN)
+    """Get a pooled database connection using the configured DSN (close() returns it to the pool)"""
+    pool = get_db_pool()
+    return PooledConnection(pool, pool.getconn())
 
 
 @contextmanager
 def get_db_cursor() -> Generator[psycopg.Cursor, None, None]:
     """Context manager for database operations"""
-    conn = get_db_connection()
-    try:
+    pool = get_db_pool()
+    outermost = getattr(pool._local, 'conn', None) is None
+    with pool.connection() as conn:
         cursor = conn.cursor()
         try:
             yield cursor
-            conn.commit()
+            if outermost:
+                conn.commit()
         except Exception:
-            conn.rollback()
+            if outermost:
+                conn.rollback()
             raise
         finally:
             cursor.close()
-    finally:
-        conn.close()
 
 
 # Legacy DB class for backward compatibility
@@ -42,5 +314,3 @@ class DB:
     def put_conn(self, conn):
         if conn:
             conn.close()
-
-
@@ -0,0 +1,38 @@
+"""
+Schema migrations on top of schema.sql
+
+Each file in migrations/ runs once, in name order, and is recorded in
+schema_migrations. The files are idempotent (IF NOT EXISTS), so a database
+created from an older schema.sql and a fresh one end up identical.
+"""
+import logging
+from pathlib import Path
+from typing import List
+
+logger = logging.getLogger(__name__)
+
+MIGRATIONS_DIR = Path(__file__).parent / 'migrations'
+
+
+def apply_migrations(conn) -> List[str]:
+    """Apply pending migrations, each in its own transaction; returns the names applied"""
+    with conn.cursor() as cursor:
+        cursor.execute("""
+            CREATE TABLE IF NOT EXISTS schema_migrations (
+                name TEXT PRIMARY KEY,
+                applied_at TIMESTAMP DEFAULT NOW()
+            )
+        """)
+        cursor.execute("SELECT name FROM schema_migrations")
+        done = {row[0] for row in cursor.fetchall()}
+    conn.commit()
+    applied = []
+    for path in sorted(MIGRATIONS_DIR.glob('*.sql')):
+        if path.name in done:
+            continue
+        with conn.transaction(), conn.cursor() as cursor:
+            cursor.execute(path.read_text())
+            cursor.execute("INSERT INTO schema_migrations (name) VALUES (%s)", (path.name,))
+        logger.info(f"Applied migration {path.name}")
+        applied.append(path.name)
+    return applied
@@ -0,0 +1,22 @@
+-- Content-addressed, compressed step output (see ctf_solver/database/blobs.py)
+
+CREATE TABLE IF NOT EXISTS output_dicts (
+    id INT PRIMARY KEY,           -- 0 is the built-in dictionary and is never stored
+    data BYTEA NOT NULL,
+    samples INT,
+    created_at TIMESTAMP DEFAULT NOW()
+);
+
+CREATE TABLE IF NOT EXISTS output_blobs (
+    hash BYTEA PRIMARY KEY,       -- SHA-256 of the raw output
+    size INT NOT NULL,            -- raw length
+    dict_id INT NOT NULL,         -- deflate preset dictionary used
+    data BYTEA NOT NULL,
+    created_at TIMESTAMP DEFAULT NOW()
+);
+-- Already compressed: skip TOAST's own compression attempt
+ALTER TABLE output_blobs ALTER COLUMN data SET STORAGE EXTERNAL;
+
+-- steps.output keeps a preview when output_hash is set
+ALTER TABLE steps ADD COLUMN IF NOT EXISTS output_hash BYTEA REFERENCES output_blobs(hash);
+CREATE INDEX IF NOT EXISTS idx_steps_output_hash ON steps(output_hash);
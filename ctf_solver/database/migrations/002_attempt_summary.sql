@@ -0,0 +1,145 @@
+-- Per-attempt and per-challenge summaries kept current by triggers, so list views
+-- (TUI refreshes, list-challenges) read one row per attempt/challenge instead of
+-- aggregating steps and attempts on every query
+
+CREATE TABLE IF NOT EXISTS attempt_summary (
+    attempt_id INT PRIMARY KEY REFERENCES attempts(id) ON DELETE CASCADE,
+    step_count INT NOT NULL DEFAULT 0,
+    last_step_num INT,
+    last_step_at TIMESTAMP,
+    last_action TEXT,
+    last_output TEXT              -- first 100 characters of the escaped output
+);
+
+CREATE TABLE IF NOT EXISTS challenge_summary (
+    challenge_id INT PRIMARY KEY REFERENCES challenges(id) ON DELETE CASCADE,
+    total_attempts INT NOT NULL DEFAULT 0,
+    latest_attempt_id INT,
+    latest_status TEXT,
+    latest_started_at TIMESTAMP
+);
+
+CREATE INDEX IF NOT EXISTS idx_attempts_started ON attempts(started_at DESC);
+CREATE INDEX IF NOT EXISTS idx_attempts_challenge_started ON attempts(challenge_id, started_at DESC);
+
+-- Steps: statement level, so a COPY batch updates each attempt's row once
+CREATE OR REPLACE FUNCTION attempt_summary_steps_inserted() RETURNS trigger AS $$
+BEGIN
+    INSERT INTO attempt_summary AS s (attempt_id, step_count, last_step_num, last_step_at, last_action, last_output)
+    SELECT l.attempt_id, c.n, l.step_num, c.last_at, l.action, l.output
+    FROM (
+        SELECT attempt_id, count(*) AS n, max(created_at) AS last_at FROM new_steps GROUP BY attempt_id
+    ) c
+    JOIN (
+        SELECT DISTINCT ON (attempt_id) attempt_id, step_num,
+               COALESCE(action->>'cmd', action->>'tool') AS action,
+               LEFT(COALESCE(encode(output, 'escape'), ''), 100) AS output
+        FROM new_steps ORDER BY attempt_id, step_num DESC
+    ) l ON l.attempt_id = c.attempt_id
+    ON CONFLICT (attempt_id) DO UPDATE SET
+        step_count = s.step_count + EXCLUDED.step_count,
+        last_step_at = GREATEST(s.last_step_at, EXCLUDED.last_step_at),
+        last_step_num = CASE WHEN s.last_step_num > EXCLUDED.last_step_num THEN s.last_step_num ELSE EXCLUDED.last_step_num END,
+        last_action = CASE WHEN s.last_step_num > EXCLUDED.last_step_num THEN s.last_action ELSE EXCLUDED.last_action END,
+        last_output = CASE WHEN s.last_step_num > EXCLUDED.last_step_num THEN s.last_output ELSE EXCLUDED.last_output END;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Deletes are rare (cleanup, benchmarks): recompute the affected attempts
+CREATE OR REPLACE FUNCTION attempt_summary_steps_deleted() RETURNS trigger AS $$
+BEGIN
+    UPDATE attempt_summary s SET
+        step_count = r.n, last_step_num = r.step_num, last_step_at = r.last_at,
+        last_action = r.action, last_output = r.output
+    FROM (
+        SELECT d.attempt_id,
+               (SELECT count(*) FROM steps WHERE attempt_id = d.attempt_id) AS n,
+               (SELECT max(created_at) FROM steps WHERE attempt_id = d.attempt_id) AS last_at,
+               st.step_num, COALESCE(st.action->>'cmd', st.action->>'tool') AS action,
+               LEFT(COALESCE(encode(st.output, 'escape'), ''), 100) AS output
+        FROM (SELECT DISTINCT attempt_id FROM old_steps) d
+        LEFT JOIN LATERAL (
+            SELECT step_num, action, output FROM steps WHERE attempt_id = d.attempt_id
+            ORDER BY step_num DESC LIMIT 1
+        ) st ON TRUE
+    ) r
+    WHERE s.attempt_id = r.attempt_id;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS steps_summary_insert ON steps;
+CREATE TRIGGER steps_summary_insert AFTER INSERT ON steps
+    REFERENCING NEW TABLE AS new_steps FOR EACH STATEMENT EXECUTE FUNCTION attempt_summary_steps_inserted();
+DROP TRIGGER IF EXISTS steps_summary_delete ON steps;
+CREATE TRIGGER steps_summary_delete AFTER DELETE ON steps
+    REFERENCING OLD TABLE AS old_steps FOR EACH STATEMENT EXECUTE FUNCTION attempt_summary_steps_deleted();
+
+-- Attempts: row level (a few per minute at most)
+CREATE OR REPLACE FUNCTION challenge_summary_refresh(cid INT) RETURNS void AS $$
+BEGIN
+    IF cid IS NULL THEN
+        RETURN;
+    END IF;
+    INSERT INTO challenge_summary AS s (challenge_id, total_attempts, latest_attempt_id, latest_status, latest_started_at)
+    SELECT cid, (SELECT count(*) FROM attempts WHERE challenge_id = cid), l.id, l.status, l.started_at
+    FROM (SELECT 1) one
+    LEFT JOIN LATERAL (
+        SELECT id, status, started_at FROM attempts WHERE challenge_id = cid ORDER BY started_at DESC, id DESC LIMIT 1
+    ) l ON TRUE
+    WHERE EXISTS (SELECT 1 FROM challenges WHERE id = cid)
+    ON CONFLICT (challenge_id) DO UPDATE SET
+        total_attempts = EXCLUDED.total_attempts, latest_attempt_id = EXCLUDED.latest_attempt_id,
+        latest_status = EXCLUDED.latest_status, latest_started_at = EXCLUDED.latest_started_at;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE OR REPLACE FUNCTION attempt_summary_attempts_changed() RETURNS trigger AS $$
+BEGIN
+    IF TG_OP = 'INSERT' THEN
+        INSERT INTO attempt_summary (attempt_id) VALUES (NEW.id) ON CONFLICT DO NOTHING;
+        IF NEW.challenge_id IS NOT NULL THEN
+            INSERT INTO challenge_summary AS s (challenge_id, total_attempts, latest_attempt_id, latest_status, latest_started_at)
+            VALUES (NEW.challenge_id, 1, NEW.id, NEW.status, NEW.started_at)
+            ON CONFLICT (challenge_id) DO UPDATE SET
+                total_attempts = s.total_attempts + 1,
+                latest_attempt_id = CASE WHEN s.latest_started_at > EXCLUDED.latest_started_at THEN s.latest_attempt_id ELSE EXCLUDED.latest_attempt_id END,
+                latest_status = CASE WHEN s.latest_started_at > EXCLUDED.latest_started_at THEN s.latest_status ELSE EXCLUDED.latest_status END,
+                latest_started_at = GREATEST(s.latest_started_at, EXCLUDED.latest_started_at);
+        END IF;
+    ELSIF TG_OP = 'UPDATE' THEN
+        IF NEW.challenge_id IS DISTINCT FROM OLD.challenge_id OR NEW.started_at IS DISTINCT FROM OLD.started_at THEN
+            PERFORM challenge_summary_refresh(OLD.challenge_id);
+            PERFORM challenge_summary_refresh(NEW.challenge_id);
+        ELSIF NEW.status IS DISTINCT FROM OLD.status THEN
+            UPDATE challenge_summary SET latest_status = NEW.status
+            WHERE challenge_id = NEW.challenge_id AND latest_attempt_id = NEW.id;
+        END IF;
+    ELSE
+        PERFORM challenge_summary_refresh(OLD.challenge_id);
+    END IF;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS attempts_summary ON attempts;
+CREATE TRIGGER attempts_summary AFTER INSERT OR UPDATE OR DELETE ON attempts
+    FOR EACH ROW EXECUTE FUNCTION attempt_summary_attempts_changed();
+
+-- Backfill from existing rows
+INSERT INTO attempt_summary (attempt_id, step_count, last_step_num, last_step_at, last_action, last_output)
+SELECT a.id, COALESCE(c.n, 0), l.step_num, c.last_at, l.action, l.output
+FROM attempts a
+LEFT JOIN (
+    SELECT attempt_id, count(*) AS n, max(created_at) AS last_at FROM steps GROUP BY attempt_id
+) c ON c.attempt_id = a.id
+LEFT JOIN (
+    SELECT DISTINCT ON (attempt_id) attempt_id, step_num,
+           COALESCE(action->>'cmd', action->>'tool') AS action,
+           LEFT(COALESCE(encode(output, 'escape'), ''), 100) AS output
+    FROM steps ORDER BY attempt_id, step_num DESC
+) l ON l.attempt_id = a.id
+ON CONFLICT (attempt_id) DO NOTHING;
+
+SELECT challenge_summary_refresh(id) FROM challenges;
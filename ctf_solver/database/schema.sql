@@ -41,4 +41,4 @@ CREATE INDEX idx_steps_step_num ON steps(attempt_id, step_num);
 -- Add unique constraint to prevent duplicate step numbers per attempt
 CREATE UNIQUE INDEX idx_steps_unique ON steps(attempt_id, step_num);
 
-
+-- Later changes are in migrations/ (applied by `flaggy init` and `flaggy db migrate`)
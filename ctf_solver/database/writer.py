@@ -0,0 +1,308 @@
+"""
+Write-behind persistence of attempt steps
+
+Runners used to INSERT each step, UPDATE attempts.total_steps and commit on their
+own thread, so every step waited on a Postgres round trip and parallel attempts
+queued on commits. The StepWriter takes step rows (and small ordered statements
+such as the attempt's container name) from all runners in the process and writes
+them from one background thread with its own connection: rows collected for up to
+STEP_WRITER_INTERVAL_MS or STEP_WRITER_BATCH rows go in with a single COPY, then
+one UPDATE raises total_steps for every attempt in the batch, in one transaction.
+
+flush() is the durability barrier: it returns once everything submitted before
+the call is committed, and False if that timed out or a batch after the caller's
+mark() was dropped. Runners call it before marking an attempt finished or
+reading its steps back. If a COPY fails (a duplicate step after a retry, say),
+the rows are inserted one by one with ON CONFLICT DO NOTHING, each in a savepoint,
+so one bad row never costs the rest of the batch. Long outputs are hashed and
+compressed into output_blobs here too (see blobs.py), off the runner threads.
+"""
+import atexit
+import logging
+import queue
+import threading
+import time
+from typing import Any, Callable, Dict, List, Optional, Tuple
+
+import psycopg
+
+from ctf_solver.config import DB_DSN, STEP_WRITER_BATCH, STEP_WRITER_ENABLED, STEP_WRITER_INTERVAL_MS
+from ctf_solver.database.blobs import blobs_writable, get_output_codec, split_output, store_blobs
+
+
+logger = logging.getLogger(__name__)
+
+STEP_COLUMNS = ('attempt_id', 'step_num', 'action', 'output', 'exit_code', 'tool', 'execution_time_ms')
+
+
+def _copy_sql(columns: Tuple[str, ...]) -> str:
+    return f"COPY steps ({', '.join(columns)}) FROM STDIN"
+
+
+def _insert_sql(columns: Tuple[str, ...]) -> str:
+    return (f"INSERT INTO steps ({', '.join(columns)}) VALUES ({', '.join(['%s'] * len(columns))}) "
+            f"ON CONFLICT (attempt_id, step_num) DO NOTHING")
+
+
+_TOTALS_SQL = """
+    UPDATE attempts a SET total_steps = GREATEST(COALESCE(a.total_steps, 0), v.total)
+    FROM unnest(%s::int[], %s::int[]) AS v(id, total)
+    WHERE a.id = v.id
+"""
+_RECONNECT_DELAY = 1.0
+
+
+class StepWriter:
+    """Background writer shared by all runners of a process"""
+
+    def __init__(self, dsn: str = DB_DSN, batch_size: int = STEP_WRITER_BATCH,
+                 interval_ms: int = STEP_WRITER_INTERVAL_MS):
+        self.dsn = dsn
+        self.batch_size = max(1, batch_size)
+        self.interval = max(0, interval_ms) / 1000
+        # Items are ('step', row), ('sql', (sql, params)), ('call', fn) or ('flush', None), each with its sequence number
+        self._queue: 'queue.Queue[Tuple[int, str, Any]]' = queue.Queue()
+        self._lock = threading.Lock()
+        self._done = threading.Condition(self._lock)
+        self._submitted = 0
+        self._committed = 0
+        self._failed = 0  # last sequence number of the latest dropped batch
+        self._conn: Optional[psycopg.Connection] = None
+        self._closed = False
+        self._use_blobs: Optional[bool] = None  # decided on the first connection
+        self._codec = None
+        self.stats_counters = {'steps': 0, 'statements': 0, 'batches': 0, 'copy_batches': 0,
+                               'fallback_batches': 0, 'dropped': 0, 'max_queue': 0, 'write_ms': 0,
+                               'blobs_written': 0, 'blob_refs': 0}
+        self._thread = threading.Thread(target=self._run, name='step-writer', daemon=True)
+        self._thread.start()
+
+    # ===== Producers =====
+
+    def submit_step(self, attempt_id: int, step_num: int, action_json: str, output: bytes,
+                    exit_code: Optional[int], tool: Optional[str], execution_time_ms: Optional[int]) -> int:
+        """Queue one step row; returns its sequence number"""
+        return self._put('step', (attempt_id, step_num, action_json, output, exit_code, tool, execution_time_ms))
+
+    def execute_later(self, sql: str, params: Tuple = ()) -> int:
+        """Queue a statement to run in order with the step rows around it"""
+        return self._put('sql', (sql, params))
+
+    def call_after_commit(self, fn: Callable[[], None]) -> int:
+        """Run fn on the writer thread once everything submitted before it is committed"""
+        return self._put('call', fn)
+
+    def mark(self) -> int:
+        """Sequence number of the last item submitted, for flush(since=...)"""
+        with self._lock:
+            return self._submitted
+
+    def flush(self, timeout: float = 30.0, since: int = 0) -> bool:
+        """Wait until everything submitted so far is committed (False on timeout or if
+        a batch holding items submitted after `since` was dropped)"""
+        target = self._put('flush', None)
+        with self._done:
+            if not self._done.wait_for(lambda: self._committed >= target, timeout=timeout):
+                return False
+            return self._failed <= since
+
+    def _put(self, kind: str, item: Any) -> int:
+        with self._lock:
+            if self._closed:
+                raise RuntimeError("step writer is closed")
+            self._submitted += 1
+            seq = self._submitted
+            # Enqueue under the lock so sequence numbers reach the writer in order
+            self._queue.put((seq, kind, item))
+            self.stats_counters['max_queue'] = max(self.stats_counters['max_queue'], self._queue.qsize())
+        return seq
+
+    # ===== Writer thread =====
+
+    def _run(self) -> None:
+        while True:
+            batch = self._collect()
+            if batch is None:
+                return
+            start = time.perf_counter()
+            written = self._write(batch)
+            self.stats_counters['write_ms'] += int((time.perf_counter() - start) * 1000)
+            # Before waking flush() callers, so callbacks stay ordered before what follows a flush;
+            # a dropped batch's callbacks never run since what they announce was not written
+            for _, kind, item in batch:
+                if kind == 'call' and written:
+                    try:
+                        item()
+                    except Exception as e:
+                        logger.warning(f"Step writer callback failed: {e}")
+            with self._done:
+                if not written:
+                    self._failed = batch[-1][0]
+                self._committed = batch[-1][0]
+                self._done.notify_all()
+
+    def _collect(self) -> Optional[List[Tuple[int, str, Any]]]:
+        """Block for the first item, then gather until the batch is full, the interval ends or a flush arrives"""
+        first = self._queue.get()
+        if first[1] == 'stop':
+            return None
+        batch = [first]
+        deadline = time.monotonic() + self.interval
+        while first[1] != 'flush' and len(batch) < self.batch_size:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                break
+            try:
+                item = self._queue.get(timeout=remaining)
+            except queue.Empty:
+                break
+            if item[1] == 'stop':
+                self._queue.put(item)
+                break
+            batch.append(item)
+            if item[1] == 'flush':
+                break
+        return batch
+
+    def _write(self, batch: List[Tuple[int, str, Any]]) -> bool:
+        """Commit the batch (False if it was dropped); statements split it into runs of rows so their order is kept"""
+        for attempt in range(2):
+            try:
+                conn = self._connection()
+                # One transaction per batch; each COPY runs in a savepoint so it can fall back
+                with conn.transaction(), conn.cursor() as cursor:
+                    rows: List[Tuple] = []
+                    for _, kind, item in batch:
+                        if kind == 'step':
+                            rows.append(item)
+                        elif kind == 'sql':
+                            self._write_rows(conn, cursor, rows)
+                            rows = []
+                            self._guarded(conn, cursor, *item)
+                            self.stats_counters['statements'] += 1
+                    self._write_rows(conn, cursor, rows)
+                self.stats_counters['batches'] += 1
+                return True
+            except psycopg.OperationalError as e:
+                logger.warning(f"Step writer lost its connection: {e}")
+                self._reset()
+                if attempt == 0:
+                    time.sleep(_RECONNECT_DELAY)
+            except Exception as e:
+                logger.error(f"Step writer failed to write {len(batch)} items: {e}")
+                self._reset()
+                break
+        dropped = sum(1 for _, kind, _ in batch if kind in ('step', 'sql'))
+        self.stats_counters['dropped'] += dropped
+        logger.error(f"Step writer dropped {dropped} items")
+        return False
+
+    def _write_rows(self, conn: psycopg.Connection, cursor: psycopg.Cursor, rows: List[Tuple]) -> None:
+        if not rows:
+            return
+        totals: Dict[int, int] = {}
+        for row in rows:
+            totals[row[0]] = max(totals.get(row[0], 0), row[1] + 1)
+        columns = STEP_COLUMNS
+        if self._use_blobs:
+            # Rows carry the raw output; store long ones as blobs and keep a preview inline
+            blobs: Dict[bytes, bytes] = {}
+            stored = []
+            for row in rows:
+                inline, digest = split_output(row[3], True)
+                if digest:
+                    blobs[digest] = row[3]
+                stored.append(row[:3] + (inline,) + row[4:] + (digest,))
+            rows = stored
+            columns = STEP_COLUMNS + ('output_hash',)
+            self.stats_counters['blobs_written'] += store_blobs(cursor, blobs, self._codec)
+            self.stats_counters['blob_refs'] += sum(1 for row in rows if row[-1])
+        else:
+            rows = [row[:3] + (split_output(row[3], False)[0],) + row[4:] for row in rows]
+        try:
+            with conn.transaction():
+                with cursor.copy(_copy_sql(columns)) as copy:
+                    for row in rows:
+                        copy.write_row(row)
+            self.stats_counters['copy_batches'] += 1
+        except psycopg.OperationalError:
+            raise
+        except psycopg.Error as e:
+            logger.warning(f"COPY of {len(rows)} steps failed ({e}); inserting row by row")
+            self.stats_counters['fallback_batches'] += 1
+            for row in rows:
+                self._guarded(conn, cursor, _insert_sql(columns), row)
+        cursor.execute(_TOTALS_SQL, (list(totals), list(totals.values())))
+        self.stats_counters['steps'] += len(rows)
+
+    def _guarded(self, conn: psycopg.Connection, cursor: psycopg.Cursor, sql: str, params: Tuple) -> None:
+        """Run one statement in a savepoint; a bad row or statement is dropped, not the batch"""
+        try:
+            with conn.transaction():
+                cursor.execute(sql, params)
+        except psycopg.OperationalError:
+            raise
+        except psycopg.Error as e:
+            logger.error(f"Step writer dropped a statement: {e}")
+            self.stats_counters['dropped'] += 1
+
+    def _connection(self) -> psycopg.Connection:
+        if self._conn is None or self._conn.closed:
+            self._conn = psycopg.connect(self.dsn)
+            if self._use_blobs is None:
+                with self._conn.cursor() as cursor:
+                    self._use_blobs = blobs_writable(cursor)
+                    self._codec = get_output_codec(cursor)
+                self._conn.commit()
+        return self._conn
+
+    def _reset(self) -> None:
+        if self._conn is not None:
+            try:
+                self._conn.rollback()
+                self._conn.close()
+            except Exception:
+                pass
+        self._conn = None
+
+    # ===== Lifecycle =====
+
+    def stats(self) -> Dict[str, Any]:
+        counters = dict(self.stats_counters)
+        counters['pending'] = self._queue.qsize()
+        counters['avg_batch'] = round(counters['steps'] / counters['batches'], 1) if counters['batches'] else None
+        return counters
+
+    def close(self, timeout: float = 30.0) -> None:
+        """Flush, stop the thread and close the connection"""
+        if self._closed:
+            return
+        if not self.flush(timeout):
+            logger.warning(f"Step writer closed with {self._queue.qsize()} items unwritten "
+                           f"and {self.stats_counters['dropped']} dropped")
+        with self._lock:
+            self._closed = True
+            self._queue.put((self._submitted, 'stop', None))
+        self._thread.join(timeout)
+        self._reset()
+
+
+_writer: Optional[StepWriter] = None
+_writer_lock = threading.Lock()
+
+
+def get_step_writer() -> Optional[StepWriter]:
+    """Return the process-wide step writer, or None when disabled"""
+    global _writer
+    if not STEP_WRITER_ENABLED:
+        return None
+    with _writer_lock:
+        if _writer is None:
+            _writer = StepWriter()
+            atexit.register(_writer.close)
+        return _writer
+
+
+def step_writer_stats() -> Optional[Dict[str, Any]]:
+    with _writer_lock:
+        return _writer.stats() if _writer else None
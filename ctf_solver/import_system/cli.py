@@ -100,6 +100,9 @@ def url(url: str, username: Optional[str], password: Optional[str], token: Optio
             click.echo(f"   Failed challenges:")
             for failed in result.failed_challenges:
                 click.echo(f"     - {failed.get('name', failed.get('url', 'unknown'))}: {failed['error']}")
+        
+        if result.challenges_imported > 0:
+            _precompute_analysis(list(Path(challenges_dir).iterdir()))
     
     else:
         click.echo(f"❌ Import failed: {result.error_message}")
@@ -159,6 +162,18 @@ def local(challenge_dir: str, name: Optional[str], category: Optional[str],
             json.dump(solution.dict(), f, indent=2, default=str)
     
     click.echo(f"✅ Successfully imported local challenge: {challenge_name}")
+    _precompute_analysis([dest_dir])
+
+
+def _precompute_analysis(challenge_dirs):
+    """Static triage of freshly imported files (already-analysed content is skipped)"""
+    from ctf_solver.config import ANALYSIS_ON_SYNC
+    if not ANALYSIS_ON_SYNC:
+        return
+    from ctf_solver.core.challenge_manager import ChallengeManager
+    click.echo("Precomputing static analysis...")
+    count = ChallengeManager().precompute_analysis([d for d in challenge_dirs if d.is_dir()])
+    click.echo(f"   Analysis ready for {count} files")
 
 
 @import_cli.command() 
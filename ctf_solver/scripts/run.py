@@ -14,6 +14,7 @@ from pathlib import Path
 
 from ctf_solver.core.challenge_manager import ChallengeManager
 from ctf_solver.database.db import get_db_connection
+from ctf_solver.database.migrate import apply_migrations
 from ctf_solver.import_system.cli import import_cli
 from ctf_solver.optimization import DSPyGEPAOptimizer
 from rich.progress import Progress, BarColumn, TextColumn, TimeElapsedColumn, TimeRemainingColumn
@@ -104,9 +105,15 @@ def _setup_database(reset: bool = False):
                 "DROP TABLE IF EXISTS steps CASCADE;"
                 "DROP TABLE IF EXISTS attempts CASCADE;"
                 "DROP TABLE IF EXISTS challenges CASCADE;"
+                "DROP TABLE IF EXISTS output_blobs CASCADE;"
+                "DROP TABLE IF EXISTS output_dicts CASCADE;"
+                "DROP TABLE IF EXISTS attempt_summary CASCADE;"
+                "DROP TABLE IF EXISTS challenge_summary CASCADE;"
+                "DROP TABLE IF EXISTS schema_migrations CASCADE;"
             )
             cur.execute(drop_sql)
         cur.execute(schema_sql)
+        apply_migrations(conn)
         cur.close()
         conn.close()
         return True, "schema applied"
@@ -225,8 +232,17 @@ def solve(ctx, challenge_id: int, optimized: str):
         attempt_id = supervisor.start_attempt(challenge_id, optimized_agent=agent_name)
         click.echo(f"Attempt {attempt_id} queued. Waiting for completion…")
 
+        def show_event(event):
+            if event["event"] == "step_finished":
+                click.echo(f"  Step {event['step'] + 1}: {event.get('action', '')[:100]} "
+                           f"(exit {event.get('exit_code')}, llm {event.get('llm_ms', 0) / 1000:.1f}s, "
+                           f"shell {event.get('shell_ms', 0) / 1000:.1f}s)")
+            elif event["event"] == "flag_found":
+                click.echo(f"  🚩 Flag found at step {event['step'] + 1}")
+
         try:
-            status = supervisor.wait_attempt(attempt_id, poll_interval=2.0)
+            status = supervisor.wait_attempt(attempt_id, poll_interval=2.0, on_event=show_event,
+                                             kinds=("step_finished", "flag_found"))
         except KeyboardInterrupt:
             click.echo("\nCancellation requested, stopping attempt...")
             supervisor.cancel_attempt(attempt_id)
@@ -495,7 +511,10 @@ def service():
 @service.command('start')
 @click.option('--parallel', default=1, help='Maximum parallel attempts')
 @click.option('--optimized', default=None, help='Default optimized agent name for new runs')
-def service_start(parallel: int, optimized: Optional[str]):
+@click.option('--pool-size', default=None, type=int, help='Warm Exegol containers to keep ready (0 disables)')
+@click.option('--backend', default=None, type=click.Choice(['exegol', 'local']),
+              help='Execution backend for all attempts (default: per challenge, then FLAGGY_BACKEND)')
+def service_start(parallel: int, optimized: Optional[str], pool_size: Optional[int], backend: Optional[str]):
     """Start the background service (no-op if already running)."""
     from ctf_solver.service.supervisor import ServiceSupervisor
     from ctf_solver.service.errors import ServiceError
@@ -515,6 +534,10 @@ def service_start(parallel: int, optimized: Optional[str]):
         cmd += ["--parallel", str(parallel)]
     if optimized:
         cmd += ["--optimized", optimized]
+    if pool_size is not None:
+        cmd += ["--pool-size", str(pool_size)]
+    if backend:
+        cmd += ["--backend", backend]
 
     click.echo("Launching service...")
     supervisor = ServiceSupervisor(service_cmd=cmd)
@@ -536,6 +559,180 @@ def service_stop():
         click.echo(f"Service error: {exc}", err=True)
 
 
+@service.command('metrics')
+def service_metrics():
+    """Show runtime metrics from the background service."""
+    from ctf_solver.service.supervisor import ServiceSupervisor
+    from ctf_solver.service.errors import ServiceError
+
+    supervisor = ServiceSupervisor()
+    try:
+        metrics = supervisor.client.get_metrics()
+    except ServiceError as exc:
+        click.echo(f"Service error: {exc}", err=True)
+        sys.exit(1)
+    click.echo(json.dumps(metrics, indent=2, default=str))
+
+
+@cli.group('db')
+def database():
+    """Database maintenance."""
+
+
+@database.command('migrate')
+@click.option('--compact', is_flag=True, help='Also move long inline step outputs into compressed blobs')
+@click.option('--batch', default=500, help='Steps per transaction when compacting')
+def db_migrate(compact: bool, batch: int):
+    """Apply pending schema migrations."""
+    from ctf_solver.database.blobs import compact_outputs
+
+    conn = get_db_connection()
+    try:
+        applied = apply_migrations(conn)
+        click.echo(f"Applied {len(applied)} migrations: {', '.join(applied) or 'none pending'}")
+        if compact:
+            click.echo(json.dumps(compact_outputs(conn, batch=batch), indent=2))
+    finally:
+        conn.close()
+
+
+@database.command('train-output-dict')
+@click.option('--samples', default=2000, help='Most recent step outputs to learn from')
+@click.option('--size-kb', default=32, help='Dictionary size in KB (deflate uses at most 32)')
+def db_train_output_dict(samples: int, size_kb: int):
+    """Train the compression dictionary used for new output blobs."""
+    from ctf_solver.database.blobs import train_output_dict
+
+    conn = get_db_connection()
+    try:
+        click.echo(json.dumps(train_output_dict(conn, samples=samples, size=size_kb * 1024), indent=2))
+    finally:
+        conn.close()
+
+
+@database.command('output-stats')
+def db_output_stats():
+    """Show blob count, compression and deduplication of stored step output."""
+    from ctf_solver.database.blobs import output_storage_stats
+
+    conn = get_db_connection()
+    try:
+        click.echo(json.dumps(output_storage_stats(conn), indent=2))
+    finally:
+        conn.close()
+
+
+@cli.group()
+def bench():
+    """Run micro-benchmarks."""
+
+
+@bench.command('file-transfer')
+@click.option('--sizes', default='1,10,100', help='Comma-separated file sizes in MB')
+@click.option('--repeat', default=3, help='Runs per measurement (best is reported)')
+@click.option('--no-legacy', is_flag=True, help='Skip the exec + cat comparison')
+def bench_file_transfer(sizes: str, repeat: int, no_legacy: bool):
+    """Measure container file transfer throughput (archive API vs exec)."""
+    from ctf_solver.bench.file_transfer import run_file_transfer_bench
+
+    sizes_mb = [int(s) for s in sizes.split(',') if s.strip()]
+    rows = run_file_transfer_bench(sizes_mb, repeat=repeat, legacy=not no_legacy)
+    click.echo(json.dumps(rows, indent=2))
+
+
+@bench.command('triage')
+@click.option('--root', default='challenges', type=click.Path(exists=True, file_okay=False),
+              help='Directory tree with challenge binaries')
+@click.option('--repeat', default=5, help='Runs per measurement (best is reported)')
+@click.option('--no-legacy', is_flag=True, help='Skip the `file` subprocess comparison')
+def bench_triage(root: str, repeat: int, no_legacy: bool):
+    """Measure in-process ELF/PE/ar triage latency per binary."""
+    from ctf_solver.bench.triage import run_triage_bench
+
+    rows = run_triage_bench(root, repeat=repeat, legacy=not no_legacy)
+    click.echo(json.dumps(rows, indent=2))
+
+
+@bench.command('xor-scan')
+@click.option('--root', default='challenges/dialects', type=click.Path(exists=True, file_okay=False),
+              help='Directory tree to scan')
+@click.option('--flag-format', default='picoCTF{.*}', help='Flag format regex')
+@click.option('--repeat', default=3, help='Runs per measurement (best is reported)')
+@click.option('--no-naive', is_flag=True, help='Skip the key-by-key single-byte XOR comparison')
+def bench_xor_scan(root: str, flag_format: str, repeat: int, no_naive: bool):
+    """Measure encoded-flag scanner throughput per file."""
+    from ctf_solver.bench.xor_scan import run_xor_scan_bench
+
+    rows = run_xor_scan_bench(root, flag_format=flag_format, repeat=repeat, naive=not no_naive)
+    click.echo(json.dumps(rows, indent=2))
+
+
+@bench.command('flags')
+@click.option('--sizes', default='1,8,32', help='Comma-separated output sizes in MB')
+@click.option('--flag-format', default=r'picoCTF\{.*\}', help='Flag format regex')
+@click.option('--repeat', default=3, help='Runs per measurement (best is reported)')
+def bench_flags(sizes: str, flag_format: str, repeat: int):
+    """Measure flag detection throughput on large outputs (compiled matcher vs per-step regexes)."""
+    from ctf_solver.bench.flags import run_flag_bench
+
+    sizes_mb = [int(s) for s in sizes.split(',') if s.strip()]
+    rows = run_flag_bench(sizes_mb, flag_format=flag_format, repeat=repeat)
+    click.echo(json.dumps(rows, indent=2))
+
+
+@bench.command('sidechannel')
+@click.option('--root', default='challenges', type=click.Path(exists=True, file_okay=False),
+              help='Directory containing reverse_basic, reverse_intermediate and reverse_advanced')
+@click.option('--counter', type=click.Choice(['auto', 'perf', 'valgrind', 'ptrace']), default='auto',
+              help='Instruction counter (auto: perf, then valgrind, then ptrace)')
+@click.option('--workers', default=0, help='Parallel runs (default: CPU count)')
+@click.option('--time-limit', default=600, help='Seconds per challenge')
+def bench_sidechannel(root: str, counter: str, workers: int, time_limit: int):
+    """Recover the password-check inputs by instruction counting."""
+    from ctf_solver.bench.sidechannel import run_sidechannel_bench
+
+    rows = run_sidechannel_bench(root, counter=counter, workers=workers or None, time_limit=time_limit)
+    click.echo(json.dumps(rows, indent=2))
+
+
+@bench.command('forkserver')
+@click.option('--root', default='challenges', type=click.Path(exists=True, file_okay=False),
+              help='Directory containing buffer_overflow_basic, format_string_basic and babyheap_0ctf2017')
+@click.option('--runs', default=2000, help='Fork-server runs per target')
+@click.option('--exec-runs', default=200, help='Plain exec runs per target for the baseline (0 to skip)')
+def bench_forkserver(root: str, runs: int, exec_runs: int):
+    """Measure fork-server executions per second against one exec per run."""
+    from ctf_solver.bench.forkserver import run_forkserver_bench
+
+    rows = run_forkserver_bench(root, runs=runs, exec_runs=exec_runs)
+    click.echo(json.dumps(rows, indent=2))
+
+
+@bench.command('step-writer')
+@click.option('--attempts', default=16, help='Concurrent attempts, one thread each')
+@click.option('--steps', default=50, help='Steps logged per attempt')
+@click.option('--output-kb', default=4, help='Output size per step in KB')
+def bench_step_writer(attempts: int, steps: int, output_kb: int):
+    """Measure step persistence throughput: background COPY writer vs a commit per step."""
+    from ctf_solver.bench.step_writer import run_step_writer_bench
+
+    rows = run_step_writer_bench(attempts=attempts, steps=steps, output_kb=output_kb)
+    click.echo(json.dumps(rows, indent=2))
+
+
+@bench.command('summary')
+@click.option('--steps', default=10_000_000, help='Synthetic steps to load (50 per attempt)')
+@click.option('--challenges', default=200, help='Synthetic challenges the attempts are spread over')
+@click.option('--repeat', default=5, help='Timed runs per query (median reported)')
+@click.option('--keep', is_flag=True, help='Keep the scratch schema afterwards')
+def bench_summary(steps: int, challenges: int, repeat: int, keep: bool):
+    """Time the TUI list queries on summary tables vs aggregating steps, in a scratch schema."""
+    from ctf_solver.bench.summary import run_summary_bench
+
+    rows = run_summary_bench(steps=steps, challenges=challenges, repeat=repeat, keep=keep)
+    click.echo(json.dumps(rows, indent=2))
+
+
 @cli.command()
 @click.argument('name')
 @click.argument('binary_path')
@@ -8,6 +8,7 @@ import click
 from pathlib import Path
 
 from ctf_solver.database.db import get_db_connection
+from ctf_solver.database.migrate import apply_migrations
 
 
 @click.command()
@@ -36,13 +37,19 @@ def main(drop: bool, seed: bool):
                 DROP TABLE IF EXISTS steps CASCADE;
                 DROP TABLE IF EXISTS attempts CASCADE;
                 DROP TABLE IF EXISTS challenges CASCADE;
+                DROP TABLE IF EXISTS output_blobs CASCADE;
+                DROP TABLE IF EXISTS output_dicts CASCADE;
+                DROP TABLE IF EXISTS attempt_summary CASCADE;
+                DROP TABLE IF EXISTS challenge_summary CASCADE;
+                DROP TABLE IF EXISTS schema_migrations CASCADE;
             """
             cursor.execute(drop_sql)
             click.echo("Tables dropped.")
         
         click.echo("Creating database schema...")
         cursor.execute(schema_sql)
-        click.echo("Database schema created successfully.")
+        applied = apply_migrations(conn)
+        click.echo(f"Database schema created successfully ({len(applied)} migrations applied).")
         
         if seed:
             click.echo("Skipping seed data - use 'flaggy sync-challenges' to add actual challenges from filesystem")
@@ -10,10 +10,13 @@ import time
 from contextlib import closing
 from dataclasses import dataclass
 from pathlib import Path
-from typing import Any, Dict, Optional
+from typing import Any, Callable, Dict, Iterable, Iterator, Optional
 
-from .constants import DEFAULT_SOCKET_PATH, SERVICE_START_TIMEOUT
+from .constants import DEFAULT_SOCKET_PATH, EVENT_HEARTBEAT_SECONDS, SERVICE_START_TIMEOUT
 from .errors import ServiceError, ServiceProtocolError, ServiceTimeout, ServiceUnavailable
+from .protocol import recv_frame, send_frame
+
+FINAL_STATUSES = {"completed", "failed", "cancelled"}
 
 
 @dataclass
@@ -31,25 +34,21 @@ class ServiceClient:
         return sock
 
     def _send_request(self, action: str, payload: Dict[str, Any]) -> Dict[str, Any]:
-        message = {"action": action, "payload": payload}
-        data = json.dumps(message).encode("utf-8")
         with closing(self._connect()) as sock:
-            sock.sendall(len(data).to_bytes(4, "big"))
-            sock.sendall(data)
-            header = sock.recv(4)
-            if len(header) != 4:
-                raise ServiceProtocolError("Incomplete response header")
-            length = int.from_bytes(header, "big")
-            body = b""
-            while len(body) < length:
-                chunk = sock.recv(length - len(body))
-                if not chunk:
-                    raise ServiceProtocolError("Socket closed during response")
-                body += chunk
+            send_frame(sock, {"action": action, "payload": payload})
+            return self._read_response(sock)
+
+    def _read_response(self, sock: socket.socket) -> Dict[str, Any]:
         try:
-            response = json.loads(body.decode("utf-8"))
+            response = recv_frame(sock)
+        except EOFError as exc:
+            raise ServiceProtocolError(f"Incomplete response: {exc}")
         except json.JSONDecodeError as exc:  # noqa: BLE001
             raise ServiceProtocolError(f"Malformed JSON: {exc}")
+        except OSError as exc:
+            raise ServiceUnavailable(str(exc))
+        if response is None:
+            raise ServiceProtocolError("Incomplete response header")
         status = response.get("status")
         if status != "ok":
             message = response.get("message", "error")
@@ -98,11 +97,63 @@ class ServiceClient:
         payload = {"attempt_id": attempt_id}
         return self._send_request("get_attempt_status", payload)
 
-    def wait_attempt(self, attempt_id: int, poll_interval: float = 1.0) -> Dict[str, Any]:
+    def get_metrics(self) -> Dict[str, Any]:
+        return self._send_request("metrics", {})
+
+    def subscribe(self, attempt_id: Optional[int] = None, kinds: Optional[Iterable[str]] = None) -> Iterator[Dict[str, Any]]:
+        """Yield attempt events as the service publishes them, starting with a status snapshot.
+
+        The first item is {"event": "snapshot", "attempts": {id: status}}; then come
+        attempt_created, step_started, output, step_finished, flag_found and finished
+        (plus "dropped" when output chunks were skipped for a slow reader). Heartbeats
+        are consumed here. Raises ServiceUnavailable when the stream ends.
+        """
+        payload: Dict[str, Any] = {}
+        if attempt_id is not None:
+            payload["attempt_id"] = attempt_id
+        if kinds:
+            payload["kinds"] = list(kinds)
+        with closing(self._connect()) as sock:
+            send_frame(sock, {"action": "subscribe", "payload": payload})
+            snapshot = self._read_response(sock)
+            heartbeat = float(snapshot.get("heartbeat", EVENT_HEARTBEAT_SECONDS))
+            sock.settimeout(heartbeat * 3)
+            yield {"event": "snapshot", "attempts": snapshot.get("attempts", {})}
+            while True:
+                try:
+                    event = recv_frame(sock)
+                except (OSError, EOFError, json.JSONDecodeError) as exc:
+                    raise ServiceUnavailable(f"event stream lost: {exc}")
+                if event is None:
+                    raise ServiceUnavailable("event stream closed by the service")
+                if event.get("event") != "heartbeat":
+                    yield event
+
+    def wait_attempt(self, attempt_id: int, poll_interval: float = 1.0,
+                     on_event: Optional[Callable[[Dict[str, Any]], None]] = None,
+                     kinds: Optional[Iterable[str]] = None) -> Dict[str, Any]:
+        """Block until the attempt finishes, following its event stream (polling services without one).
+
+        on_event receives every event of the attempt, or only those in kinds.
+        """
+        if kinds is not None:
+            kinds = set(kinds) | {"finished"}
+        try:
+            for event in self.subscribe(attempt_id, kinds=kinds):
+                if event["event"] == "snapshot":
+                    status = event["attempts"].get(str(attempt_id), {})
+                    if status.get("status") in FINAL_STATUSES:
+                        return status
+                    continue
+                if on_event:
+                    on_event(event)
+                if event["event"] == "finished":
+                    return {"status": event.get("status"), "flag": event.get("flag")}
+        except ServiceError:
+            # Stream lost, or a service from before the event stream ("unknown action"): poll instead
+            pass
         while True:
             status = self.get_attempt_status(attempt_id)
             if status.get("status") not in {"running", "queued"}:
                 return status
             time.sleep(poll_interval)
-
-
@@ -10,5 +10,7 @@ DEFAULT_SOCKET_PATH = Path(os.environ.get("FLAGGY_SERVICE_SOCKET", "/tmp/flaggy-
 DEFAULT_LOG_PATH = Path(os.environ.get("FLAGGY_SERVICE_LOG", "~/flaggy-service.log")).expanduser()
 SERVICE_START_TIMEOUT = float(os.environ.get("FLAGGY_SERVICE_START_TIMEOUT", "20"))
 SERVICE_STOP_TIMEOUT = float(os.environ.get("FLAGGY_SERVICE_STOP_TIMEOUT", "10"))
-
-
+# Events a subscriber may fall behind by before output chunks are dropped
+EVENT_QUEUE_MAX = int(os.environ.get("FLAGGY_SERVICE_EVENT_QUEUE", "1000"))
+# Idle event streams carry a heartbeat this often; clients give up after three missed
+EVENT_HEARTBEAT_SECONDS = float(os.environ.get("FLAGGY_SERVICE_HEARTBEAT", "10"))
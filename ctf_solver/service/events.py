@@ -0,0 +1,132 @@
+"""Fan-out of attempt events to service subscribers.
+
+Runners publish from their worker threads; each subscriber has its own bounded
+queue drained by its connection thread, so a slow client never blocks a runner.
+When a queue is full, output chunks are dropped first (the subscriber is told
+how many); a subscriber that still cannot keep up with lifecycle events is
+disconnected and has to resubscribe (and resync from the database).
+"""
+
+from __future__ import annotations
+
+import threading
+import time
+from collections import deque
+from typing import Any, Deque, Dict, Iterable, List, Optional
+
+from .constants import EVENT_QUEUE_MAX
+
+# Dropped before anything else when a subscriber falls behind
+DROPPABLE_EVENTS = frozenset({"output"})
+
+
+class Subscription:
+    """One subscriber's filter and pending events."""
+
+    def __init__(self, attempt_id: Optional[int], kinds: Optional[Iterable[str]], max_pending: int) -> None:
+        self.attempt_id = attempt_id
+        self.kinds = frozenset(kinds) if kinds else None
+        self.max_pending = max(1, max_pending)
+        self.dropped = 0
+        self.closed = False
+        self.overflowed = False
+        self._pending: Deque[Dict[str, Any]] = deque()
+        self._cond = threading.Condition()
+
+    def matches(self, event: Dict[str, Any]) -> bool:
+        if self.attempt_id is not None and event.get("attempt_id") != self.attempt_id:
+            return False
+        return self.kinds is None or event["event"] in self.kinds
+
+    def offer(self, event: Dict[str, Any]) -> bool:
+        """Queue an event without blocking; False once the subscription is closed."""
+        with self._cond:
+            if self.closed:
+                return False
+            if len(self._pending) >= self.max_pending:
+                if event["event"] in DROPPABLE_EVENTS:
+                    self.dropped += 1
+                    return True
+                kept = deque(e for e in self._pending if e["event"] not in DROPPABLE_EVENTS)
+                self.dropped += len(self._pending) - len(kept)
+                self._pending = kept
+                if len(self._pending) >= self.max_pending:
+                    self.overflowed = True
+                    self.closed = True
+                    self._cond.notify_all()
+                    return False
+            self._pending.append(event)
+            self._cond.notify()
+            return True
+
+    def next(self, timeout: float) -> Optional[Dict[str, Any]]:
+        """Next event, a 'dropped' notice after losses, or None on timeout or close."""
+        with self._cond:
+            if not self._cond.wait_for(lambda: self._pending or self.closed, timeout=timeout):
+                return None
+            if self.closed:
+                return None
+            if self.dropped and self._pending[0]["event"] not in DROPPABLE_EVENTS:
+                dropped, self.dropped = self.dropped, 0
+                return {"event": "dropped", "attempt_id": self.attempt_id, "count": dropped, "ts": time.time()}
+            return self._pending.popleft()
+
+    def close(self) -> None:
+        with self._cond:
+            self.closed = True
+            self._cond.notify_all()
+
+
+class EventBus:
+    """Process-wide publisher; subscribers filter by attempt and event kind."""
+
+    def __init__(self, max_pending: int = EVENT_QUEUE_MAX) -> None:
+        self.max_pending = max_pending
+        self._subscribers: List[Subscription] = []
+        self._lock = threading.Lock()
+        self._seq = 0
+        self._stats = {"published": 0, "delivered": 0, "subscribed": 0, "disconnected_slow": 0}
+
+    def subscribe(self, attempt_id: Optional[int] = None, kinds: Optional[Iterable[str]] = None) -> Subscription:
+        sub = Subscription(attempt_id, kinds, self.max_pending)
+        with self._lock:
+            self._subscribers.append(sub)
+            self._stats["subscribed"] += 1
+        return sub
+
+    def unsubscribe(self, sub: Subscription) -> None:
+        sub.close()
+        with self._lock:
+            if sub in self._subscribers:
+                self._subscribers.remove(sub)
+
+    def publish(self, kind: str, attempt_id: Optional[int], fields: Optional[Dict[str, Any]] = None) -> None:
+        with self._lock:
+            self._seq += 1
+            event = {"event": kind, "attempt_id": attempt_id, "seq": self._seq, "ts": time.time(), **(fields or {})}
+            self._stats["published"] += 1
+            subscribers = list(self._subscribers)
+        for sub in subscribers:
+            if not sub.matches(event):
+                continue
+            if sub.offer(event):
+                with self._lock:
+                    self._stats["delivered"] += 1
+            elif sub.overflowed:
+                with self._lock:
+                    if sub in self._subscribers:
+                        self._subscribers.remove(sub)
+                        self._stats["disconnected_slow"] += 1
+
+    def close(self) -> None:
+        with self._lock:
+            subscribers, self._subscribers = self._subscribers, []
+        for sub in subscribers:
+            sub.close()
+
+    def stats(self) -> Dict[str, Any]:
+        with self._lock:
+            stats: Dict[str, Any] = dict(self._stats)
+            stats["subscribers"] = len(self._subscribers)
+            stats["pending_max"] = max((len(s._pending) for s in self._subscribers), default=0)
+        return stats
@@ -3,6 +3,7 @@
 from __future__ import annotations
 
 import json
+import socket
 from dataclasses import dataclass
 from typing import Any, Dict, Optional
 
@@ -32,3 +33,33 @@ class Response:
             raise RuntimeError(message)
 
 
+# Every message, request, response or streamed event, is a 4-byte big-endian length and UTF-8 JSON
+
+
+def send_frame(sock: socket.socket, message: Dict[str, Any]) -> None:
+    data = json.dumps(message).encode("utf-8")
+    sock.sendall(len(data).to_bytes(4, "big") + data)
+
+
+def _recv_exact(sock: socket.socket, length: int) -> bytes:
+    data = b""
+    while len(data) < length:
+        chunk = sock.recv(length - len(data))
+        if not chunk:
+            break
+        data += chunk
+    return data
+
+
+def recv_frame(sock: socket.socket) -> Optional[Dict[str, Any]]:
+    """Read one message; None if the peer closed cleanly between messages."""
+    header = _recv_exact(sock, 4)
+    if not header:
+        return None
+    if len(header) != 4:
+        raise EOFError("incomplete header")
+    length = int.from_bytes(header, "big")
+    body = _recv_exact(sock, length)
+    if len(body) != length:
+        raise EOFError("socket closed prematurely")
+    return json.loads(body.decode("utf-8"))
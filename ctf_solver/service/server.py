@@ -3,7 +3,6 @@
 from __future__ import annotations
 
 import argparse
-import json
 import logging
 import os
 import signal
@@ -13,10 +12,17 @@ import time
 from contextlib import closing
 from typing import Dict, Optional
 
+from ctf_solver.containers.backends import BACKENDS
+from ctf_solver.containers.cache import get_triage_cache
+from ctf_solver.containers.pool import get_container_pool, shutdown_container_pool
 from ctf_solver.core.orchestrator import SimpleOrchestrator
-from ctf_solver.database.db import get_db_connection
+from ctf_solver.core.prefetch import prefetch_stats
+from ctf_solver.database.db import db_pool_stats, get_db_connection
+from ctf_solver.database.writer import step_writer_stats
 
-from .constants import DEFAULT_SOCKET_PATH
+from .constants import DEFAULT_SOCKET_PATH, EVENT_HEARTBEAT_SECONDS
+from .events import EventBus
+from .protocol import recv_frame, send_frame
 
 logger = logging.getLogger(__name__)
 
@@ -29,13 +35,18 @@ class Service:
         socket_path=DEFAULT_SOCKET_PATH,
         max_parallel: int = 1,
         optimized_agent: Optional[str] = None,
+        pool_size: Optional[int] = None,
+        backend: Optional[str] = None,
     ) -> None:
         self.socket_path = os.fspath(socket_path)
         self.max_parallel = max_parallel
         self.optimized_agent = optimized_agent
+        # Start warming containers right away so the first attempts hit the pool
+        self.container_pool = get_container_pool(pool_size)
         self._server_socket: Optional[socket.socket] = None
         self._shutdown_event = threading.Event()
         self._attempt_status: Dict[int, Dict[str, str]] = {}
+        self.events = EventBus()
 
         def db_factory():
             return get_db_connection()
@@ -45,6 +56,7 @@ class Service:
             max_parallel=max_parallel,
             optimized_agent_name=optimized_agent,
             install_signal_handlers=False,
+            backend=backend,
         )
 
     def start(self) -> None:
@@ -78,6 +90,8 @@ class Service:
         except Exception:  # noqa: BLE001
             pass
         self.orchestrator.shutdown()
+        self.events.close()
+        shutdown_container_pool()
         try:
             os.remove(self.socket_path)
         except FileNotFoundError:
@@ -97,20 +111,16 @@ class Service:
     def _handle_client(self, client_sock: socket.socket) -> None:
         with closing(client_sock) as sock:
             try:
-                header = sock.recv(4)
-                if len(header) != 4:
+                request = recv_frame(sock)
+                if request is None:
                     raise ValueError("incomplete header")
-                length = int.from_bytes(header, "big")
-                body = b""
-                while len(body) < length:
-                    chunk = sock.recv(length - len(body))
-                    if not chunk:
-                        raise ValueError("socket closed prematurely")
-                    body += chunk
-                request = json.loads(body.decode("utf-8"))
                 action = request.get("action")
                 payload = request.get("payload", {})
 
+                if action == "subscribe":
+                    # Long-lived: the connection stays open for the event stream
+                    self._handle_subscribe(sock, payload)
+                    return
                 if action == "health":
                     response = {"status": "ok", "payload": {"status": "healthy"}}
                 elif action == "start_attempt":
@@ -119,6 +129,8 @@ class Service:
                     response = self._handle_cancel_attempt(payload)
                 elif action == "get_attempt_status":
                     response = self._handle_get_attempt_status(payload)
+                elif action == "metrics":
+                    response = self._handle_metrics(payload)
                 elif action == "shutdown":
                     response = {"status": "ok", "payload": {"message": "shutting down"}}
                     threading.Thread(target=self.stop, daemon=True).start()
@@ -129,9 +141,34 @@ class Service:
                 logger.error("Failed to handle client: %s", exc)
                 response = {"status": "error", "message": str(exc)}
 
-            data = json.dumps(response).encode("utf-8")
-            sock.sendall(len(data).to_bytes(4, "big"))
-            sock.sendall(data)
+            send_frame(sock, response)
+
+    def _handle_subscribe(self, sock: socket.socket, payload: Dict[str, object]) -> None:
+        """Stream events until the client goes away, falls too far behind, or the service stops."""
+        attempt_id = int(payload["attempt_id"]) if payload.get("attempt_id") is not None else None
+        sub = self.events.subscribe(attempt_id, payload.get("kinds"))
+        try:
+            # Subscribed before the snapshot is taken, so nothing in between is missed
+            if attempt_id is not None:
+                attempts = {str(attempt_id): self._attempt_status.get(attempt_id, {"status": "unknown"})}
+            else:
+                attempts = {str(aid): st for aid, st in list(self._attempt_status.items()) if st.get("status") == "running"}
+            send_frame(sock, {"status": "ok", "payload": {"attempts": attempts, "heartbeat": EVENT_HEARTBEAT_SECONDS}})
+            # A client that stops reading stalls sendall; give up on it instead of holding its events forever
+            sock.settimeout(EVENT_HEARTBEAT_SECONDS * 3)
+            while not self._shutdown_event.is_set():
+                event = sub.next(timeout=EVENT_HEARTBEAT_SECONDS)
+                if event is None:
+                    if sub.closed:
+                        break
+                    event = {"event": "heartbeat", "ts": time.time()}
+                send_frame(sock, event)
+        except OSError as exc:
+            logger.debug("Event subscriber went away: %s", exc)
+        finally:
+            self.events.unsubscribe(sub)
+            if sub.overflowed:
+                logger.warning("Disconnected an event subscriber that fell %d events behind", sub.max_pending)
 
     def _handle_start_attempt(self, payload: Dict[str, str]) -> Dict[str, object]:
         challenge_id = int(payload["challenge_id"])
@@ -143,12 +180,13 @@ class Service:
             self._attempt_status[attempt_id] = {"status": "running"}
 
         def _on_attempt_finished(attempt_id: int, status: str) -> None:
-            self._attempt_status[attempt_id] = {"status": status}
+            self._attempt_status[attempt_id] = {**self._attempt_status.get(attempt_id, {}), "status": status}
 
         self.orchestrator.submit_challenge(
             challenge_id,
             on_attempt_created=_on_attempt_created,
             on_attempt_finished=_on_attempt_finished,
+            on_event=self._on_attempt_event,
             optimized_agent_name=optimized,
             use_presenter=False,
         )
@@ -165,6 +203,12 @@ class Service:
 
         return {"status": "ok", "payload": {"attempt_id": attempt_id}}
 
+    def _on_attempt_event(self, kind: str, attempt_id: int, fields: Dict[str, object]) -> None:
+        if kind == "flag_found":
+            # get_attempt_status and the subscribe snapshot report the flag too
+            self._attempt_status[attempt_id] = {**self._attempt_status.get(attempt_id, {}), "flag": fields.get("flag")}
+        self.events.publish(kind, attempt_id, fields)
+
     def _handle_cancel_attempt(self, payload: Dict[str, str]) -> Dict[str, object]:
         attempt_id = int(payload["attempt_id"])
         cancelled = self.orchestrator.request_cancel(attempt_id)
@@ -175,12 +219,26 @@ class Service:
         status = self._attempt_status.get(attempt_id, {"status": "unknown"})
         return {"status": "ok", "payload": status}
 
+    def _handle_metrics(self, payload: Dict[str, str]) -> Dict[str, object]:
+        triage_cache = get_triage_cache()
+        metrics = {
+            "container_pool": self.container_pool.stats() if self.container_pool else None,
+            "triage_cache": triage_cache.stats() if triage_cache else None,
+            "prefetch": prefetch_stats(),
+            "step_writer": step_writer_stats(),
+            "db_pool": db_pool_stats(),
+            "events": self.events.stats(),
+        }
+        return {"status": "ok", "payload": metrics}
+
 
 def parse_args(argv: Optional[list[str]] = None) -> argparse.Namespace:
     parser = argparse.ArgumentParser(description="Flaggy background service")
     parser.add_argument("--socket", default=str(DEFAULT_SOCKET_PATH), help="Unix socket path")
     parser.add_argument("--parallel", type=int, default=1, help="Maximum parallel runs")
     parser.add_argument("--optimized", default=None, help="Default optimized agent name")
+    parser.add_argument("--pool-size", type=int, default=None, help="Warm containers to keep ready (0 disables)")
+    parser.add_argument("--backend", choices=BACKENDS, default=None, help="Execution backend for all attempts")
     parser.add_argument("--log-level", default="INFO", help="Logging level")
     return parser.parse_args(argv)
 
@@ -188,7 +246,13 @@ def parse_args(argv: Optional[list[str]] = None) -> argparse.Namespace:
 def main(argv: Optional[list[str]] = None) -> None:
     args = parse_args(argv)
     logging.basicConfig(level=getattr(logging, args.log_level.upper(), logging.INFO))
-    service = Service(socket_path=args.socket, max_parallel=args.parallel, optimized_agent=args.optimized)
+    service = Service(
+        socket_path=args.socket,
+        max_parallel=args.parallel,
+        optimized_agent=args.optimized,
+        pool_size=args.pool_size,
+        backend=args.backend,
+    )
     service.start()
 
 
@@ -3,7 +3,7 @@
 from __future__ import annotations
 
 from pathlib import Path
-from typing import Optional
+from typing import Any, Callable, Dict, Iterable, Iterator, Optional
 
 from .client import ServiceClient
 from .constants import DEFAULT_SOCKET_PATH
@@ -33,8 +33,18 @@ class ServiceSupervisor:
         self.ensure_running()
         return self.client.get_attempt_status(attempt_id)
 
-    def wait_attempt(self, attempt_id: int, poll_interval: float = 1.0):
+    def get_metrics(self):
         self.ensure_running()
-        return self.client.wait_attempt(attempt_id, poll_interval=poll_interval)
+        return self.client.get_metrics()
+
+    def wait_attempt(self, attempt_id: int, poll_interval: float = 1.0,
+                     on_event: Optional[Callable[[Dict[str, Any]], None]] = None,
+                     kinds: Optional[Iterable[str]] = None):
+        self.ensure_running()
+        return self.client.wait_attempt(attempt_id, poll_interval=poll_interval, on_event=on_event, kinds=kinds)
+
+    def subscribe(self, attempt_id: Optional[int] = None, kinds: Optional[Iterable[str]] = None) -> Iterator[Dict[str, Any]]:
+        """Follow a running service's events (does not start one)."""
+        return self.client.subscribe(attempt_id, kinds=kinds)
 
 
@@ -1,4 +1,5 @@
 import asyncio
+import threading
 from textual.app import App, ComposeResult
 from textual.widgets import Header, Footer, Static
 from textual.containers import Vertical
@@ -10,6 +11,13 @@ from ctf_solver.ui.textual.widgets.jobs_table import JobsTable
 from ctf_solver.ui.textual.widgets.log_panel import LogPanel
 from ctf_solver.ui.textual.widgets.challenges_view import ChallengesView
 
+# Service events that change what the views show (output chunks are left to the log refresh)
+LIVE_EVENTS = ("attempt_created", "step_finished", "flag_found", "finished")
+# Coalesce bursts of events into one refresh
+EVENT_REFRESH_DELAY = 0.3
+# Retry a lost event stream this often (polling the database meanwhile)
+EVENT_RETRY_SECONDS = 5.0
+
 
 class FlaggyTUI(App):
     CSS = """
@@ -84,9 +92,13 @@ class FlaggyTUI(App):
         yield self.status
 
     def on_mount(self) -> None:
-        # periodic refresh every 2s to reduce CPU
+        # periodic refresh every 2s to reduce CPU; paused while the service streams events
         self.service = ServiceSupervisor()
-        self.set_interval(2.0, self.refresh_data)
+        self._poll_timer = self.set_interval(2.0, self.refresh_data)
+        self._live = False
+        self._refresh_scheduled = False
+        self._events_stop = threading.Event()
+        threading.Thread(target=self._follow_events, name="tui-events", daemon=True).start()
         self.refresh_data()
         self.update_title()
         self.update_view_visibility()
@@ -172,6 +184,48 @@ class FlaggyTUI(App):
             await self.challenges_view.refresh_data()
         self.update_status_hint()
 
+    def _follow_events(self) -> None:
+        """Background thread: refresh on service events, fall back to the poll timer without a stream."""
+        while not self._events_stop.is_set():
+            try:
+                for event in self.service.subscribe(kinds=LIVE_EVENTS):
+                    if self._events_stop.is_set():
+                        return
+                    self.call_from_thread(self._on_service_event, event)
+            except ServiceError:
+                pass
+            except RuntimeError:
+                return  # app already closed
+            try:
+                self.call_from_thread(self._on_events_lost)
+            except RuntimeError:
+                return
+            self._events_stop.wait(EVENT_RETRY_SECONDS)
+
+    def _on_service_event(self, event: dict) -> None:
+        if event["event"] == "snapshot" and not self._live:
+            self._live = True
+            self._poll_timer.pause()
+        if not self._refresh_scheduled:
+            self._refresh_scheduled = True
+            self.set_timer(EVENT_REFRESH_DELAY, self._refresh_from_events)
+
+    def _on_events_lost(self) -> None:
+        if self._live:
+            self._live = False
+            self._poll_timer.resume()
+
+    async def _refresh_from_events(self) -> None:
+        self._refresh_scheduled = False
+        if self.current_mode == "jobs":
+            await self.refresh_data()
+        else:
+            await self.challenges_view.refresh_live()
+            self.update_status_hint()
+
+    async def on_unmount(self) -> None:
+        self._events_stop.set()
+
     @on(JobsTable.RowSelected)
     async def on_row_selected(self, event: JobsTable.RowSelected) -> None:
         if self.current_mode == "jobs":
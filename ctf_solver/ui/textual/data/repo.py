@@ -1,11 +1,70 @@
-from typing import List, Tuple
+from typing import List, Optional, Tuple
 
 from ctf_solver.database.db import get_db_cursor
 
+# The list queries read attempt_summary/challenge_summary (migration 002, kept current by
+# triggers); the *_LEGACY versions aggregate steps directly for databases without them
+_summaries: Optional[bool] = None
 
-def fetch_challenges() -> List[Tuple]:
-    """Fetch all challenges with their summary info for the challenges view"""
-    sql = """
+
+def _has_summaries(cur) -> bool:
+    global _summaries
+    if _summaries is None:
+        cur.execute("SELECT to_regclass('attempt_summary') IS NOT NULL AND to_regclass('challenge_summary') IS NOT NULL")
+        _summaries = bool(cur.fetchone()[0])
+    return _summaries
+
+
+CHALLENGES_SQL = """
+    SELECT c.id,
+           c.name,
+           c.category,
+           COALESCE(c.description, ''),
+           COALESCE(cs.total_attempts, 0) AS total_attempts,
+           cs.latest_status
+    FROM challenges c
+    LEFT JOIN challenge_summary cs ON cs.challenge_id = c.id
+    ORDER BY c.name ASC;
+"""
+
+CHALLENGE_RUNS_SQL = """
+    SELECT a.id::text AS attempt_id,
+           CASE
+             WHEN a.status = 'running' AND COALESCE(NOW() - s.last_step_at, NOW() - a.started_at) > INTERVAL '120 seconds'
+               THEN 'stale'
+             ELSE a.status
+           END AS status,
+           a.started_at,
+           COALESCE(a.flag, '') AS flag,
+           COALESCE(a.total_steps, 0) AS steps
+    FROM attempts a
+    LEFT JOIN attempt_summary s ON s.attempt_id = a.id
+    WHERE a.challenge_id = %s
+    ORDER BY a.started_at DESC
+    LIMIT 50;
+"""
+
+JOBS_SQL = """
+    SELECT a.id::text AS attempt_id,
+           c.name,
+           CASE
+             WHEN a.status = 'running' AND COALESCE(NOW() - s.last_step_at, NOW() - a.started_at) > INTERVAL '120 seconds'
+               THEN 'stale'
+             ELSE a.status
+           END AS status,
+           COALESCE(a.total_steps, 0) AS steps,
+           a.started_at,
+           COALESCE(s.last_action, ''),
+           COALESCE(s.last_output, ''),
+           COALESCE(a.flag, '')
+    FROM attempts a
+    JOIN challenges c ON a.challenge_id = c.id
+    LEFT JOIN attempt_summary s ON s.attempt_id = a.id
+    ORDER BY a.started_at DESC
+    LIMIT 100;
+"""
+
+CHALLENGES_SQL_LEGACY = """
     SELECT c.id,
            c.name,
            c.category,
@@ -24,15 +83,9 @@ def fetch_challenges() -> List[Tuple]:
         WHERE a.challenge_id = c.id
     ) attempt_stats ON TRUE
     ORDER BY c.name ASC;
-    """
-    with get_db_cursor() as cur:
-        cur.execute(sql)
-        return cur.fetchall()
+"""
 
-
-def fetch_challenge_runs(challenge_id: int) -> List[Tuple]:
-    """Fetch all attempts/runs for a specific challenge"""
-    sql = """
+CHALLENGE_RUNS_SQL_LEGACY = """
     SELECT a.id::text AS attempt_id,
            CASE
              WHEN a.status = 'running' AND COALESCE(NOW() - ls.last_ts, NOW() - a.started_at) > INTERVAL '120 seconds'
@@ -51,13 +104,9 @@ def fetch_challenge_runs(challenge_id: int) -> List[Tuple]:
     WHERE a.challenge_id = %s
     ORDER BY a.started_at DESC
     LIMIT 50;
-    """
-    with get_db_cursor() as cur:
-        cur.execute(sql, (challenge_id,))
-        return cur.fetchall()
+"""
 
-def fetch_jobs() -> List[Tuple]:
-    sql = """
+JOBS_SQL_LEGACY = """
     WITH last_step AS (
         SELECT s.attempt_id, MAX(s.created_at) AS last_ts
         FROM steps s
@@ -88,9 +137,26 @@ def fetch_jobs() -> List[Tuple]:
     ) ls ON TRUE
     ORDER BY a.started_at DESC
     LIMIT 100;
-    """
+"""
+
+
+def fetch_challenges() -> List[Tuple]:
+    """Fetch all challenges with their summary info for the challenges view"""
+    with get_db_cursor() as cur:
+        cur.execute(CHALLENGES_SQL if _has_summaries(cur) else CHALLENGES_SQL_LEGACY)
+        return cur.fetchall()
+
+
+def fetch_challenge_runs(challenge_id: int) -> List[Tuple]:
+    """Fetch all attempts/runs for a specific challenge"""
+    with get_db_cursor() as cur:
+        cur.execute(CHALLENGE_RUNS_SQL if _has_summaries(cur) else CHALLENGE_RUNS_SQL_LEGACY, (challenge_id,))
+        return cur.fetchall()
+
+
+def fetch_jobs() -> List[Tuple]:
     with get_db_cursor() as cur:
-        cur.execute(sql)
+        cur.execute(JOBS_SQL if _has_summaries(cur) else JOBS_SQL_LEGACY)
         return cur.fetchall()
 
 
@@ -106,6 +106,16 @@ class ChallengesView(Horizontal):
         """Refresh all data in the view"""
         await self.challenges_list.refresh_challenges()
 
+    async def refresh_live(self) -> None:
+        """Refresh the list, the open challenge's runs and the selected run's log (on service events)"""
+        await self.refresh_data()
+        challenge_id = self.runs_panel.current_challenge_id
+        if challenge_id:
+            await self.runs_panel.runs_table.refresh_runs_for_challenge(challenge_id)
+            attempt_id = self.runs_panel.get_selected_attempt()
+            if attempt_id:
+                await self.runs_panel.log_panel.refresh_logs(attempt_id)
+
     async def on_challenges_list_challenge_selected(self, event: ChallengesList.ChallengeSelected) -> None:
         """Handle challenge selection - update runs panel"""
         await self.runs_panel.update_challenge(event.challenge_id, event.challenge_name)
@@ -0,0 +1,13 @@
+"""Shared fixtures"""
+import pytest
+
+from ctf_solver.containers.local import LocalSandbox
+
+
+@pytest.fixture
+def sandbox(tmp_path):
+    """Local backend without isolation whose /challenge workspace is tmp_path"""
+    box = LocalSandbox("test_sandbox", mounts={str(tmp_path): "/challenge"}, sandbox="none")
+    assert box.start()
+    yield box
+    box.stop()
@@ -0,0 +1,35 @@
+"""Import smoke tests for the execution backends"""
+import importlib
+import inspect
+
+import pytest
+
+pytest.importorskip("docker")
+
+from ctf_solver.containers.base import ExecutionBackend  # noqa: E402
+
+
+def test_exegol_backend_imports():
+    from ctf_solver.containers.exegol import ExegolContainer
+
+    assert issubclass(ExegolContainer, ExecutionBackend)
+    assert not inspect.isabstract(ExegolContainer)
+
+
+def test_local_backend_imports():
+    from ctf_solver.containers.local import LocalSandbox
+
+    assert issubclass(LocalSandbox, ExecutionBackend)
+    assert not inspect.isabstract(LocalSandbox)
+
+
+@pytest.mark.parametrize("module", ["ctf_solver.containers.backends", "ctf_solver.bench.file_transfer"])
+def test_backend_users_import(module):
+    importlib.import_module(module)
+
+
+def test_create_backend_rejects_unknown_kind():
+    from ctf_solver.containers.backends import create_backend
+
+    with pytest.raises(ValueError):
+        create_backend("x", kind="nope")
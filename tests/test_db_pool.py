@@ -0,0 +1,41 @@
+"""Connection pool sizing for parallel attempts"""
+import pytest
+
+from ctf_solver.database import db
+
+
+class FakeConnection:
+    closed = False
+    broken = False
+
+    def close(self):
+        self.closed = True
+
+
+@pytest.fixture
+def fresh_pool_state(monkeypatch):
+    monkeypatch.setattr(db.ConnectionPool, "_open", lambda self: FakeConnection())
+    monkeypatch.setattr(db, "_pool", None)
+    monkeypatch.setattr(db, "_reserved", 0)
+
+
+def test_grow_unblocks_a_saturated_pool(fresh_pool_state):
+    pool = db.ConnectionPool(min_size=0, max_size=2, timeout=0.05)
+    held = [pool.getconn(), pool.getconn()]
+    with pytest.raises(db.PoolTimeout):
+        pool.getconn()
+    pool.grow(3)
+    held.append(pool.getconn())
+    pool.grow(1)
+    assert pool.max_size == 3
+
+
+def test_parallel_attempts_reserve_their_connections(fresh_pool_state):
+    db.reserve_db_connections(db.DB_POOL_MAX + 10)
+    pool = db.get_db_pool()
+    assert pool.max_size == db.DB_POOL_MAX + 10 + db.POOL_HEADROOM
+    # A later, larger reservation grows the existing pool
+    db.reserve_db_connections(db.DB_POOL_MAX + 20)
+    assert pool.max_size == db.DB_POOL_MAX + 20 + db.POOL_HEADROOM
+    db.reserve_db_connections(1)
+    assert db.get_db_pool().max_size == db.DB_POOL_MAX + 20 + db.POOL_HEADROOM
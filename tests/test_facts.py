@@ -0,0 +1,58 @@
+"""Workspace binary facts are read through the execution backend"""
+import os
+import shutil
+
+from ctf_solver.analysis.facts import WorkspaceFacts
+from ctf_solver.containers.base import ExecutionBackend
+
+ELF = open(shutil.which("true") or "/bin/true", "rb").read()
+
+
+class PooledWorkspace:
+    """Stands in for a pooled container: its workspace never reaches the host until release"""
+
+    def __init__(self):
+        self.files = {}
+        self.reads = 0
+
+    def list_files(self, directory):
+        assert directory == "/challenge"
+        return {name: (len(data), mtime) for name, (data, mtime) in self.files.items()}
+
+    def get_file(self, path, offset=0, length=None):
+        self.reads += 1
+        data = self.files[os.path.basename(path)][0]
+        return data, len(data)
+
+
+def test_binaries_built_in_the_backend_show_up():
+    backend = PooledWorkspace()
+    facts = WorkspaceFacts(backend)
+    assert facts.refresh() == {}
+
+    backend.files["notes.txt"] = (b"hello", 1)
+    backend.files["solve"] = (ELF, 1)
+    info = facts.refresh()
+    assert info["binary"] == "solve"
+    assert set(info["binaries"]) == {"solve"}
+    reads = backend.reads
+
+    # Unchanged files are not pulled out again
+    facts.refresh()
+    assert backend.reads == reads
+    backend.files["solve"] = (ELF, 2)
+    assert facts.refresh()["binary"] == "solve"
+    assert backend.reads == reads + 1
+
+
+def test_listing_matches_between_find_and_scandir(sandbox, tmp_path):
+    (tmp_path / "a b").write_bytes(b"x" * 3)
+    (tmp_path / "vuln").write_bytes(ELF)
+    (tmp_path / "dir").mkdir()
+    listed = sandbox.list_files("/challenge")
+    assert set(listed) == {"a b", "vuln"}
+    assert listed["vuln"] == (len(ELF), os.stat(tmp_path / "vuln").st_mtime_ns)
+    # The generic listing runs `find` where the files live (the host, in this mode)
+    found = ExecutionBackend.list_files(sandbox, str(tmp_path))
+    assert {name: size for name, (size, _) in found.items()} == {"a b": 3, "vuln": len(ELF)}
+    assert WorkspaceFacts(sandbox).refresh()["binary"] == "vuln"
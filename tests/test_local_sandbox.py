@@ -0,0 +1,123 @@
+"""Local backend: commands, sessions and file IO against a host workspace"""
+import os
+
+import pytest
+
+from ctf_solver.containers import local
+from ctf_solver.containers.local import LocalSandbox, detect_sandbox
+
+
+def test_auto_without_bwrap_refuses(monkeypatch):
+    monkeypatch.setattr(local.shutil, "which", lambda name: None)
+    with pytest.raises(RuntimeError, match="FLAGGY_LOCAL_SANDBOX"):
+        detect_sandbox("auto")
+
+
+def test_auto_prefers_bwrap(monkeypatch):
+    monkeypatch.setattr(local.shutil, "which", lambda name: f"/usr/bin/{name}")
+    assert detect_sandbox("auto") == "bwrap"
+
+
+def test_weak_modes_are_explicit_opt_ins():
+    assert detect_sandbox("none") == "none"
+    assert detect_sandbox("unshare") == "unshare"
+    with pytest.raises(ValueError):
+        detect_sandbox("nsjail")
+
+
+def test_commands_do_not_inherit_the_host_environment(sandbox, monkeypatch):
+    monkeypatch.setenv("OPENROUTER_API_KEY", "sk-secret")
+    monkeypatch.setenv("CTF_DSN", "postgresql://secret")
+    _, output = sandbox.run_command(["env"])
+    oneshot = sandbox.execute_concurrent({"tool": "bash", "cmd": "env"})["stdout"]
+    for listing in (output.decode(), oneshot):
+        assert "secret" not in listing
+        assert f"TMPDIR={sandbox.tmp_dir}" in listing
+        assert "PATH=" in listing
+
+
+def test_bwrap_starts_from_an_empty_environment(tmp_path):
+    box = LocalSandbox("test_bwrap", mounts={str(tmp_path): "/challenge"}, sandbox="bwrap")
+    box._workspace, box._tmp = str(tmp_path), str(tmp_path / "tmp")
+    argv = box._wrap(["true"], env={"PATH": "/usr/bin"})
+    assert "--clearenv" in argv
+    assert argv[argv.index("--setenv"):argv.index("--setenv") + 3] == ["--setenv", "PATH", "/usr/bin"]
+
+
+def test_bwrap_commands_join_the_attempt_pid_namespace(tmp_path, monkeypatch):
+    # Stand-in bwrap: reports itself as the sandbox child on --info-fd, then sleeps
+    fake = tmp_path / "bin" / "bwrap"
+    fake.parent.mkdir()
+    fake.write_text('#!/bin/bash\n'
+                    'while [ $# -gt 0 ]; do [ "$1" = --info-fd ] && fd=$2; shift; done\n'
+                    'printf \'{"child-pid": %d}\\n\' $$ >&$fd\n'
+                    'exec sleep 600\n')
+    fake.chmod(0o755)
+    monkeypatch.setenv("PATH", f"{fake.parent}:{os.environ['PATH']}")
+    box = LocalSandbox("test_bwrap", mounts={str(tmp_path): "/challenge"}, sandbox="bwrap")
+    assert box.start()
+    try:
+        holder = box._holder
+        assert holder.poll() is None and set(box._ns_fds) == {"pid"}
+        argv = box._wrap(["true"])
+        assert argv[argv.index("--pidns") + 1] == str(box._ns_fds["pid"])
+        for flag in ("--new-session", "--proc", "--unshare-ipc"):
+            assert flag in argv
+        # Only tool directories are visible, not the whole host
+        assert ["--ro-bind", "/", "/"] not in [argv[i:i + 3] for i in range(len(argv))]
+        assert "--ro-bind" in argv or "--symlink" in argv
+    finally:
+        box.stop()
+    assert holder.poll() is not None and not box._ns_fds
+
+
+def test_bash_session_runs_in_workspace(sandbox, tmp_path):
+    result = sandbox.execute({"tool": "bash", "cmd": "echo hi > a.txt && mkdir sub && ls"})
+    assert "a.txt" in result["stdout"]
+    assert (tmp_path / "a.txt").read_text() == "hi\n"
+    # The session keeps the directory between actions
+    sandbox.execute({"tool": "bash", "cmd": "cd sub"})
+    assert sandbox.execute({"tool": "bash", "cmd": "pwd"})["stdout"].strip().endswith("/sub")
+    # Its state file lives in the backend's scratch directory, not the host's /tmp
+    state_file = sandbox._shell_session.state_file
+    assert os.path.dirname(state_file) == sandbox.tmp_dir
+
+
+def test_binary_file_round_trip(sandbox, tmp_path):
+    sandbox.put_file("/challenge/a.bin", b"\x00\xff\x01")
+    assert (tmp_path / "a.bin").read_bytes() == b"\x00\xff\x01"
+    assert sandbox.get_file("a.bin") == (b"\x00\xff\x01", 3)
+    assert sandbox.get_file("a.bin", offset=1, length=1) == (b"\xff", 3)
+
+
+def test_file_io_stays_in_workspace_and_tmp(sandbox, tmp_path):
+    sandbox.put_file(f"{sandbox.tmp_dir}/b.bin", b"\x00")
+    assert sandbox.get_file(f"{sandbox.tmp_dir}/b.bin")[0] == b"\x00"
+
+    with pytest.raises(PermissionError):
+        sandbox.put_file("/etc/flaggy_should_not_exist", b"x")
+    with pytest.raises(PermissionError):
+        sandbox.get_file("/etc/hostname")
+    with pytest.raises(PermissionError):
+        sandbox.put_file("../escape.txt", b"x")
+
+
+def test_symlinks_cannot_escape(sandbox, tmp_path):
+    os.symlink("/etc", tmp_path / "etc")
+    with pytest.raises(PermissionError):
+        sandbox.get_file("/challenge/etc/hostname")
+
+
+def test_helpers_are_staged_in_private_tmp(sandbox):
+    assert sandbox.tmp_dir != "/tmp"
+    sandbox.install_helpers()
+    assert os.path.isfile(os.path.join(sandbox.helpers_dir, "flaggy_forkserver.py"))
+
+
+def test_cd_inside_batch_does_not_persist(sandbox, tmp_path):
+    (tmp_path / "sub").mkdir()
+    before = sandbox.cwd
+    results = sandbox.execute_batch([{"tool": "bash", "cmd": "cd sub && pwd"}] * 4 + [{"tool": "bash", "cmd": "pwd"}])
+    assert all(r["stdout"].strip().endswith("/sub") for r in results[:4])
+    assert all(r["cwd"] == before for r in results)
+    assert sandbox.cwd == before
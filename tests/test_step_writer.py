@@ -0,0 +1,25 @@
+"""Step writer reports batches it had to drop"""
+from ctf_solver.database.writer import StepWriter
+
+
+def test_dropped_batch_fails_flush_and_skips_callbacks(monkeypatch):
+    # Steps of attempt 1 cannot be written; everything else can
+    monkeypatch.setattr(StepWriter, "_write",
+                        lambda self, batch: not any(kind == 'step' and item[0] == 1 for _, kind, item in batch))
+    writer = StepWriter(dsn="", interval_ms=1000)  # the flush closes each batch
+    try:
+        called = []
+        since = writer.mark()
+        writer.submit_step(1, 0, "{}", b"", 0, "bash", 1)
+        writer.call_after_commit(lambda: called.append(1))
+        assert writer.flush(timeout=5, since=since) is False
+        assert called == []  # announced steps that were never written
+
+        # A later attempt is not blamed for the earlier loss
+        since = writer.mark()
+        writer.submit_step(2, 0, "{}", b"", 0, "bash", 1)
+        writer.call_after_commit(lambda: called.append(2))
+        assert writer.flush(timeout=5, since=since) is True
+        assert called == [2]
+    finally:
+        writer.close(timeout=5)
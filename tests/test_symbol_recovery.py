@@ -0,0 +1,28 @@
+"""Symbol recovery runs once per challenge file set"""
+from ctf_solver.analysis.store import AnalysisStore
+from ctf_solver.core import challenge_manager
+from ctf_solver.core.challenge_manager import ChallengeManager
+
+
+def test_symbol_maps_are_reused_from_the_analysis_store(tmp_path, monkeypatch):
+    monkeypatch.setattr(AnalysisStore.__init__, "__defaults__", (str(tmp_path / "analysis"),))
+    monkeypatch.setattr(challenge_manager, "SIGNATURES_ENABLED", True)
+    scans = []
+    monkeypatch.setattr(challenge_manager, "stripped_static_targets",
+                        lambda paths: scans.append(list(paths)) or ([], []))
+    challenge_dir = tmp_path / "challenges" / "pwn1"
+    challenge_dir.mkdir(parents=True)
+    (challenge_dir / "vuln").write_bytes(b"\x7fELF first build")
+    manager = ChallengeManager(base_dir=str(tmp_path))
+
+    assert manager.precompute_analysis([challenge_dir]) == 1
+    # Attempt workspace and analysis summary read what sync stored
+    artifacts = AnalysisStore().analyze_files([str(challenge_dir / "vuln")])
+    assert manager.recover_symbols(challenge_dir) == {}
+    assert manager.recover_symbols(challenge_dir, artifacts) == {}
+    assert len(scans) == 1
+
+    # New bytes are a new file set
+    (challenge_dir / "vuln").write_bytes(b"\x7fELF patched build")
+    manager.recover_symbols(challenge_dir)
+    assert len(scans) == 2
@@ -0,0 +1,36 @@
+"""Triage cache keys follow the bytes of the files a command reads"""
+from ctf_solver.containers.cache import TriageCache, command_operands, parse_triage_command
+
+
+def test_option_values_are_operands():
+    assert command_operands(parse_triage_command("checksec --file=vuln")) == ["vuln"]
+    assert command_operands(parse_triage_command("strings -n 6 vuln")) == ["6", "vuln"]
+
+
+def test_file_option_form_is_cached(sandbox, tmp_path):
+    (tmp_path / "vuln").write_bytes(b"\x7fELF first build")
+    cache = TriageCache(cache_dir=str(tmp_path / "cache"))
+    key = cache.key_for(sandbox, "checksec --file=vuln")
+    assert key is not None
+    assert cache.key_for(sandbox, "checksec --file=vuln") == key
+    assert cache.key_for(sandbox, "checksec --file=vuln --output=json") not in (None, key)
+
+    # Same command on different bytes must miss
+    (tmp_path / "vuln").write_bytes(b"\x7fELF patched build")
+    assert cache.key_for(sandbox, "checksec --file=vuln") != key
+
+
+def test_only_successful_results_are_served(sandbox, tmp_path):
+    (tmp_path / "vuln").write_bytes(b"\x7fELF")
+    cache = TriageCache(cache_dir=str(tmp_path / "cache"))
+    key = cache.key_for(sandbox, "strings vuln")
+    cache.put(key, {"stdout": "ELF\n", "exit_code": 1, "cwd": "/challenge"})
+    assert cache.get(key) is None
+    cache.put(key, {"stdout": "ELF\n", "exit_code": 0, "cwd": "/challenge"})
+    assert cache.get(key) == {"stdout": "ELF\n", "exit_code": 0}
+
+
+def test_commands_without_files_are_not_cached(sandbox, tmp_path):
+    cache = TriageCache(cache_dir=str(tmp_path / "cache"))
+    assert cache.key_for(sandbox, "checksec --file=missing") is None
+    assert cache.key_for(sandbox, "file --version") is None